@@ -468,14 +468,13 @@ void loadORAMThresholds(Thresholds& thresh, ORAM& oram, const ATU& atu, uint8_t*
   const size_t element_size = atu.element_size(Layer);
   std::pair<size_t, size_t> block_byte;
 
-  ap_uint<TA::width> val;
-
   for (unsigned pe = 0; pe < PE; ++pe) {
     for (unsigned nf = 0; nf < NF; ++nf) {
-      for (unsigned numth; numth < NumTH; ++numth) {
+      for (unsigned numth = 0; numth < NumTH; ++numth) {
         block_byte = atu.index_to_block(Layer, pe, nf, numth);
         oram.read(block_byte.first, block_cache, server_data);
 
+        ap_uint<TA::width> val = 0;
         for (size_t i = 0; i < element_size; ++i) {
           #pragma HLS pipeline
           val |= ap_uint<TA::width>(block_cache[block_byte.second + i]) << (i * 8);
@@ -486,6 +485,41 @@ void loadORAMThresholds(Thresholds& thresh, ORAM& oram, const ATU& atu, uint8_t*
   }
 }
 
+/**
+ * Loads the thresholds like loadORAMThresholds, but through an ORAMRequestCoalescer
+ * (see oram/request_coalescer.h), so that the thresholds sharing an ORAM block
+ * cost a single access per queue flush.
+ */
+template<size_t Layer, unsigned NF, unsigned PE, unsigned NumTH, typename TA, typename Thresholds, typename Coalescer, typename ORAM, typename ATU>
+void loadORAMThresholdsCoalesced(Thresholds& thresh, Coalescer& queue, ORAM& oram, const ATU& atu, uint8_t* server_data) {
+  const size_t element_size = atu.element_size(Layer);
+  uint32_t tickets[Coalescer::queue_depth];
+  size_t   offsets[Coalescer::queue_depth];
+
+  for (unsigned base = 0; base < PE * NF * NumTH; base += Coalescer::queue_depth) {
+    const unsigned count = (PE * NF * NumTH - base < Coalescer::queue_depth) ? (PE * NF * NumTH - base) : Coalescer::queue_depth;
+
+    for (unsigned i = 0; i < count; ++i) {
+      const unsigned e = base + i;
+      const std::pair<size_t, size_t> block_byte = atu.index_to_block(Layer, e / (NF * NumTH), (e / NumTH) % NF, e % NumTH);
+      tickets[i] = queue.read(block_byte.first);
+      offsets[i] = block_byte.second;
+    }
+    queue.flush(oram, server_data);
+
+    for (unsigned i = 0; i < count; ++i) {
+      const unsigned e = base + i;
+      const auto& block = queue.result(tickets[i]);
+      ap_uint<TA::width> val = 0;
+      for (size_t j = 0; j < element_size; ++j) {
+        #pragma HLS pipeline
+        val |= ap_uint<TA::width>(block[offsets[i] + j]) << (j * 8);
+      }
+      thresh.m_thresholds[e / (NF * NumTH)][(e / NumTH) % NF][e % NumTH] = *reinterpret_cast<TA*>(&val);
+    }
+  }
+}
+
 /**
  * \brief Thresholding function for multiple images
  *
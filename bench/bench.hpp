@@ -0,0 +1,129 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file bench.hpp
+ *
+ *  C-simulation throughput benchmark harness: registry of benchmark cases
+ *  and timing of a kernel over a number of frames
+ *
+ *****************************************************************************/
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <initializer_list>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <hls_stream.h>
+#include "ap_int.h"
+
+/**
+ * \brief   A kernel instance of the benchmark suite
+ *
+ * run(frames) executes the kernel on the given number of frames and returns
+ * the wall-clock seconds spent inside the kernel, excluding the filling and
+ * draining of its streams.
+ */
+struct BenchCase {
+	std::string  kernel;           // kernel family, e.g. "mvau"
+	std::string  params;           // instance parameters, e.g. "MW=64 MH=64 SIMD=8 PE=8"
+	unsigned     in_words;         // input stream words per frame
+	unsigned     out_words;        // output stream words per frame
+	unsigned     cycles;           // analytic cycles per frame (II=1)
+	std::function<double(unsigned)>  run;
+
+	std::string key() const { return kernel + " " + params; }
+};
+
+inline std::vector<BenchCase>& bench_registry() {
+	static std::vector<BenchCase>  cases;
+	return  cases;
+}
+
+/** Registers a benchmark case at static initialization time. */
+struct BenchRegistrar {
+	BenchRegistrar(BenchCase const &c) { bench_registry().push_back(c); }
+};
+
+/** Deterministic pseudo-random word of the given width. */
+template<int W>
+ap_uint<W> bench_random() {
+	ap_uint<W>  v = 0;
+	for(int i = 0; i < W; i += 16) {
+		v = v << 16;
+		v |= ap_uint<W>(std::rand() & 0xFFFF);
+	}
+	return  v;
+}
+
+/** Fills a stream with random words. */
+template<int W>
+void bench_fill(hls::stream<ap_uint<W>> &s, unsigned const words) {
+	for(unsigned i = 0; i < words; i++)  s.write(bench_random<W>());
+}
+
+/** Empties a stream, returns the number of words read. */
+template<typename T>
+unsigned bench_drain(hls::stream<T> &s) {
+	unsigned  n = 0;
+	while(!s.empty()) {
+		s.read();
+		n++;
+	}
+	return  n;
+}
+
+/** Times a kernel invocation. */
+template<typename F>
+double bench_time(F const &kernel) {
+	auto const  start = std::chrono::steady_clock::now();
+	kernel();
+	return  std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** Formats "NAME=value" parameter lists. */
+inline std::string bench_params(std::initializer_list<std::pair<char const*, unsigned>> const &params) {
+	std::ostringstream  os;
+	for(auto const &p : params) {
+		if(os.tellp() > 0)  os << ' ';
+		os << p.first << '=' << p.second;
+	}
+	return  os.str();
+}
+
+#endif
@@ -0,0 +1,75 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file bench_dwc.cpp
+ *
+ *  Throughput benchmarks of StreamingDataWidthConverter_Batch
+ *
+ *****************************************************************************/
+#include "bnn-library.h"
+
+#include "perf_model.h"
+#include "bench.hpp"
+
+namespace {
+
+template<unsigned InWidth, unsigned OutWidth, unsigned NumInWords>
+BenchCase dwc() {
+	unsigned const  out_words = InWidth > OutWidth? NumInWords * (InWidth / OutWidth) : NumInWords / (OutWidth / InWidth);
+	BenchCase  c;
+	c.kernel = "dwc";
+	c.params = bench_params({{"InWidth", InWidth}, {"OutWidth", OutWidth}, {"NumInWords", NumInWords}});
+	c.in_words = NumInWords;
+	c.out_words = out_words;
+	c.cycles = finn::perf::dwc_cycles(InWidth, OutWidth, NumInWords);
+	c.run = [](unsigned const  frames) {
+		hls::stream<ap_uint<InWidth>>  in;
+		hls::stream<ap_uint<OutWidth>>  out;
+		bench_fill(in, frames * NumInWords);
+		double const  t = bench_time([&]() {
+			StreamingDataWidthConverter_Batch<InWidth, OutWidth, NumInWords>(in, out, frames);
+		});
+		bench_drain(out);
+		return  t;
+	};
+	return  c;
+}
+
+BenchRegistrar const  reg[] = {
+	dwc<64, 16, 1024>(),
+	dwc<8, 32, 1024>(),
+	dwc<256, 64, 1024>(),
+	dwc<32, 256, 1024>(),
+};
+
+}
@@ -0,0 +1,160 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file bench_main.cpp
+ *
+ *  Driver of the C-simulation throughput benchmarks.
+ *
+ *  Usage: finn_bench [--filter <substring>] [--min-time <seconds>]
+ *                    [--csv <file>] [--baseline <file>] [--tolerance <fraction>]
+ *
+ *  Every registered case is run with a doubling number of frames until a run
+ *  takes at least min-time seconds. The simulated input words per second are
+ *  reported next to the analytic cycles per frame of the hardware. With a
+ *  baseline CSV of an earlier run, cases slower than (1 - tolerance) times
+ *  their baseline are flagged as regressions and the exit code is 1.
+ *
+ *****************************************************************************/
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+#include "bench.hpp"
+
+namespace {
+
+struct BenchResult {
+	BenchCase const *c;
+	unsigned  frames;
+	double    seconds;
+	double words_per_sec() const { return c->in_words * double(frames) / seconds; }
+	double frames_per_sec() const { return frames / seconds; }
+	double cycles_per_sec() const { return c->cycles * double(frames) / seconds; }
+};
+
+BenchResult measure(BenchCase const &c, double const  min_time) {
+	BenchResult  r = { &c, 1, 0.0 };
+	while(true) {
+		r.seconds = c.run(r.frames);
+		if(r.seconds >= min_time || r.frames >= (1u << 20))  break;
+		// aim slightly above min_time in one step once the order of magnitude is known
+		double const  scale = r.seconds > 0.0? 1.2 * min_time / r.seconds : 16.0;
+		r.frames = unsigned(r.frames * std::min(16.0, std::max(2.0, scale)));
+	}
+	return  r;
+}
+
+std::map<std::string, double> read_baseline(char const *path) {
+	std::map<std::string, double>  base;
+	std::ifstream  in(path);
+	std::string  line;
+	std::getline(in, line); // header
+	while(std::getline(in, line)) {
+		// kernel,params,frames,seconds,words_per_sec,...
+		std::vector<std::string>  f;
+		std::istringstream  ls(line);
+		for(std::string s; std::getline(ls, s, ','); )  f.push_back(s);
+		if(f.size() >= 5)  base[f[0] + " " + f[1]] = std::atof(f[4].c_str());
+	}
+	return  base;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	char const *filter = nullptr;
+	char const *csv = nullptr;
+	char const *baseline = nullptr;
+	double  min_time = 0.2;
+	double  tolerance = 0.15;
+	for(int i = 1; i < argc; i++) {
+		bool const  has_arg = i+1 < argc;
+		if(!std::strcmp(argv[i], "--filter") && has_arg)          filter = argv[++i];
+		else if(!std::strcmp(argv[i], "--csv") && has_arg)        csv = argv[++i];
+		else if(!std::strcmp(argv[i], "--baseline") && has_arg)   baseline = argv[++i];
+		else if(!std::strcmp(argv[i], "--min-time") && has_arg)   min_time = std::atof(argv[++i]);
+		else if(!std::strcmp(argv[i], "--tolerance") && has_arg)  tolerance = std::atof(argv[++i]);
+		else {
+			std::cerr << "Usage: " << argv[0] << " [--filter <substring>] [--min-time <seconds>] [--csv <file>] [--baseline <file>] [--tolerance <fraction>]" << std::endl;
+			return  2;
+		}
+	}
+
+	std::map<std::string, double>  base;
+	if(baseline)  base = read_baseline(baseline);
+
+	std::ofstream  csv_out;
+	if(csv) {
+		csv_out.open(csv);
+		csv_out << "kernel,params,frames,seconds,words_per_sec,frames_per_sec,cycles_per_frame,sim_cycles_per_sec\n";
+	}
+
+	std::cout << std::left << std::setw(56) << "case" << std::right
+	          << std::setw(10) << "frames" << std::setw(14) << "words/s"
+	          << std::setw(14) << "cycles/frame" << std::setw(14) << "sim cycles/s" << std::setw(10) << "vs base" << '\n';
+	unsigned  regressions = 0;
+	for(BenchCase const &c : bench_registry()) {
+		if(filter && c.key().find(filter) == std::string::npos)  continue;
+		BenchResult const  r = measure(c, min_time);
+
+		std::cout << std::left << std::setw(56) << c.key() << std::right
+		          << std::setw(10) << r.frames
+		          << std::setw(14) << std::setprecision(4) << r.words_per_sec()
+		          << std::setw(14) << c.cycles
+		          << std::setw(14) << std::setprecision(4) << r.cycles_per_sec();
+		auto const  b = base.find(c.key());
+		if(b != base.end() && b->second > 0.0) {
+			double const  ratio = r.words_per_sec() / b->second;
+			std::cout << std::setw(9) << std::fixed << std::setprecision(2) << ratio << 'x' << std::defaultfloat;
+			if(ratio < 1.0 - tolerance) {
+				std::cout << "  REGRESSION";
+				regressions++;
+			}
+		}
+		std::cout << std::endl;
+
+		if(csv_out.is_open()) {
+			csv_out << c.kernel << ',' << c.params << ',' << r.frames << ',' << r.seconds << ','
+			        << r.words_per_sec() << ',' << r.frames_per_sec() << ',' << c.cycles << ',' << r.cycles_per_sec() << '\n';
+		}
+	}
+
+	if(regressions > 0) {
+		std::cout << regressions << " case(s) regressed by more than " << tolerance*100 << "% against " << baseline << std::endl;
+		return  1;
+	}
+	return  0;
+}
@@ -0,0 +1,117 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file bench_mvau.cpp
+ *
+ *  Throughput benchmarks of Matrix_Vector_Activate_Batch
+ *
+ *****************************************************************************/
+#include <memory>
+#include "bnn-library.h"
+#include "activations.hpp"
+#include "weights.hpp"
+#include "interpret.hpp"
+#include "mvau.hpp"
+
+#include "perf_model.h"
+#include "bench.hpp"
+
+namespace {
+
+// fixed-point: 4-bit inputs and weights, 16-bit accumulators
+template<unsigned MW, unsigned MH, unsigned SIMD, unsigned PE>
+BenchCase mvau_fixed() {
+	unsigned const  TILES = (MH / PE) * (MW / SIMD);
+	BenchCase  c;
+	c.kernel = "mvau";
+	c.params = bench_params({{"MW", MW}, {"MH", MH}, {"SIMD", SIMD}, {"PE", PE}, {"WBITS", 4}});
+	c.in_words = MW / SIMD;
+	c.out_words = MH / PE;
+	c.cycles = finn::perf::mvau_cycles(MW, MH, SIMD, PE);
+	c.run = [](unsigned const  frames) {
+		typedef FixedPointWeights<SIMD, ap_int<4>, PE, TILES>  Weights;
+		std::unique_ptr<Weights>  weights(new Weights);
+		for(unsigned pe = 0; pe < PE; pe++)
+			for(unsigned t = 0; t < TILES; t++)
+				weights->m_weights[pe][t] = bench_random<SIMD*4>();
+		hls::stream<ap_uint<SIMD*4>>  in;
+		hls::stream<ap_uint<PE*16>>  out;
+		bench_fill(in, frames * (MW / SIMD));
+		double const  t = bench_time([&]() {
+			Matrix_Vector_Activate_Batch<MW, MH, SIMD, PE, Slice<ap_uint<4>>, Slice<ap_int<16>>, Identity>
+				(in, out, *weights, PassThroughActivation<ap_int<16>>(), frames, ap_resource_dsp());
+		});
+		bench_drain(out);
+		return  t;
+	};
+	return  c;
+}
+
+// binarized: XNOR-popcount
+template<unsigned MW, unsigned MH, unsigned SIMD, unsigned PE>
+BenchCase mvau_binary() {
+	unsigned const  TILES = (MH / PE) * (MW / SIMD);
+	BenchCase  c;
+	c.kernel = "mvau";
+	c.params = bench_params({{"MW", MW}, {"MH", MH}, {"SIMD", SIMD}, {"PE", PE}, {"WBITS", 1}});
+	c.in_words = MW / SIMD;
+	c.out_words = MH / PE;
+	c.cycles = finn::perf::mvau_cycles(MW, MH, SIMD, PE);
+	c.run = [](unsigned const  frames) {
+		typedef BinaryWeights<SIMD, PE, TILES>  Weights;
+		std::unique_ptr<Weights>  weights(new Weights);
+		for(unsigned pe = 0; pe < PE; pe++)
+			for(unsigned t = 0; t < TILES; t++)
+				weights->m_weights[pe][t] = bench_random<SIMD>();
+		hls::stream<ap_uint<SIMD>>  in;
+		hls::stream<ap_uint<PE*16>>  out;
+		bench_fill(in, frames * (MW / SIMD));
+		double const  t = bench_time([&]() {
+			Matrix_Vector_Activate_Batch<MW, MH, SIMD, PE, Recast<XnorMul>, Slice<ap_uint<16>>, Identity>
+				(in, out, *weights, PassThroughActivation<ap_uint<16>>(), frames, ap_resource_lut());
+		});
+		bench_drain(out);
+		return  t;
+	};
+	return  c;
+}
+
+BenchRegistrar const  reg[] = {
+	mvau_fixed<64, 64, 8, 8>(),
+	mvau_fixed<288, 64, 16, 16>(),
+	mvau_fixed<576, 128, 32, 16>(),
+	mvau_binary<256, 64, 32, 16>(),
+	mvau_binary<1024, 128, 64, 32>(),
+};
+
+}
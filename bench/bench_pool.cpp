@@ -0,0 +1,73 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file bench_pool.cpp
+ *
+ *  Throughput benchmarks of StreamingMaxPool_Precision_Batch
+ *
+ *****************************************************************************/
+#include "bnn-library.h"
+
+#include "perf_model.h"
+#include "bench.hpp"
+
+namespace {
+
+template<unsigned ImgDim, unsigned PoolDim, unsigned NumChannels>
+BenchCase maxpool() {
+	unsigned const  OutDim = ImgDim / PoolDim;
+	BenchCase  c;
+	c.kernel = "maxpool";
+	c.params = bench_params({{"ImgDim", ImgDim}, {"PoolDim", PoolDim}, {"NumChannels", NumChannels}});
+	c.in_words = ImgDim * ImgDim;
+	c.out_words = OutDim * OutDim;
+	c.cycles = finn::perf::maxpool_cycles(ImgDim, PoolDim);
+	c.run = [](unsigned const  frames) {
+		hls::stream<ap_uint<NumChannels*4>>  in;
+		hls::stream<ap_uint<NumChannels*4>>  out;
+		bench_fill(in, frames * ImgDim * ImgDim);
+		double const  t = bench_time([&]() {
+			StreamingMaxPool_Precision_Batch<ImgDim, PoolDim, NumChannels, ap_uint<4>, 0>(in, out, frames);
+		});
+		bench_drain(out);
+		return  t;
+	};
+	return  c;
+}
+
+BenchRegistrar const  reg[] = {
+	maxpool<32, 2, 16>(),
+	maxpool<16, 2, 64>(),
+};
+
+}
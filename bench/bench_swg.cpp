@@ -0,0 +1,75 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file bench_swg.cpp
+ *
+ *  Throughput benchmarks of the ConvolutionInputGenerator (sliding window)
+ *
+ *****************************************************************************/
+#include "bnn-library.h"
+
+#include "perf_model.h"
+#include "bench.hpp"
+
+namespace {
+
+template<unsigned K, unsigned IFMCh, unsigned IFMDim, unsigned SIMD, unsigned Stride>
+BenchCase swg() {
+	unsigned const  OFMDim = (IFMDim - K) / Stride + 1;
+	unsigned const  MF = IFMCh / SIMD;
+	BenchCase  c;
+	c.kernel = "swg";
+	c.params = bench_params({{"K", K}, {"IFMCh", IFMCh}, {"IFMDim", IFMDim}, {"SIMD", SIMD}, {"Stride", Stride}});
+	c.in_words = IFMDim * IFMDim * MF;
+	c.out_words = OFMDim * OFMDim * K * K * MF;
+	c.cycles = finn::perf::swg_cycles(K, IFMCh, IFMDim, OFMDim, SIMD, Stride);
+	c.run = [](unsigned const  frames) {
+		hls::stream<ap_uint<SIMD*4>>  in;
+		hls::stream<ap_uint<SIMD*4>>  out;
+		bench_fill(in, frames * IFMDim * IFMDim * MF);
+		double const  t = bench_time([&]() {
+			ConvolutionInputGenerator<K, IFMCh, 4, IFMDim, OFMDim, SIMD, Stride>(in, out, frames);
+		});
+		bench_drain(out);
+		return  t;
+	};
+	return  c;
+}
+
+BenchRegistrar const  reg[] = {
+	swg<3, 16, 16, 16, 1>(),
+	swg<3, 64, 32, 16, 1>(),
+	swg<4, 32, 32, 8, 2>(),
+};
+
+}
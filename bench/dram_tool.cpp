@@ -0,0 +1,179 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file dram_tool.cpp
+ *
+ *  Ranking of memory layouts of the DMA blocks on the DRAM timing model of
+ *  dram_model.h, in C simulation.
+ *
+ *  Usage: finn_dram [--banks <N>] [--row-bytes <N>] [--burst-length <N>]
+ *
+ *  Every group of cases moves the same data with different layouts or DMA
+ *  blocks, for both address mappings of the model. The memory cycles, the row
+ *  hit rate and the bus utilization of every case are reported, the fastest
+ *  case of every group and mapping is marked with a *.
+ *
+ *****************************************************************************/
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bnn-library.h"
+#include "dram_model.h"
+
+using namespace finn::dram;
+
+namespace {
+
+unsigned const  WIDTH = 64;
+typedef ap_uint<WIDTH>  word_t;
+
+// 32x32 frames of 64 8-bit channels, i.e. 8 words per pixel
+unsigned const  DIM = 32;
+unsigned const  PIXEL_WORDS = 8;
+unsigned const  FRAME_WORDS = DIM * DIM * PIXEL_WORDS;
+unsigned const  FRAME_BYTES = FRAME_WORDS * WIDTH / 8;
+unsigned const  FRAMES = 8;
+
+// TILExTILE tiles of a TILED_DIMxTILED_DIM frame with the same pixels
+unsigned const  TILED_DIM = 128;
+unsigned const  TILED_WORDS = TILED_DIM * TILED_DIM * PIXEL_WORDS;
+unsigned const  TILE = 32;
+
+struct Case {
+	std::string  group;
+	std::string  name;
+	std::function<void(DramModel&)>  run;
+};
+
+void drain(hls::stream<word_t> &s) {
+	while(!s.empty())  s.read();
+}
+
+// Tiles of a frame, stored row-major or tile by tile
+void tiles_row_major(DramModel &ddr) {
+	ModeledMemory<word_t>  mem(ddr, TILED_WORDS);
+	hls::stream<word_t>  out;
+	for(unsigned  ty = 0; ty < TILED_DIM; ty += TILE) {
+		for(unsigned  tx = 0; tx < TILED_DIM; tx += TILE) {
+			DmaDescriptor const  desc = { (ty * TILED_DIM + tx) * PIXEL_WORDS, TILE * PIXEL_WORDS, TILE, TILED_DIM * PIXEL_WORDS, 1, 0 };
+			Mem2Stream_Strided<WIDTH>(mem.ptr(), out, desc);
+			drain(out);
+		}
+	}
+}
+void tiles_tile_major(DramModel &ddr) {
+	ModeledMemory<word_t>  mem(ddr, TILED_WORDS);
+	hls::stream<word_t>  out;
+	for(unsigned  t = 0; t < (TILED_DIM / TILE) * (TILED_DIM / TILE); t++) {
+		Mem2Stream<WIDTH, TILE * TILE * PIXEL_WORDS * WIDTH / 8>(mem.ptr() + t * TILE * TILE * PIXEL_WORDS, out);
+		drain(out);
+	}
+}
+
+// Weights streamed for every frame while the outputs are written back, with
+// the output buffer right behind the weights or shifted by half a row
+unsigned const  WEIGHT_BYTES = 16384;
+void weights_and_outputs(DramModel &ddr, unsigned long long const  out_base) {
+	ModeledMemory<word_t>  weights(ddr, WEIGHT_BYTES * 8 / WIDTH, 0);
+	ModeledMemory<word_t>  outputs(ddr, FRAMES * FRAME_WORDS, out_base);
+	hls::stream<word_t>  w;
+	hls::stream<word_t>  o;
+	for(unsigned  f = 0; f < FRAMES; f++) {
+		for(unsigned  chunk = 0; chunk < FRAME_WORDS; chunk += WEIGHT_BYTES * 8 / WIDTH) {
+			Mem2Stream_Batch_external_wmem<WIDTH, WEIGHT_BYTES>(weights.ptr(), w, 1);
+			while(!w.empty())  o.write(w.read());
+			Stream2Mem<WIDTH, WEIGHT_BYTES>(o, outputs.ptr() + f * FRAME_WORDS + chunk);
+		}
+	}
+}
+
+std::vector<Case> cases(DramConfig const &cfg) {
+	unsigned long long const  weight_end = WEIGHT_BYTES;
+	unsigned long long const  bank_span = (unsigned long long)cfg.row_bytes * cfg.banks;
+	std::vector<Case>  c;
+	c.push_back({ "tiles", "row-major, Mem2Stream_Strided", tiles_row_major });
+	c.push_back({ "tiles", "tile-major, Mem2Stream", tiles_tile_major });
+	c.push_back({ "weights", "outputs behind weights", [=](DramModel &ddr) { weights_and_outputs(ddr, weight_end); } });
+	c.push_back({ "weights", "outputs on the banks of the weights", [=](DramModel &ddr) { weights_and_outputs(ddr, bank_span); } });
+	c.push_back({ "weights", "outputs half a row off", [=](DramModel &ddr) { weights_and_outputs(ddr, bank_span + cfg.row_bytes / 2); } });
+	return  c;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	DramConfig  cfg;
+	for(int  i = 1; i < argc; i++) {
+		if((i + 1 < argc) && !std::strcmp(argv[i], "--banks"))              cfg.banks = std::atoi(argv[++i]);
+		else if((i + 1 < argc) && !std::strcmp(argv[i], "--row-bytes"))     cfg.row_bytes = std::atoi(argv[++i]);
+		else if((i + 1 < argc) && !std::strcmp(argv[i], "--burst-length"))  cfg.burst_length = std::atoi(argv[++i]);
+		else {
+			std::cerr << "Usage: " << argv[0] << " [--banks <N>] [--row-bytes <N>] [--burst-length <N>]" << std::endl;
+			return  EXIT_FAILURE;
+		}
+	}
+
+	AddressMapping const  mappings[] = { AddressMapping::RowBankColumn, AddressMapping::RowColumnBank };
+	char const *const  mapping_names[] = { "row:bank:column", "row:column:bank" };
+	for(unsigned  m = 0; m < 2; m++) {
+		cfg.mapping = mappings[m];
+		std::vector<Case> const  cs = cases(cfg);
+		std::vector<DramStats>  stats;
+		for(Case const &c : cs) {
+			DramModel  ddr(cfg);
+			c.run(ddr);
+			stats.push_back(ddr.stats());
+		}
+
+		std::cout << "Address mapping " << mapping_names[m] << ":\n";
+		std::cout << std::left << std::setw(10) << "group" << std::setw(40) << "case" << std::right
+		          << std::setw(12) << "cycles" << std::setw(10) << "hit rate" << std::setw(10) << "bus util" << '\n';
+		for(unsigned  i = 0; i < cs.size(); i++) {
+			bool  best = true;
+			for(unsigned  j = 0; j < cs.size(); j++) {
+				if((cs[j].group == cs[i].group) && (stats[j].cycles < stats[i].cycles))  best = false;
+			}
+			std::cout << std::left << std::setw(10) << cs[i].group << std::setw(40) << cs[i].name << std::right
+			          << std::setw(12) << stats[i].cycles << std::fixed << std::setprecision(3)
+			          << std::setw(10) << stats[i].row_hit_rate() << std::setw(10) << stats[i].bus_utilization(cfg.burst_cycles())
+			          << (best? " *" : "") << '\n';
+		}
+		std::cout << std::endl;
+	}
+	return  EXIT_SUCCESS;
+}
@@ -0,0 +1,301 @@
+#   Copyright (c) 2019, Xilinx, Inc.
+#   All rights reserved.
+# 
+#   Redistribution and use in source and binary forms, with or without 
+#   modification, are permitted provided that the following conditions are met:
+#
+#   1.  Redistributions of source code must retain the above copyright notice, 
+#       this list of conditions and the following disclaimer.
+#
+#   2.  Redistributions in binary form must reproduce the above copyright 
+#       notice, this list of conditions and the following disclaimer in the 
+#       documentation and/or other materials provided with the distribution.
+#
+#   3.  Neither the name of the copyright holder nor the names of its 
+#       contributors may be used to endorse or promote products derived from 
+#       this software without specific prior written permission.
+#
+#   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+#   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+#   THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+#   PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR 
+#   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+#   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+#   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+#   OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+#   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+#   OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+#   ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#  
+#   Balances the PE/SIMD folding of the convolution and fully connected
+#   layers of a network description (see networks/cnv.net and finn_perf)
+#   under a LUT/BRAM/DSP budget.
+#
+#   Usage: python3 fold_optimizer.py <network file> [--lut N] [--bram N] [--dsp N]
+#                                    [--fclk MHz] [--header file.h] [--net file.net]
+#
+#   The frame rate of a dataflow pipeline is the one of its slowest layer, so
+#   the optimizer searches the smallest cycles per frame T for which every
+#   foldable layer has a folding with at most T cycles whose resources, summed
+#   over the network, fit the budget. Each layer takes its cheapest such
+#   folding, with SIMD dividing the input channels (conv) or MatrixW (fc) and
+#   PE dividing the output channels or MatrixH, as required by the library.
+#
+#   The cycle model mirrors perf_model.h. The resource model covers the weight
+#   memories (one per PE, TILES words of SIMD*WBITS bits, in LUTRAM when small
+#   and in BRAM18 otherwise), the MAC lanes (XNOR-popcount for WBITS=ABITS=1,
+#   DSPs for WBITS and ABITS of 4 and more, LUT multipliers otherwise) and the
+#   line buffer of the sliding window generator. Thresholds, FIFOs and blocks
+#   of fixed rate are not counted. WBITS and ABITS default to 1.
+#
+#   --header writes <NAME>_SIMD / <NAME>_PE defines for the generated configs,
+#   --net the network file with the new folding for finn_perf.
+#
+import argparse
+import math
+import sys
+
+
+#- Cycle model (perf_model.h) -------------------------------------------------
+
+def mvau_cycles(mw, mh, simd, pe, vectors=1):
+    return (mh // pe) * (mw // simd) * vectors
+
+
+def swg_cycles(k, ifm_ch, ifm_dim, ofm_dim, simd, stride=1):
+    mf = ifm_ch // simd
+    return ifm_dim * k * mf + ofm_dim * max(ofm_dim * k * k * mf, stride * ifm_dim * mf)
+
+
+def convlayer_cycles(k, ifm_ch, ifm_dim, ofm_ch, ofm_dim, simd, pe, stride=1):
+    return max(swg_cycles(k, ifm_ch, ifm_dim, ofm_dim, simd, stride),
+               mvau_cycles(k * k * ifm_ch, ofm_ch, simd, pe, ofm_dim * ofm_dim))
+
+
+def fixed_cycles(layer):
+    g = layer.get
+    if layer.type == "swg":
+        return swg_cycles(g("K"), g("IFMCh"), g("IFMDim"), g("OFMDim"), g("SIMD"), g("Stride", 1))
+    if layer.type == "dwc":
+        iw, ow, n = g("InWidth"), g("OutWidth"), g("NumInWords")
+        return n * (iw // ow) if iw > ow else n
+    if layer.type == "maxpool":
+        d, p = g("ImgDim"), g("PoolDim")
+        return d * d + (d // p) * (d // p)
+    if layer.type == "add":
+        return g("NumTotal") * (g("NumChannels") // g("PE"))
+    if layer.type == "dma":
+        return g("numBytes") // (g("DataWidth") // 8)
+    raise ValueError("%s: unknown block type %s" % (layer.name, layer.type))
+
+
+#- Resource model -------------------------------------------------------------
+
+LUTRAM_MAX_BITS = 1024
+
+# depth / width configurations of a RAMB18
+BRAM18_SHAPES = ((512, 36), (1024, 18), (2048, 9), (4096, 4), (8192, 2), (16384, 1))
+
+
+def memory(depth, width):
+    """LUTs and BRAM18s of a memory of depth words of width bits."""
+    if depth * width <= LUTRAM_MAX_BITS:
+        return int(math.ceil(depth / 64.0)) * width, 0
+    for d, w in BRAM18_SHAPES:
+        if depth <= d:
+            return 0, int(math.ceil(width / float(w)))
+    return 0, width * int(math.ceil(depth / 16384.0))
+
+
+class Layer(object):
+    def __init__(self, name, type, params):
+        self.name = name
+        self.type = type
+        self.params = params
+
+    def get(self, key, dflt=None):
+        if key in self.params:
+            return self.params[key]
+        if dflt is None:
+            raise ValueError("%s: missing parameter %s" % (self.name, key))
+        return dflt
+
+    def foldable(self):
+        return self.type in ("conv", "fc", "mvau")
+
+    def simd_dim(self):
+        return self.get("IFMCh") if self.type == "conv" else self.get("MW")
+
+    def pe_dim(self):
+        return self.get("OFMCh") if self.type == "conv" else self.get("MH")
+
+    def matrix(self):
+        if self.type == "conv":
+            return self.get("K") * self.get("K") * self.get("IFMCh"), self.get("OFMCh")
+        return self.get("MW"), self.get("MH")
+
+    def cycles(self, simd=None, pe=None):
+        if not self.foldable():
+            return fixed_cycles(self)
+        simd = self.get("SIMD") if simd is None else simd
+        pe = self.get("PE") if pe is None else pe
+        g = self.get
+        if self.type == "conv":
+            return convlayer_cycles(g("K"), g("IFMCh"), g("IFMDim"), g("OFMCh"), g("OFMDim"), simd, pe, g("Stride", 1))
+        mw, mh = self.matrix()
+        return mvau_cycles(mw, mh, simd, pe, g("Vectors", 1) if self.type == "mvau" else 1)
+
+    def resources(self, simd, pe):
+        """Estimated (LUT, BRAM18, DSP) of the layer with the given folding."""
+        wbits, abits = self.get("WBITS", 1), self.get("ABITS", 1)
+        mw, mh = self.matrix()
+        acc = int(math.ceil(math.log(mw + 1, 2))) + wbits + abits
+        tiles = (mw // simd) * (mh // pe)
+        mem_luts, brams = memory(tiles, simd * wbits)
+        luts, brams, dsps = pe * mem_luts, pe * brams, 0
+        if wbits == 1 and abits == 1:
+            luts += pe * (simd + acc)
+        elif wbits >= 4 and abits >= 4:
+            dsps += pe * simd
+            luts += pe * (simd * acc // 2 + acc)
+        else:
+            luts += pe * (simd * (wbits * abits + acc // 2) + acc)
+        if self.type == "conv":
+            # (K+1) lines of IFMDim pixels, SIMD channels per word
+            k, ifm_dim, ifm_ch = self.get("K"), self.get("IFMDim"), self.get("IFMCh")
+            buf_luts, buf_brams = memory(ifm_dim * (ifm_ch // simd), simd * abits)
+            luts += (k + 1) * buf_luts
+            brams += (k + 1) * buf_brams
+        return luts, brams, dsps
+
+
+def parse(path):
+    layers = []
+    with open(path) as f:
+        for line in f:
+            fields = line.split()
+            if not fields or fields[0].startswith("#"):
+                continue
+            if len(fields) < 2:
+                raise ValueError("%s: missing block type" % fields[0])
+            params, keys = {}, []
+            for kv in fields[2:]:
+                if "=" not in kv:
+                    raise ValueError("%s: expected KEY=value, got %s" % (fields[0], kv))
+                k, v = kv.split("=", 1)
+                params[k] = int(v)
+                keys.append(k)
+            layer = Layer(fields[0], fields[1], params)
+            layer.keys = keys
+            layers.append(layer)
+    return layers
+
+
+def divisors(n):
+    return [d for d in range(1, n + 1) if n % d == 0]
+
+
+#- Optimizer ------------------------------------------------------------------
+
+def foldings(layer):
+    """All (cycles, resources, simd, pe) of a foldable layer."""
+    if layer.type == "conv":
+        simds = divisors(layer.get("IFMCh"))
+    else:
+        simds = divisors(layer.simd_dim())
+    return [(layer.cycles(s, p), layer.resources(s, p), s, p)
+            for s in simds for p in divisors(layer.pe_dim())]
+
+
+def cost(res, budget):
+    # resources relative to the budget, plain LUT count without any budget
+    scaled = [float(r) / b for r, b in zip(res, budget) if b]
+    return sum(scaled) if scaled else float(res[0])
+
+
+def fits(total, budget):
+    return all(b is None or t <= b for t, b in zip(total, budget))
+
+
+def choose(options, target, budget):
+    """Cheapest folding of every layer reaching target cycles, or None."""
+    choice = []
+    for opts in options:
+        ok = [o for o in opts if o[0] <= target]
+        if not ok:
+            return None
+        choice.append(min(ok, key=lambda o: (cost(o[1], budget), o[2] * o[3], o[0])))
+    return choice
+
+
+def optimize(layers, budget):
+    fold = [l for l in layers if l.foldable()]
+    floor = max([l.cycles() for l in layers if not l.foldable()] or [0])
+    options = [foldings(l) for l in fold]
+    targets = sorted(set(o[0] for opts in options for o in opts if o[0] >= floor) | set([floor]))
+    best = None
+    lo, hi = 0, len(targets) - 1
+    # cheaper foldings only become available as the target grows: binary search
+    while lo <= hi:
+        mid = (lo + hi) // 2
+        choice = choose(options, targets[mid], budget)
+        if choice is not None and fits([sum(c[1][i] for c in choice) for i in range(3)], budget):
+            best = (targets[mid], choice)
+            hi = mid - 1
+        else:
+            lo = mid + 1
+    return fold, best
+
+
+def main(argv):
+    ap = argparse.ArgumentParser(description="Balance PE/SIMD of a network under a resource budget")
+    ap.add_argument("network")
+    ap.add_argument("--lut", type=int)
+    ap.add_argument("--bram", type=int, help="budget in BRAM18")
+    ap.add_argument("--dsp", type=int)
+    ap.add_argument("--fclk", type=float, default=100.0, help="clock frequency in MHz (default 100)")
+    ap.add_argument("--header", help="write the folding as #defines to this file")
+    ap.add_argument("--net", help="write the network with the new folding to this file")
+    args = ap.parse_args(argv[1:])
+
+    layers = parse(args.network)
+    budget = (args.lut, args.bram, args.dsp)
+    fold, best = optimize(layers, budget)
+    if best is None:
+        print("ERROR: the budget does not fit even the most folded network")
+        return 1
+    target, choice = best
+    for l, c in zip(fold, choice):
+        l.params["SIMD"], l.params["PE"] = c[2], c[3]
+        l.keys += [k for k in ("SIMD", "PE") if k not in l.keys]
+
+    print("%-12s %-8s %6s %6s %12s %8s %6s %6s" % ("layer", "type", "SIMD", "PE", "cycles/frame", "LUT", "BRAM18", "DSP"))
+    total = [0, 0, 0]
+    for l in layers:
+        if l.foldable():
+            res = l.resources(l.get("SIMD"), l.get("PE"))
+            total = [t + r for t, r in zip(total, res)]
+            print("%-12s %-8s %6d %6d %12d %8d %6d %6d" % ((l.name, l.type, l.get("SIMD"), l.get("PE"), l.cycles()) + tuple(res)))
+        else:
+            print("%-12s %-8s %6s %6s %12d" % (l.name, l.type, "", "", l.cycles()))
+    print("%-12s %-8s %6s %6s %12s %8d %6d %6d" % (("total", "", "", "", "") + tuple(total)))
+    print("%-12s %-8s %6s %6s %12s %8s %6s %6s" % (("budget", "", "", "", "") + tuple("-" if b is None else str(b) for b in budget)))
+    cycles = max(l.cycles() for l in layers)
+    print("\nBottleneck %d cycles/frame: %.1f frames/s at %.1f MHz" % (cycles, args.fclk * 1e6 / cycles, args.fclk))
+
+    if args.header:
+        with open(args.header, "wt") as f:
+            f.write("// folding generated by fold_optimizer.py for %s\n" % args.network)
+            for l in fold:
+                f.write("#define %s_SIMD %d\n" % (l.name.upper(), l.get("SIMD")))
+                f.write("#define %s_PE %d\n" % (l.name.upper(), l.get("PE")))
+    if args.net:
+        with open(args.net, "wt") as f:
+            f.write("# %s refolded by fold_optimizer.py\n" % args.network)
+            for l in layers:
+                f.write("%-10s%-8s%s\n" % (l.name, l.type, " ".join("%s=%d" % (k, l.params[k]) for k in l.keys)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,237 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file perf_tool.cpp
+ *
+ *  Throughput estimate of a dataflow network from the analytic model of
+ *  perf_model.h, with bottleneck detection and PE/SIMD rebalancing hints.
+ *
+ *  Usage: finn_perf <network file> [--fclk <MHz>] [--fps <target frames/s>]
+ *
+ *  The network file lists one block per line as
+ *    <name> <type> KEY=value ...
+ *  with the types and keys
+ *    conv     K IFMCh IFMDim OFMCh OFMDim SIMD PE [Stride]
+ *    fc       MW MH SIMD PE
+ *    mvau     MW MH SIMD PE [Vectors]
+ *    swg      K IFMCh IFMDim OFMDim SIMD [Stride]
+ *    dwc      InWidth OutWidth NumInWords
+ *    maxpool  ImgDim PoolDim
+ *    add      NumChannels PE NumTotal
+ *    dma      DataWidth numBytes
+ *  Lines starting with # are comments, other keys (e.g. the WBITS and ABITS
+ *  of fold_optimizer.py) are ignored. See networks/cnv.net.
+ *
+ *  The foldable layers (conv, fc, mvau) are then rebalanced to the cheapest
+ *  folding (smallest PE*SIMD) that keeps up with the target frame rate, by
+ *  default the one of the current bottleneck. Layers that cannot reach the
+ *  target get their fastest folding; blocks of other types have fixed rates.
+ *
+ *****************************************************************************/
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "perf_model.h"
+
+using namespace finn::perf;
+
+namespace {
+
+struct Layer {
+	std::string  name;
+	std::string  type;
+	std::map<std::string, unsigned>  p;
+
+	unsigned get(char const *key, unsigned const  dflt = 0) const {
+		auto const  it = p.find(key);
+		if(it != p.end())  return  it->second;
+		if(dflt == 0)  throw std::runtime_error(name + ": missing parameter " + key);
+		return  dflt;
+	}
+
+	bool foldable() const { return  type == "conv" || type == "fc" || type == "mvau"; }
+
+	/** Input channels folded by SIMD and output channels folded by PE. */
+	unsigned simd_dim() const { return  type == "conv"? get("IFMCh") : get("MW"); }
+	unsigned pe_dim()   const { return  type == "conv"? get("OFMCh") : get("MH"); }
+
+	cycles_t cycles(unsigned const  simd, unsigned const  pe) const {
+		if(type == "conv")  return  convlayer_cycles(get("K"), get("IFMCh"), get("IFMDim"), get("OFMCh"), get("OFMDim"), simd, pe, get("Stride", 1));
+		if(type == "fc")    return  mvau_cycles(get("MW"), get("MH"), simd, pe);
+		if(type == "mvau")  return  mvau_cycles(get("MW"), get("MH"), simd, pe, get("Vectors", 1));
+		throw std::runtime_error(name + ": not foldable");
+	}
+
+	cycles_t cycles() const {
+		if(foldable())         return  cycles(get("SIMD"), get("PE"));
+		if(type == "swg")      return  swg_cycles(get("K"), get("IFMCh"), get("IFMDim"), get("OFMDim"), get("SIMD"), get("Stride", 1));
+		if(type == "dwc")      return  dwc_cycles(get("InWidth"), get("OutWidth"), get("NumInWords"));
+		if(type == "maxpool")  return  maxpool_cycles(get("ImgDim"), get("PoolDim"));
+		if(type == "add")      return  add_cycles(get("NumChannels"), get("PE"), get("NumTotal"));
+		if(type == "dma")      return  dma_cycles(get("DataWidth"), get("numBytes"));
+		throw std::runtime_error(name + ": unknown block type " + type);
+	}
+};
+
+std::vector<Layer> parse(std::istream &in) {
+	std::vector<Layer>  layers;
+	std::string  line;
+	while(std::getline(in, line)) {
+		std::istringstream  ls(line);
+		Layer  l;
+		if(!(ls >> l.name) || l.name[0] == '#')  continue;
+		if(!(ls >> l.type))  throw std::runtime_error(l.name + ": missing block type");
+		for(std::string kv; ls >> kv; ) {
+			size_t const  eq = kv.find('=');
+			if(eq == std::string::npos)  throw std::runtime_error(l.name + ": expected KEY=value, got " + kv);
+			l.p[kv.substr(0, eq)] = unsigned(std::strtoul(kv.c_str() + eq + 1, nullptr, 10));
+		}
+		layers.push_back(l);
+	}
+	return  layers;
+}
+
+std::vector<unsigned> divisors(unsigned const  n) {
+	std::vector<unsigned>  d;
+	for(unsigned i = 1; i <= n; i++)  if(n % i == 0)  d.push_back(i);
+	return  d;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	char const *path = nullptr;
+	double  fclk = 100.0;
+	double  fps = 0.0;
+	for(int i = 1; i < argc; i++) {
+		if(!std::strcmp(argv[i], "--fclk") && i+1 < argc)      fclk = std::atof(argv[++i]);
+		else if(!std::strcmp(argv[i], "--fps") && i+1 < argc)  fps = std::atof(argv[++i]);
+		else if(!path && argv[i][0] != '-')                    path = argv[i];
+		else  path = nullptr, i = argc;
+	}
+	if(!path) {
+		std::cerr << "Usage: " << argv[0] << " <network file> [--fclk <MHz>] [--fps <target frames/s>]" << std::endl;
+		return  2;
+	}
+	std::ifstream  in(path);
+	if(!in) {
+		std::cerr << "Cannot open " << path << std::endl;
+		return  2;
+	}
+
+	try {
+		std::vector<Layer> const  layers = parse(in);
+		if(layers.empty())  throw std::runtime_error("empty network");
+
+		cycles_t  worst = 0;
+		size_t  bottleneck = 0;
+		for(size_t i = 0; i < layers.size(); i++) {
+			cycles_t const  c = layers[i].cycles();
+			if(c > worst) {
+				worst = c;
+				bottleneck = i;
+			}
+		}
+
+		std::cout << std::left << std::setw(16) << "layer" << std::setw(9) << "type" << std::right
+		          << std::setw(8) << "SIMD" << std::setw(8) << "PE" << std::setw(14) << "cycles/frame"
+		          << std::setw(12) << "frames/s" << std::setw(9) << "load" << '\n';
+		for(size_t i = 0; i < layers.size(); i++) {
+			Layer const &l = layers[i];
+			cycles_t const  c = l.cycles();
+			std::cout << std::left << std::setw(16) << l.name << std::setw(9) << l.type << std::right
+			          << std::setw(8) << (l.p.count("SIMD")? std::to_string(l.get("SIMD")) : "-")
+			          << std::setw(8) << (l.p.count("PE")? std::to_string(l.get("PE")) : "-")
+			          << std::setw(14) << c
+			          << std::setw(12) << std::fixed << std::setprecision(1) << frames_per_second(c, fclk)
+			          << std::setw(8) << std::setprecision(0) << 100.0 * c / worst << '%'
+			          << (i == bottleneck? "  <- bottleneck" : "") << '\n';
+		}
+		std::cout << "\nEstimated throughput at " << std::setprecision(1) << fclk << " MHz: "
+		          << frames_per_second(worst, fclk) << " frames/s, bottleneck " << layers[bottleneck].name
+		          << " (" << worst << " cycles/frame)" << std::endl;
+
+		// rebalancing
+		cycles_t const  target = fps > 0.0? cycles_t(fclk * 1e6 / fps) : worst;
+		std::cout << "\nFolding for " << target << " cycles/frame (" << frames_per_second(target, fclk) << " frames/s):\n";
+		bool  changes = false;
+		for(Layer const &l : layers) {
+			if(!l.foldable())  continue;
+			// fully unrolled is the fastest this layer can get
+			cycles_t const  fastest = l.cycles(l.simd_dim(), l.pe_dim());
+			bool const  reachable = fastest <= target;
+			cycles_t const  layer_target = reachable? target : fastest;
+			// start from the current folding if it keeps up, so that it wins all ties
+			unsigned  best_simd = l.get("SIMD"), best_pe = l.get("PE");
+			cycles_t  best_cycles = l.cycles();
+			if(best_cycles > layer_target) {
+				best_simd = l.simd_dim();
+				best_pe = l.pe_dim();
+				best_cycles = fastest;
+			}
+			for(unsigned const  simd : divisors(l.simd_dim())) {
+				for(unsigned const  pe : divisors(l.pe_dim())) {
+					cycles_t const  c = l.cycles(simd, pe);
+					if(c > layer_target)  continue;
+					if(simd*pe < best_simd*best_pe || (simd*pe == best_simd*best_pe && c < best_cycles)) {
+						best_simd = simd;
+						best_pe = pe;
+						best_cycles = c;
+					}
+				}
+			}
+			// only report foldings that are faster or cheaper than the current one
+			if(best_cycles < l.cycles() || best_simd*best_pe < l.get("SIMD")*l.get("PE")) {
+				changes = true;
+				std::cout << "  " << std::left << std::setw(16) << l.name << std::right
+				          << "SIMD " << l.get("SIMD") << " -> " << best_simd << ", PE " << l.get("PE") << " -> " << best_pe
+				          << "  (" << l.cycles() << " -> " << best_cycles << " cycles/frame)"
+				          << (reachable? "" : "  target not reachable") << '\n';
+			}
+		}
+		if(!changes)  std::cout << "  current folding is balanced\n";
+	}
+	catch(std::exception const &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return  2;
+	}
+	return  0;
+}
@@ -56,9 +56,13 @@ using namespace std;
 
 #define CASSERT_DATAFLOW(x) {if (!(x)) {std::cout<< "CASSERT_DATAFLOW condition is not met " << endl; exit(-1);	}}
 
+#include "dataflow.h"
 #include "streamtools.h"
 #include "dma.h"
 #include "slidingwindow.h"
+#include "upsample.h"
 #include "maxpool.h"
 #include "fclayer.h"
 #include "convlayer.h"
+#include "instrumentation.h"
+#include "network.h"
@@ -51,6 +51,7 @@
 #include <ap_int.h>
 #include <hls_stream.h>
 
+#include "dataflow.h"
 #include "streamtools.h"
 #include "mvau.hpp"
 /**
@@ -106,18 +107,108 @@ void ConvLayer_Batch(hls::stream<ap_uint<InStreamW>>  &in,
 			    unsigned const   reps,
 				R const &r) {
 #pragma HLS INLINE
+  FINN_DATAFLOW_REGION;
   unsigned const MatrixW = ConvKernelDim * ConvKernelDim * IFMChannels;
   unsigned const MatrixH = OFMChannels;
   unsigned const InpPerImage = IFMDim*IFMDim*IFMChannels/InStreamW * TSrcI::width;
   WidthAdjustedInputStream <InStreamW, SIMD*TSrcI::width, InpPerImage>  wa_in (in,  reps);
   WidthAdjustedOutputStream <PE*TDstI::width, OutStreamW, OFMDim * OFMDim * (OFMChannels / PE)>  mvOut (out,  reps);
   hls::stream<ap_uint<SIMD*TSrcI::width> > convInp("StreamingConvLayer_Batch.convInp");
-  ConvolutionInputGenerator<ConvKernelDim, IFMChannels, TSrcI::width, IFMDim,
-			OFMDim, SIMD,1>(wa_in, convInp, reps);
-  Matrix_Vector_Activate_Batch<MatrixW, MatrixH, SIMD, PE, TSrcI, TDstI, TWeightI>
+  FINN_DATAFLOW_STAGE(ConvolutionInputGenerator<ConvKernelDim, IFMChannels, TSrcI::width, IFMDim,
+			OFMDim, SIMD,1>(wa_in, convInp, reps));
+  FINN_DATAFLOW_STAGE(Matrix_Vector_Activate_Batch<MatrixW, MatrixH, SIMD, PE, TSrcI, TDstI, TWeightI>
     (static_cast<hls::stream<ap_uint<SIMD*TSrcI::width>>&>(convInp),
      static_cast<hls::stream<ap_uint<PE*TDstI::width>>&>  (mvOut),
-     weights, activation, reps* OFMDim * OFMDim, r);
+     weights, activation, reps* OFMDim * OFMDim, r));
+}
+
+
+/**
+ * \brief 	Transposed convolutional layer implementation
+ *
+ * The function implements a transposed convolution (a.k.a. deconvolution) with Stride > 1 without
+ * inserting zeros between the input pixels. The Stride*Stride sub-pixel convolutions of kernel
+ * Kp = ceil(ConvKernelDim/Stride) are computed by a single Matrix_Vector_Activate_Batch fed by the
+ * TransposedConvolutionInputGenerator, and the sub-pixel outputs are rearranged into the output
+ * image by DepthToSpace_Batch, which also drops the Padding border.
+ * The output image has OFMDim = (IFMDim-1)*Stride + ConvKernelDim - 2*Padding pixels per side.
+ *
+ * The weights and activation objects describe the rearranged matrix of
+ * Kp*Kp*IFMChannels columns and Stride*Stride*OFMChannels rows (see TransposedConvolutionInputGenerator
+ * for the mapping of the kernel coefficients). PE has to divide OFMChannels.
+ *
+ * \tparam ConvKernelDim 	Dimension of the transposed convolutional kernel (assumed square)
+ * \tparam IFMChannels 		Number of Input Feature Maps
+ * \tparam IFMDim 			Width and Heigth of the Input Feature Map (assumed square)
+ * \tparam OFMChannels 		Number of Output Feature Maps
+ * \tparam Stride 			Stride (i.e. upsampling factor) of the transposed convolution
+ * \tparam Padding 			Number of output pixels cropped at each border of the output image
+ * \tparam SIMD 			Number of input columns computed in parallel
+ * \tparam PE 				Number of output rows computed in parallel
+ * \tparam TSrcI 			DataType of the input activation (as used in the MAC)
+ * \tparam TDstI 			DataType of the output activation (as generated by the activation)
+ * \tparam TWeightI 		DataType of the weights (as used in the MAC)
+ * \tparam InStreamW 		Width of the input stream
+ * \tparam OutStreamW 		Width of the output stream
+ * \tparam TW 				DataType of the weights matrix - safely deducible from the paramaters
+ * \tparam TA 				DataType of the activation class (e.g. thresholds) - safely deducible from the paramaters
+ * \tparam R 				Datatype for the resource used for FPGA implementation of the MAC  - safely deducible from the paramaters
+ *
+ * \param in 				Input stream
+ * \param out 				Output stream
+ * \param weights 			Rearranged weights matrix (currently supports BinaryWeights or FixedPointWeights)
+ * \param activation 		Activation class
+ * \param reps 				Number of time the function has to be repeatedly executed (e.g. number of images)
+ * \param r 				Resource type for the hardware implementation of the MAC block
+ */
+template<
+		unsigned int ConvKernelDim,
+		unsigned int IFMChannels,
+		unsigned int IFMDim,
+		unsigned int OFMChannels,
+		unsigned int Stride,
+		unsigned int Padding,
+
+		unsigned int SIMD, 				// number of SIMD lanes
+		unsigned int PE,				// number of PEs
+
+		typename TSrcI = Identity,      // redefine I/O interpretation as needed for input activations
+		typename TDstI = Identity,		// redefine I/O interpretation as needed for output activations
+		typename TWeightI = Identity,	// redefine I/O interpretation as needed for weigths
+
+		int InStreamW, int OutStreamW,  // safely deducible (stream width must be int though!)
+		typename TW,   typename TA,  typename R
+>
+void TransposedConvLayer_Batch(hls::stream<ap_uint<InStreamW>>  &in,
+			    hls::stream<ap_uint<OutStreamW>> &out,
+			    TW const        &weights,
+			    TA const        &activation,
+			    unsigned const   reps,
+				R const &r) {
+#pragma HLS INLINE
+  FINN_DATAFLOW_REGION;
+  unsigned const SubKernelDim = (ConvKernelDim + Stride - 1) / Stride;
+  unsigned const SubOFMDim = IFMDim + SubKernelDim - 1;
+  unsigned const OFMDim = (IFMDim - 1) * Stride + ConvKernelDim - 2 * Padding;
+  unsigned const MatrixW = SubKernelDim * SubKernelDim * IFMChannels;
+  unsigned const MatrixH = Stride * Stride * OFMChannels;
+  unsigned const InpPerImage = IFMDim*IFMDim*IFMChannels/InStreamW * TSrcI::width;
+  unsigned const SubPixPerImage = SubOFMDim * SubOFMDim * Stride * Stride;
+  CASSERT_DATAFLOW(OFMChannels % PE == 0);
+  WidthAdjustedInputStream <InStreamW, SIMD*TSrcI::width, InpPerImage>  wa_in (in,  reps);
+  WidthAdjustedOutputStream <OFMChannels*TDstI::width, OutStreamW, OFMDim * OFMDim>  wa_out (out,  reps);
+  hls::stream<ap_uint<SIMD*TSrcI::width> > convInp("TransposedConvLayer_Batch.convInp");
+  hls::stream<ap_uint<PE*TDstI::width> > mvOut("TransposedConvLayer_Batch.mvOut");
+  hls::stream<ap_uint<OFMChannels*TDstI::width> > subPix("TransposedConvLayer_Batch.subPix");
+  FINN_DATAFLOW_STAGE(TransposedConvolutionInputGenerator<ConvKernelDim, IFMChannels, TSrcI::width, IFMDim,
+			SIMD, Stride>(wa_in, convInp, reps));
+  FINN_DATAFLOW_STAGE(Matrix_Vector_Activate_Batch<MatrixW, MatrixH, SIMD, PE, TSrcI, TDstI, TWeightI>
+    (static_cast<hls::stream<ap_uint<SIMD*TSrcI::width>>&>(convInp),
+     mvOut, weights, activation, reps * SubOFMDim * SubOFMDim, r));
+  FINN_DATAFLOW_STAGE(StreamingDataWidthConverter_Batch<PE*TDstI::width, OFMChannels*TDstI::width, SubPixPerImage * (OFMChannels / PE)>
+    (mvOut, subPix, reps));
+  FINN_DATAFLOW_STAGE(DepthToSpace_Batch<SubOFMDim, Stride, OFMChannels, ap_uint<TDstI::width>, OFMDim, Padding>
+    (subPix, static_cast<hls::stream<ap_uint<OFMChannels*TDstI::width>>&>(wa_out), reps));
 }
 
 
@@ -0,0 +1,278 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/******************************************************************************
+ *
+ *  \file dataflow.h
+ *
+ *  Markers of dataflow regions and of their processes (stages).
+ *
+ *  In synthesis and in the default C simulation, the markers expand to
+ *  nothing and the stages are plain function calls executed one after the
+ *  other. When compiled with FINN_THREADED_CSIM (which requires the
+ *  instrumented streams of sim/hls_stream.h, i.e. -I$FINN_HLS_ROOT/sim in
+ *  front of the include path), every stage runs on its own thread and the
+ *  streams declared inside a region become bounded FIFOs, so that a C
+ *  simulation scales across cores and deadlocks like the hardware would.
+ *
+ *  Usage, inside a function with #pragma HLS DATAFLOW (or INLINE into one):
+ *
+ *    FINN_DATAFLOW_REGION;
+ *    hls::stream<ap_uint<8>>  s("s");
+ *    FINN_DATAFLOW_STAGE(Producer(in, s));
+ *    FINN_DATAFLOW_STAGE(Consumer(s, out));
+ *
+ *  The region must be opened before the streams it connects are declared,
+ *  and every process of the region has to be a stage. The stages are joined
+ *  when the first stream of the region goes out of scope.
+ *
+ *  Environment variables of the threaded mode:
+ *   - FINN_STREAM_DEFAULT_DEPTH  depth of the streams of a region (default 2)
+ *   - FINN_STREAM_DEPTHS         per-stream depths, see sim/hls_stream.h
+ *   - FINN_DEADLOCK_TIMEOUT_MS   time without any stream progress after which
+ *                                a deadlock is reported (default 5000)
+ *
+ *****************************************************************************/
+
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#if defined(FINN_THREADED_CSIM) && !defined(__SYNTHESIS__)
+#define FINN_DATAFLOW_THREADED
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace finn {
+namespace dataflow {
+
+/** Count of successful stream accesses, used to detect the lack of progress. */
+inline std::atomic<unsigned long long>& progress() {
+  static std::atomic<unsigned long long>  cnt(0);
+  return  cnt;
+}
+
+/** Number of stage threads currently running. */
+inline std::atomic<unsigned>& live_stages() {
+  static std::atomic<unsigned>  cnt(0);
+  return  cnt;
+}
+
+/**
+ * \brief   Dataflow region - owns the threads of its stages
+ *
+ * Regions nest: the innermost region of the calling thread is the current one.
+ * Stage threads start without a current region, so that a stage can open its own.
+ */
+class Region {
+  Region                   *m_parent;
+  std::vector<std::thread>  m_threads;
+  std::mutex                m_mutex;
+
+  static Region*& current_ref() {
+    // __thread rather than thread_local for the gcc 4.6 of the Vivado HLS C simulation
+    static __thread Region *cur = nullptr;
+    return  cur;
+  }
+
+ public:
+  Region() : m_parent(current_ref()) {
+    current_ref() = this;
+  }
+  ~Region() {
+    join();
+    current_ref() = m_parent;
+  }
+  Region(Region const&) = delete;
+  Region& operator=(Region const&) = delete;
+
+ public:
+  static Region* current() {
+    return  current_ref();
+  }
+
+  /**
+   * Clears the current region for its lifetime, e.g. to create an unbounded
+   * stream that outlives the region from within one of its stages.
+   */
+  class Detach {
+    Region *const  m_saved;
+   public:
+    Detach() : m_saved(current_ref()) {
+      current_ref() = nullptr;
+    }
+    ~Detach() {
+      current_ref() = m_saved;
+    }
+  };
+
+  /** Starts a stage on its own thread. */
+  void spawn(std::function<void()> const &stage) {
+    live_stages()++;
+    std::lock_guard<std::mutex>  lock(m_mutex);
+    m_threads.emplace_back([stage]() {
+      stage();
+      live_stages()--;
+    });
+  }
+
+  /** Waits for the completion of all stages started so far. */
+  void join() {
+    std::vector<std::thread>  threads;
+    {
+      std::lock_guard<std::mutex>  lock(m_mutex);
+      threads.swap(m_threads);
+    }
+    for(auto &t : threads)  t.join();
+  }
+};
+
+/** Runs a stage in the current region, or synchronously if there is none. */
+inline void spawn(std::function<void()> const &stage) {
+  Region *const  region = Region::current();
+  if(region)  region->spawn(stage);
+  else        stage();
+}
+
+/**
+ * \brief   Bookkeeping of blocked stream accesses for the deadlock report
+ */
+class BlockedAccesses {
+  std::mutex                         m_mutex;
+  std::map<void const*, std::string> m_blocked;
+
+ public:
+  static BlockedAccesses& instance() {
+    static BlockedAccesses  inst;
+    return  inst;
+  }
+  void add(void const *key, std::string const &what) {
+    std::lock_guard<std::mutex>  lock(m_mutex);
+    m_blocked[key] = what;
+  }
+  void remove(void const *key) {
+    std::lock_guard<std::mutex>  lock(m_mutex);
+    m_blocked.erase(key);
+  }
+  void report(std::ostream &os) {
+    std::lock_guard<std::mutex>  lock(m_mutex);
+    for(auto const &b : m_blocked)  os << "  " << b.second << '\n';
+  }
+};
+
+/**
+ * \brief   Wait helper of a blocking stream access with deadlock detection
+ *
+ * A deadlock is reported, and the simulation terminated, when no stream
+ * access has completed anywhere for FINN_DEADLOCK_TIMEOUT_MS, or right away
+ * if the blocked thread is the only one left.
+ */
+class Waiter {
+  void const         *m_key;
+  std::string const   m_what;
+  unsigned long long  m_progress;
+  std::chrono::steady_clock::time_point  m_since;
+  unsigned            m_spins;
+  bool                m_registered;
+
+  static unsigned timeout_ms() {
+    static unsigned const  ms = []() {
+      char const *const  env = std::getenv("FINN_DEADLOCK_TIMEOUT_MS");
+      return  env? unsigned(std::strtoul(env, nullptr, 10)) : 5000u;
+    }();
+    return  ms;
+  }
+
+  void deadlock(char const *reason) {
+    std::cerr << "DEADLOCK: " << reason << ", blocked stream accesses:" << std::endl;
+    BlockedAccesses::instance().report(std::cerr);
+    std::cerr.flush();
+    std::fflush(nullptr);
+    ::_Exit(EXIT_FAILURE);
+  }
+
+ public:
+  Waiter(void const *key, std::string const &what)
+    : m_key(key), m_what(what), m_progress(progress().load()),
+      m_since(std::chrono::steady_clock::now()), m_spins(0), m_registered(false) {}
+  ~Waiter() {
+    if(m_registered)  BlockedAccesses::instance().remove(m_key);
+  }
+
+  void wait() {
+    if(!m_registered) {
+      BlockedAccesses::instance().add(m_key, m_what);
+      m_registered = true;
+    }
+    if(++m_spins < 64) {
+      std::this_thread::yield();
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(20));
+    if((m_spins & 0xFF) != 0)  return;
+
+    if(live_stages() == 0)  deadlock("no stage left to unblock the main thread");
+    unsigned long long const  now = progress().load();
+    auto const  t = std::chrono::steady_clock::now();
+    if(now != m_progress) {
+      m_progress = now;
+      m_since = t;
+    }
+    else if(std::chrono::duration_cast<std::chrono::milliseconds>(t - m_since).count() > timeout_ms()) {
+      deadlock("no stream progress");
+    }
+  }
+};
+
+} // namespace dataflow
+} // namespace finn
+
+#define FINN_DATAFLOW_REGION  finn::dataflow::Region  finn_dataflow_region__
+#define FINN_DATAFLOW_STAGE(...)  finn::dataflow::spawn([&]() { __VA_ARGS__; })
+
+#else
+
+#define FINN_DATAFLOW_REGION  do {} while(0)
+#define FINN_DATAFLOW_STAGE(...)  __VA_ARGS__
+
+#endif
+
+#endif
@@ -42,6 +42,10 @@
  *  Library of templated HLS functions for BNN deployment. 
  *  This file lists a set of functions to access memory mapped values into 
  *  streams. 
+ *  The memory pointers are template parameters, so that the C simulation can
+ *  pass a finn::dram::ModeledPtr (dram_model.h) to estimate DRAM timing. They
+ *  must point to ap_uint<DataWidth> words, which every function checks at
+ *  compile time.
  *
  *****************************************************************************/
 #ifndef DMA_HPP
@@ -51,6 +55,37 @@
 #include <ap_int.h>
 #include <hls_stream.h>
 
+#include "dataflow.h"
+
+namespace finn {
+namespace dram {
+template<typename T> class ModeledPtr;
+}
+}
+
+/*!
+ * \brief Whether MemPtr points to Word elements, as a raw pointer or a finn::dram::ModeledPtr
+ */
+template<typename MemPtr, typename Word>
+struct IsDmaMemPtr {
+  static bool const  value = false;
+};
+template<typename Word>
+struct IsDmaMemPtr<Word*, Word> {
+  static bool const  value = true;
+};
+template<typename Word>
+struct IsDmaMemPtr<Word const*, Word> {
+  static bool const  value = true;
+};
+template<typename Word>
+struct IsDmaMemPtr<finn::dram::ModeledPtr<Word>, Word> {
+  static bool const  value = true;
+};
+
+#define DMA_CHECK_MEMPTR(MemPtr, DataWidth) \
+  static_assert(IsDmaMemPtr<MemPtr, ap_uint<DataWidth> >::value, "The memory pointer must point to ap_uint<DataWidth> words")
+
 /*!
  * \brief DMA block accessing AXI4 memory and output HLS streams
  *
@@ -61,8 +96,8 @@
  * \param in Input memory pointer
  * \param out Output HLS stream
  */
-template<unsigned int DataWidth, unsigned int numBytes>
-void Mem2Stream(ap_uint<DataWidth> * in, hls::stream<ap_uint<DataWidth> > & out);
+template<unsigned int DataWidth, unsigned int numBytes, typename MemPtr>
+void Mem2Stream(MemPtr in, hls::stream<ap_uint<DataWidth> > & out);
 
 /*!
  * \brief DMA block accessing AXI4 memory and output HLS streams multiple times
@@ -77,8 +112,8 @@ void Mem2Stream(ap_uint<DataWidth> * in, hls::stream<ap_uint<DataWidth> > & out)
  * \param out Output HLS stream
  * \param numReps Number of times the Stream2Mem function has to be called
  */
-template<unsigned int DataWidth, unsigned int numBytes>
-void Mem2Stream_Batch(ap_uint<DataWidth> * in, hls::stream<ap_uint<DataWidth> > & out, const unsigned int numReps);
+template<unsigned int DataWidth, unsigned int numBytes, typename MemPtr>
+void Mem2Stream_Batch(MemPtr in, hls::stream<ap_uint<DataWidth> > & out, const unsigned int numReps);
 
 /*!
  * \brief DMA block writing HLS streams content in AXI4 pointed memory
@@ -90,8 +125,8 @@ void Mem2Stream_Batch(ap_uint<DataWidth> * in, hls::stream<ap_uint<DataWidth> >
  * \param in Input HLS stream
  * \param out Output memory pointer
  */
-template<unsigned int DataWidth, unsigned int numBytes>
-void Stream2Mem(hls::stream<ap_uint<DataWidth> > & in, ap_uint<DataWidth> * out);
+template<unsigned int DataWidth, unsigned int numBytes, typename MemPtr>
+void Stream2Mem(hls::stream<ap_uint<DataWidth> > & in, MemPtr out);
 
 /*!
  * \brief DMA block that accesses the external memory and outputs HLS streams multiple times
@@ -106,9 +141,10 @@ void Stream2Mem(hls::stream<ap_uint<DataWidth> > & in, ap_uint<DataWidth> * out)
  * \param out Output the generated HLS sream
  * \param numReps Number of times the Mem2Stream function has to be called
  */
-template<unsigned int DataWidth, unsigned int numBytes>
-void Mem2Stream_Batch_external_wmem(ap_uint<DataWidth> * in,
+template<unsigned int DataWidth, unsigned int numBytes, typename MemPtr>
+void Mem2Stream_Batch_external_wmem(MemPtr in,
         hls::stream<ap_uint<DataWidth> > & out, const unsigned int numReps) {
+    DMA_CHECK_MEMPTR(MemPtr, DataWidth);
     unsigned int rep = 0;
     while (rep != numReps) {
         Mem2Stream<DataWidth, numBytes>(&in[0], out);
@@ -129,11 +165,12 @@ void Mem2Stream_Batch_external_wmem(ap_uint<DataWidth> * in,
  * \param out Output memory pointer
  * \param numReps Number of times the Stream2Mem function has to be called
  */
-template<unsigned int DataWidth, unsigned int numBytes>
-void Stream2Mem_Batch(hls::stream<ap_uint<DataWidth> > & in, ap_uint<DataWidth> * out, const unsigned int numReps);
+template<unsigned int DataWidth, unsigned int numBytes, typename MemPtr>
+void Stream2Mem_Batch(hls::stream<ap_uint<DataWidth> > & in, MemPtr out, const unsigned int numReps);
 
-template<unsigned int DataWidth, unsigned int numBytes>
-void Mem2Stream(ap_uint<DataWidth> * in, hls::stream<ap_uint<DataWidth> > & out) {
+template<unsigned int DataWidth, unsigned int numBytes, typename MemPtr>
+void Mem2Stream(MemPtr in, hls::stream<ap_uint<DataWidth> > & out) {
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
   CASSERT_DATAFLOW(DataWidth % 8 == 0);
   const unsigned int numWords = numBytes / (DataWidth / 8);
   CASSERT_DATAFLOW(numWords != 0);
@@ -145,8 +182,9 @@ void Mem2Stream(ap_uint<DataWidth> * in, hls::stream<ap_uint<DataWidth> > & out)
 }
 
 
-template<unsigned int DataWidth, unsigned int numBytes>
-void Stream2Mem(hls::stream<ap_uint<DataWidth> > & in, ap_uint<DataWidth> * out) {
+template<unsigned int DataWidth, unsigned int numBytes, typename MemPtr>
+void Stream2Mem(hls::stream<ap_uint<DataWidth> > & in, MemPtr out) {
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
   CASSERT_DATAFLOW(DataWidth % 8 == 0);
   const unsigned int numWords = numBytes / (DataWidth / 8);
   CASSERT_DATAFLOW(numWords != 0);
@@ -157,8 +195,9 @@ void Stream2Mem(hls::stream<ap_uint<DataWidth> > & in, ap_uint<DataWidth> * out)
   }
 }
 
-template<unsigned int DataWidth, unsigned int numBytes>
-void Mem2Stream_Batch(ap_uint<DataWidth> * in, hls::stream<ap_uint<DataWidth> > & out, const unsigned int numReps) {
+template<unsigned int DataWidth, unsigned int numBytes, typename MemPtr>
+void Mem2Stream_Batch(MemPtr in, hls::stream<ap_uint<DataWidth> > & out, const unsigned int numReps) {
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
   const unsigned int indsPerRep = numBytes / (DataWidth / 8);
   unsigned int rep = 0;
   // make sure Mem2Stream does not get inlined here
@@ -178,8 +217,9 @@ void Mem2Stream_Batch(ap_uint<DataWidth> * in, hls::stream<ap_uint<DataWidth> >
 }
 
 
-template<unsigned int DataWidth, unsigned int numBytes>
-void Stream2Mem_Batch(hls::stream<ap_uint<DataWidth> > & in, ap_uint<DataWidth> * out, const unsigned int numReps) {
+template<unsigned int DataWidth, unsigned int numBytes, typename MemPtr>
+void Stream2Mem_Batch(hls::stream<ap_uint<DataWidth> > & in, MemPtr out, const unsigned int numReps) {
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
   const unsigned int indsPerRep = numBytes / (DataWidth / 8);
   unsigned int rep = 0;
   // make sure Stream2Mem does not get inlined here
@@ -198,4 +238,592 @@ void Stream2Mem_Batch(hls::stream<ap_uint<DataWidth> > & in, ap_uint<DataWidth>
   }
 }
 
+/*!
+ * \brief Descriptor of a (up to) three-dimensional memory region
+ *
+ * All quantities are expressed in memory words of the DMA data width. The region
+ * is made of planes x rows rows of words contiguous words each: row r of plane p
+ * starts at offset + p * planeStride + r * rowStride. A contiguous region is
+ * described by rows = planes = 1, a 2D tile or crop by planes = 1.
+ */
+struct DmaDescriptor {
+  unsigned int offset;       //!< First word of the region
+  unsigned int words;        //!< Contiguous words per row, i.e. the burst length
+  unsigned int rows;         //!< Number of rows per plane
+  unsigned int rowStride;    //!< Distance, in words, between the first words of two rows
+  unsigned int planes;       //!< Number of planes
+  unsigned int planeStride;  //!< Distance, in words, between the first words of two planes
+};
+
+/*!
+ * \brief DMA block reading a single contiguous row of runtime length
+ *
+ * The function is kept out of line so that every row is inferred as a single AXI4 burst.
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory pointer and the output HLS stream
+ * \tparam MaxWords Maximum row length, used for latency estimation only
+ *
+ * \param in Input memory pointer, pointing at the first word of the row
+ * \param out Output HLS stream
+ * \param words Number of words to be read
+ */
+template<unsigned int DataWidth, unsigned int MaxWords, typename MemPtr>
+void Mem2Stream_Row(MemPtr in, hls::stream<ap_uint<DataWidth> > & out, const unsigned int words) {
+#pragma HLS INLINE off
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  for (unsigned int i = 0; i < words; i++) {
+#pragma HLS PIPELINE II=1
+#pragma HLS LOOP_TRIPCOUNT min=1 max=MaxWords
+    ap_uint<DataWidth> e = in[i];
+    out.write(e);
+  }
+}
+
+/*!
+ * \brief DMA block writing a single contiguous row of runtime length
+ *
+ * The function is kept out of line so that every row is inferred as a single AXI4 burst.
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory pointer and the input HLS stream
+ * \tparam MaxWords Maximum row length, used for latency estimation only
+ *
+ * \param in Input HLS stream
+ * \param out Output memory pointer, pointing at the first word of the row
+ * \param words Number of words to be written
+ */
+template<unsigned int DataWidth, unsigned int MaxWords, typename MemPtr>
+void Stream2Mem_Row(hls::stream<ap_uint<DataWidth> > & in, MemPtr out, const unsigned int words) {
+#pragma HLS INLINE off
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  for (unsigned int i = 0; i < words; i++) {
+#pragma HLS PIPELINE II=1
+#pragma HLS LOOP_TRIPCOUNT min=1 max=MaxWords
+    ap_uint<DataWidth> e = in.read();
+    out[i] = e;
+  }
+}
+
+/*!
+ * \brief Single contiguous row of a DMA transfer, as queued between address generation and data transfer
+ */
+struct DmaRow {
+  unsigned int offset;  //!< First word of the row
+  unsigned int words;   //!< Number of words, i.e. the burst length
+  bool         last;    //!< End of the transfer, the row itself carries no data
+};
+
+/*!
+ * \brief Address generator of the strided and scatter-gather DMA blocks
+ *
+ * Walks the descriptor list once per repetition, shifting the offsets of repetition
+ * rep by rep * repStride words, and queues one DmaRow per row followed by a last marker.
+ * Running as a process of its own, it computes the addresses of the next rows while
+ * the data of the current one is still being transferred.
+ *
+ * \tparam MaxDescriptors Maximum number of descriptors in the list
+ *
+ * \param descs Descriptor list
+ * \param numDescs Number of valid descriptors in the list
+ * \param repStride Distance, in words, between the regions of two repetitions
+ * \param numReps Number of times the descriptor list has to be processed
+ * \param rows Output row queue
+ */
+template<unsigned int MaxDescriptors>
+void DmaRows(DmaDescriptor const descs[MaxDescriptors], const unsigned int numDescs,
+        const unsigned int repStride, const unsigned int numReps, hls::stream<DmaRow> & rows) {
+  for (unsigned int rep = 0; rep < numReps; rep++) {
+    for (unsigned int d = 0; d < numDescs; d++) {
+#pragma HLS LOOP_TRIPCOUNT min=1 max=MaxDescriptors
+      DmaDescriptor const desc = descs[d];
+      unsigned int plane_base = desc.offset + rep * repStride;
+      for (unsigned int p = 0; p < desc.planes; p++) {
+        unsigned int row_base = plane_base;
+        for (unsigned int r = 0; r < desc.rows; r++) {
+#pragma HLS PIPELINE II=1
+          DmaRow row;
+          row.offset = row_base;
+          row.words = desc.words;
+          row.last = false;
+          rows.write(row);
+          row_base += desc.rowStride;
+        }
+        plane_base += desc.planeStride;
+      }
+    }
+  }
+  DmaRow end;
+  end.offset = 0;
+  end.words = 0;
+  end.last = true;
+  rows.write(end);
+}
+
+/*!
+ * \brief Data mover reading the rows of a row queue from memory, one burst per row
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory pointer and the output HLS stream
+ * \tparam MaxWords Maximum row length, used for latency estimation only
+ *
+ * \param in Input memory pointer (base of the row offsets)
+ * \param rows Input row queue, terminated by a last marker
+ * \param out Output HLS stream
+ */
+template<unsigned int DataWidth, unsigned int MaxWords, typename MemPtr>
+void Mem2Stream_Rows(MemPtr in, hls::stream<DmaRow> & rows, hls::stream<ap_uint<DataWidth> > & out) {
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  for (;;) {
+    DmaRow const row = rows.read();
+    if (row.last)  break;
+    Mem2Stream_Row<DataWidth, MaxWords>(&in[row.offset], out, row.words);
+  }
+}
+
+/*!
+ * \brief Data mover writing the rows of a row queue to memory, one burst per row
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory pointer and the input HLS stream
+ * \tparam MaxWords Maximum row length, used for latency estimation only
+ *
+ * \param in Input HLS stream
+ * \param rows Input row queue, terminated by a last marker
+ * \param out Output memory pointer (base of the row offsets)
+ */
+template<unsigned int DataWidth, unsigned int MaxWords, typename MemPtr>
+void Stream2Mem_Rows(hls::stream<ap_uint<DataWidth> > & in, hls::stream<DmaRow> & rows, MemPtr out) {
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  for (;;) {
+    DmaRow const row = rows.read();
+    if (row.last)  break;
+    Stream2Mem_Row<DataWidth, MaxWords>(in, &out[row.offset], row.words);
+  }
+}
+
+/*!
+ * \brief Scatter-gather DMA block streaming a list of memory regions multiple times
+ *
+ * For every repetition, the regions listed in descs are read in order, rows in
+ * plane-major, row-minor order, each as a separate burst. The descriptor offsets of
+ * repetition rep are shifted by rep * repStride words, so that a repStride of 0 rereads
+ * the same regions (e.g. weights) and a non-zero one walks through a batch.
+ *
+ * Address generation (DmaRows) and data transfer (Mem2Stream_Rows) are separate
+ * dataflow processes connected by a queue of RowQueueDepth rows, so the address of
+ * the next burst is available as soon as the current one is issued. For the bursts to
+ * overlap on the bus, the m_axi port of in needs
+ *  - num_read_outstanding >= 2 (4 to 16 hide the latency of DDR),
+ *  - max_read_burst_length >= MaxWords (at most 256 beats), and
+ *  - a bundle of its own, not shared with the write side.
+ * e.g. #pragma HLS INTERFACE m_axi port=in offset=slave bundle=gmem_rd max_read_burst_length=256 num_read_outstanding=4
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory pointer and the output HLS stream
+ * \tparam MaxDescriptors Maximum number of descriptors in the list
+ * \tparam MaxWords Maximum row length, used for latency estimation only
+ * \tparam RowQueueDepth Number of rows the address generator may run ahead
+ *
+ * \param in Input memory pointer
+ * \param out Output HLS stream
+ * \param descs Descriptor list
+ * \param numDescs Number of valid descriptors in the list
+ * \param repStride Distance, in words, between the regions of two repetitions
+ * \param numReps Number of times the descriptor list has to be processed
+ */
+template<unsigned int DataWidth, unsigned int MaxDescriptors, unsigned int MaxWords = 256,
+         unsigned int RowQueueDepth = 8, typename MemPtr>
+void Mem2Stream_ScatterGather(MemPtr in, hls::stream<ap_uint<DataWidth> > & out,
+        DmaDescriptor const descs[MaxDescriptors], const unsigned int numDescs,
+        const unsigned int repStride, const unsigned int numReps) {
+#pragma HLS DATAFLOW
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  FINN_DATAFLOW_REGION;
+  CASSERT_DATAFLOW(numDescs <= MaxDescriptors);
+  hls::stream<DmaRow> rows("Mem2Stream_ScatterGather.rows");
+#pragma HLS STREAM variable=rows depth=RowQueueDepth
+#ifdef FINN_DATAFLOW_THREADED
+  rows.set_depth(RowQueueDepth);
+#endif
+  FINN_DATAFLOW_STAGE(DmaRows<MaxDescriptors>(descs, numDescs, repStride, numReps, rows));
+  FINN_DATAFLOW_STAGE(Mem2Stream_Rows<DataWidth, MaxWords>(in, rows, out));
+}
+
+/*!
+ * \brief Scatter-gather DMA block writing HLS stream content to a list of memory regions multiple times
+ *
+ * Counterpart of Mem2Stream_ScatterGather: for every repetition, the stream content is
+ * scattered over the regions listed in descs, shifted by rep * repStride words. The
+ * m_axi port of out needs the write counterparts of the read settings, i.e.
+ * num_write_outstanding >= 2, max_write_burst_length >= MaxWords and a bundle of its own.
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory pointer and the input HLS stream
+ * \tparam MaxDescriptors Maximum number of descriptors in the list
+ * \tparam MaxWords Maximum row length, used for latency estimation only
+ * \tparam RowQueueDepth Number of rows the address generator may run ahead
+ *
+ * \param in Input HLS stream
+ * \param out Output memory pointer
+ * \param descs Descriptor list
+ * \param numDescs Number of valid descriptors in the list
+ * \param repStride Distance, in words, between the regions of two repetitions
+ * \param numReps Number of times the descriptor list has to be processed
+ */
+template<unsigned int DataWidth, unsigned int MaxDescriptors, unsigned int MaxWords = 256,
+         unsigned int RowQueueDepth = 8, typename MemPtr>
+void Stream2Mem_ScatterGather(hls::stream<ap_uint<DataWidth> > & in, MemPtr out,
+        DmaDescriptor const descs[MaxDescriptors], const unsigned int numDescs,
+        const unsigned int repStride, const unsigned int numReps) {
+#pragma HLS DATAFLOW
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  FINN_DATAFLOW_REGION;
+  CASSERT_DATAFLOW(numDescs <= MaxDescriptors);
+  hls::stream<DmaRow> rows("Stream2Mem_ScatterGather.rows");
+#pragma HLS STREAM variable=rows depth=RowQueueDepth
+#ifdef FINN_DATAFLOW_THREADED
+  rows.set_depth(RowQueueDepth);
+#endif
+  FINN_DATAFLOW_STAGE(DmaRows<MaxDescriptors>(descs, numDescs, repStride, numReps, rows));
+  FINN_DATAFLOW_STAGE(Stream2Mem_Rows<DataWidth, MaxWords>(in, rows, out));
+}
+
+/*!
+ * \brief DMA block streaming a strided 2D/3D memory region described by a DmaDescriptor
+ *
+ * Single-region, single-repetition Mem2Stream_ScatterGather, with the same m_axi
+ * requirements for overlapping row bursts.
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory pointer and the output HLS stream
+ * \tparam MaxWords Maximum row length, used for latency estimation only
+ *
+ * \param in Input memory pointer (base of the descriptor offsets)
+ * \param out Output HLS stream
+ * \param desc Descriptor of the region to be read
+ */
+template<unsigned int DataWidth, unsigned int MaxWords = 256, typename MemPtr>
+void Mem2Stream_Strided(MemPtr in, hls::stream<ap_uint<DataWidth> > & out, DmaDescriptor const & desc) {
+#pragma HLS INLINE
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  Mem2Stream_ScatterGather<DataWidth, 1, MaxWords>(in, out, &desc, 1, 0, 1);
+}
+
+/*!
+ * \brief DMA block writing HLS stream content to a strided 2D/3D memory region described by a DmaDescriptor
+ *
+ * Single-region, single-repetition Stream2Mem_ScatterGather.
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory pointer and the input HLS stream
+ * \tparam MaxWords Maximum row length, used for latency estimation only
+ *
+ * \param in Input HLS stream
+ * \param out Output memory pointer (base of the descriptor offsets)
+ * \param desc Descriptor of the region to be written
+ */
+template<unsigned int DataWidth, unsigned int MaxWords = 256, typename MemPtr>
+void Stream2Mem_Strided(hls::stream<ap_uint<DataWidth> > & in, MemPtr out, DmaDescriptor const & desc) {
+#pragma HLS INLINE
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  Stream2Mem_ScatterGather<DataWidth, 1, MaxWords>(in, out, &desc, 1, 0, 1);
+}
+
+/*!
+ * \brief Frame descriptor generator for contiguous batches
+ *
+ * Emits one descriptor per frame, frame rep covering the numBytes bytes starting at
+ * rep * numBytes. Feeds the frame-descriptor queue of the double-buffered batch DMA blocks.
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory words
+ * \tparam numBytes Number of bytes per frame
+ *
+ * \param frames Output frame-descriptor queue
+ * \param numReps Number of frames
+ */
+template<unsigned int DataWidth, unsigned int numBytes>
+void FrameDescriptors(hls::stream<DmaDescriptor> & frames, const unsigned int numReps) {
+  const unsigned int indsPerRep = numBytes / (DataWidth / 8);
+  for (unsigned int rep = 0; rep < numReps; rep++) {
+#pragma HLS PIPELINE II=1
+    DmaDescriptor desc;
+    desc.offset = rep * indsPerRep;
+    desc.words = indsPerRep;
+    desc.rows = 1;
+    desc.rowStride = 0;
+    desc.planes = 1;
+    desc.planeStride = 0;
+    frames.write(desc);
+  }
+}
+
+/*!
+ * \brief Address generator of the double-buffered DMA blocks
+ *
+ * Consumes numFrames descriptors from the frame-descriptor queue and queues every row
+ * of them as chunks of at most ChunkWords words, followed by a last marker.
+ *
+ * \tparam ChunkWords Maximum number of words per chunk
+ *
+ * \param frames Input frame-descriptor queue
+ * \param numFrames Number of descriptors to be consumed
+ * \param chunks Output chunk queue
+ */
+template<unsigned int ChunkWords>
+void DmaChunks(hls::stream<DmaDescriptor> & frames, const unsigned int numFrames, hls::stream<DmaRow> & chunks) {
+  for (unsigned int f = 0; f < numFrames; f++) {
+    DmaDescriptor const desc = frames.read();
+    unsigned int plane_base = desc.offset;
+    for (unsigned int p = 0; p < desc.planes; p++) {
+      unsigned int row_base = plane_base;
+      for (unsigned int r = 0; r < desc.rows; r++) {
+        for (unsigned int done = 0; done < desc.words; done += ChunkWords) {
+#pragma HLS PIPELINE II=1
+          unsigned int const left = desc.words - done;
+          DmaRow chunk;
+          chunk.offset = row_base + done;
+          chunk.words = (left < ChunkWords)? left : ChunkWords;
+          chunk.last = false;
+          chunks.write(chunk);
+        }
+        row_base += desc.rowStride;
+      }
+      plane_base += desc.planeStride;
+    }
+  }
+  DmaRow end;
+  end.offset = 0;
+  end.words = 0;
+  end.last = true;
+  chunks.write(end);
+}
+
+/*!
+ * \brief Burst stage of the double-buffered DMA blocks: reads a chunk from memory into an on-chip buffer
+ */
+template<unsigned int DataWidth, unsigned int ChunkWords, typename MemPtr>
+void Mem2Buffer_Chunk(MemPtr in, ap_uint<DataWidth> buf[ChunkWords], const unsigned int words) {
+#pragma HLS INLINE off
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  for (unsigned int i = 0; i < words; i++) {
+#pragma HLS PIPELINE II=1
+#pragma HLS LOOP_TRIPCOUNT min=1 max=ChunkWords
+    buf[i] = in[i];
+  }
+}
+
+/*!
+ * \brief Stream stage of the double-buffered DMA blocks: streams a chunk out of an on-chip buffer
+ */
+template<unsigned int DataWidth, unsigned int ChunkWords>
+void Buffer2Stream_Chunk(ap_uint<DataWidth> const buf[ChunkWords], hls::stream<ap_uint<DataWidth> > & out, const unsigned int words) {
+#pragma HLS INLINE off
+  for (unsigned int i = 0; i < words; i++) {
+#pragma HLS PIPELINE II=1
+#pragma HLS LOOP_TRIPCOUNT min=1 max=ChunkWords
+    out.write(buf[i]);
+  }
+}
+
+/*!
+ * \brief Stream stage of the double-buffered DMA blocks: collects a chunk of a stream in an on-chip buffer
+ */
+template<unsigned int DataWidth, unsigned int ChunkWords>
+void Stream2Buffer_Chunk(hls::stream<ap_uint<DataWidth> > & in, ap_uint<DataWidth> buf[ChunkWords], const unsigned int words) {
+#pragma HLS INLINE off
+  for (unsigned int i = 0; i < words; i++) {
+#pragma HLS PIPELINE II=1
+#pragma HLS LOOP_TRIPCOUNT min=1 max=ChunkWords
+    buf[i] = in.read();
+  }
+}
+
+/*!
+ * \brief Burst stage of the double-buffered DMA blocks: writes a chunk from an on-chip buffer to memory
+ */
+template<unsigned int DataWidth, unsigned int ChunkWords, typename MemPtr>
+void Buffer2Mem_Chunk(ap_uint<DataWidth> const buf[ChunkWords], MemPtr out, const unsigned int words) {
+#pragma HLS INLINE off
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  for (unsigned int i = 0; i < words; i++) {
+#pragma HLS PIPELINE II=1
+#pragma HLS LOOP_TRIPCOUNT min=1 max=ChunkWords
+    out[i] = buf[i];
+  }
+}
+
+/*!
+ * \brief Data mover of Mem2Stream_Chunked, double-buffering the chunks of a chunk queue
+ *
+ * While the burst stage reads the next chunk into one on-chip buffer (ping or pong), the
+ * stream stage sends the previous chunk out of the other. The two stages share no data
+ * within an iteration, so HLS schedules them in parallel.
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory pointer and the output HLS stream
+ * \tparam ChunkWords Maximum number of words per chunk, i.e. per burst and per buffer
+ *
+ * \param in Input memory pointer (base of the chunk offsets)
+ * \param chunks Input chunk queue, terminated by a last marker
+ * \param out Output HLS stream
+ */
+template<unsigned int DataWidth, unsigned int ChunkWords, typename MemPtr>
+void Mem2Stream_Chunks(MemPtr in, hls::stream<DmaRow> & chunks, hls::stream<ap_uint<DataWidth> > & out) {
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  ap_uint<DataWidth> ping[ChunkWords];
+  ap_uint<DataWidth> pong[ChunkWords];
+  DmaRow pending;  // chunk in the buffers, streamed out in this iteration
+  pending.offset = 0;
+  pending.words = 0;
+  pending.last = false;
+  for (unsigned int c = 0; !pending.last; c++) {
+    DmaRow const next = chunks.read();
+    if (c % 2 == 0) {
+      Mem2Buffer_Chunk<DataWidth, ChunkWords>(&in[next.offset], ping, next.words);
+      Buffer2Stream_Chunk<DataWidth, ChunkWords>(pong, out, pending.words);
+    }
+    else {
+      Mem2Buffer_Chunk<DataWidth, ChunkWords>(&in[next.offset], pong, next.words);
+      Buffer2Stream_Chunk<DataWidth, ChunkWords>(ping, out, pending.words);
+    }
+    pending = next;
+  }
+}
+
+/*!
+ * \brief Data mover of Stream2Mem_Chunked, double-buffering the chunks of a chunk queue
+ *
+ * While the stream stage collects the next chunk in one on-chip buffer, the burst stage
+ * writes the previous chunk from the other buffer to memory.
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory pointer and the input HLS stream
+ * \tparam ChunkWords Maximum number of words per chunk, i.e. per burst and per buffer
+ *
+ * \param in Input HLS stream
+ * \param chunks Input chunk queue, terminated by a last marker
+ * \param out Output memory pointer (base of the chunk offsets)
+ */
+template<unsigned int DataWidth, unsigned int ChunkWords, typename MemPtr>
+void Stream2Mem_Chunks(hls::stream<ap_uint<DataWidth> > & in, hls::stream<DmaRow> & chunks, MemPtr out) {
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  ap_uint<DataWidth> ping[ChunkWords];
+  ap_uint<DataWidth> pong[ChunkWords];
+  DmaRow pending;  // chunk in the buffers, written back in this iteration
+  pending.offset = 0;
+  pending.words = 0;
+  pending.last = false;
+  for (unsigned int c = 0; !pending.last; c++) {
+    DmaRow const next = chunks.read();
+    if (c % 2 == 0) {
+      Stream2Buffer_Chunk<DataWidth, ChunkWords>(in, ping, next.words);
+      Buffer2Mem_Chunk<DataWidth, ChunkWords>(pong, &out[pending.offset], pending.words);
+    }
+    else {
+      Stream2Buffer_Chunk<DataWidth, ChunkWords>(in, pong, next.words);
+      Buffer2Mem_Chunk<DataWidth, ChunkWords>(ping, &out[pending.offset], pending.words);
+    }
+    pending = next;
+  }
+}
+
+/*!
+ * \brief Descriptor-queue driven, double-buffered DMA block reading memory in bursts of bounded length
+ *
+ * Frame descriptors are consumed from a queue, so that the next frame is fetched as
+ * soon as its descriptor is available instead of waiting for the previous frame to be
+ * consumed. Every row of a descriptor is split into chunks of at most ChunkWords words,
+ * which are moved through two on-chip buffers, so that a new burst is issued every chunk
+ * regardless of the downstream consumption. The memory pointer should be mapped to a
+ * dedicated read bundle, with max_read_burst_length equal to ChunkWords, e.g.
+ * #pragma HLS INTERFACE m_axi port=in offset=slave bundle=gmem_rd max_read_burst_length=64
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory pointer and the output HLS stream
+ * \tparam ChunkWords Maximum number of words per chunk, i.e. per burst and per buffer
+ *
+ * \param in Input memory pointer (base of the descriptor offsets)
+ * \param frames Input frame-descriptor queue
+ * \param out Output HLS stream
+ * \param numFrames Number of descriptors to be consumed
+ */
+template<unsigned int DataWidth, unsigned int ChunkWords, typename MemPtr>
+void Mem2Stream_Chunked(MemPtr in, hls::stream<DmaDescriptor> & frames,
+        hls::stream<ap_uint<DataWidth> > & out, const unsigned int numFrames) {
+#pragma HLS DATAFLOW
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  FINN_DATAFLOW_REGION;
+  hls::stream<DmaRow> chunks("Mem2Stream_Chunked.chunks");
+  FINN_DATAFLOW_STAGE(DmaChunks<ChunkWords>(frames, numFrames, chunks));
+  FINN_DATAFLOW_STAGE(Mem2Stream_Chunks<DataWidth, ChunkWords>(in, chunks, out));
+}
+
+/*!
+ * \brief Descriptor-queue driven, double-buffered DMA block writing memory in bursts of bounded length
+ *
+ * Counterpart of Mem2Stream_Chunked: while a chunk of the stream is collected in one
+ * on-chip buffer, the previous one is written from the other buffer to memory in a
+ * single burst. The memory pointer should be mapped to a dedicated write bundle,
+ * separate from the read one, e.g.
+ * #pragma HLS INTERFACE m_axi port=out offset=slave bundle=gmem_wr max_write_burst_length=64
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory pointer and the input HLS stream
+ * \tparam ChunkWords Maximum number of words per chunk, i.e. per burst and per buffer
+ *
+ * \param in Input HLS stream
+ * \param frames Input frame-descriptor queue
+ * \param out Output memory pointer (base of the descriptor offsets)
+ * \param numFrames Number of descriptors to be consumed
+ */
+template<unsigned int DataWidth, unsigned int ChunkWords, typename MemPtr>
+void Stream2Mem_Chunked(hls::stream<ap_uint<DataWidth> > & in, hls::stream<DmaDescriptor> & frames,
+        MemPtr out, const unsigned int numFrames) {
+#pragma HLS DATAFLOW
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  FINN_DATAFLOW_REGION;
+  hls::stream<DmaRow> chunks("Stream2Mem_Chunked.chunks");
+  FINN_DATAFLOW_STAGE(DmaChunks<ChunkWords>(frames, numFrames, chunks));
+  FINN_DATAFLOW_STAGE(Stream2Mem_Chunks<DataWidth, ChunkWords>(in, chunks, out));
+}
+
+/*!
+ * \brief Double-buffered DMA block streaming a batch of frames from AXI4 memory
+ *
+ * Drop-in replacement of Mem2Stream_Batch for a batch stored contiguously: FrameDescriptors
+ * queues a descriptor per frame for Mem2Stream_Chunked.
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory pointer and the output HLS stream
+ * \tparam numBytes Number of bytes per frame
+ * \tparam ChunkWords Maximum number of words per chunk, i.e. per burst and per buffer
+ *
+ * \param in Input memory pointer
+ * \param out Output HLS stream
+ * \param numReps Number of frames
+ */
+template<unsigned int DataWidth, unsigned int numBytes, unsigned int ChunkWords = 64, typename MemPtr>
+void Mem2Stream_Batch_DoubleBuffered(MemPtr in, hls::stream<ap_uint<DataWidth> > & out, const unsigned int numReps) {
+#pragma HLS DATAFLOW
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  CASSERT_DATAFLOW(DataWidth % 8 == 0);
+  FINN_DATAFLOW_REGION;
+  hls::stream<DmaDescriptor> frames("Mem2Stream_Batch_DoubleBuffered.frames");
+  FINN_DATAFLOW_STAGE(FrameDescriptors<DataWidth, numBytes>(frames, numReps));
+  FINN_DATAFLOW_STAGE(Mem2Stream_Chunked<DataWidth, ChunkWords>(in, frames, out, numReps));
+}
+
+/*!
+ * \brief Double-buffered DMA block writing a batch of frames to AXI4 memory
+ *
+ * Drop-in replacement of Stream2Mem_Batch for a batch stored contiguously: FrameDescriptors
+ * queues a descriptor per frame for Stream2Mem_Chunked.
+ *
+ * \tparam DataWidth Width, in number of bits, of the AXI4 memory pointer and the input HLS stream
+ * \tparam numBytes Number of bytes per frame
+ * \tparam ChunkWords Maximum number of words per chunk, i.e. per burst and per buffer
+ *
+ * \param in Input HLS stream
+ * \param out Output memory pointer
+ * \param numReps Number of frames
+ */
+template<unsigned int DataWidth, unsigned int numBytes, unsigned int ChunkWords = 64, typename MemPtr>
+void Stream2Mem_Batch_DoubleBuffered(hls::stream<ap_uint<DataWidth> > & in, MemPtr out, const unsigned int numReps) {
+#pragma HLS DATAFLOW
+  DMA_CHECK_MEMPTR(MemPtr, DataWidth);
+  CASSERT_DATAFLOW(DataWidth % 8 == 0);
+  FINN_DATAFLOW_REGION;
+  hls::stream<DmaDescriptor> frames("Stream2Mem_Batch_DoubleBuffered.frames");
+  FINN_DATAFLOW_STAGE(FrameDescriptors<DataWidth, numBytes>(frames, numReps));
+  FINN_DATAFLOW_STAGE(Stream2Mem_Chunked<DataWidth, ChunkWords>(in, frames, out, numReps));
+}
+
 #endif
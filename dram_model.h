@@ -0,0 +1,373 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  \file dram_model.h
+ *
+ *  DRAM timing model of external memory for C simulation.
+ *
+ *  A DramModel estimates the memory clock cycles a sequence of accesses
+ *  takes on a DDR channel with per-bank row buffers. Memory regions are
+ *  wrapped in ModeledMemory, whose ModeledPtr stands in for the raw memory
+ *  pointer of the DMA blocks in dma.h (including the weight streaming of
+ *  Mem2Stream_Batch_external_wmem) and of the server_data of FPGAPathORAM2.
+ *  Running the same kernel over different layouts or address mappings then
+ *  ranks them without hardware:
+ *
+ *    finn::dram::DramModel  ddr;
+ *    finn::dram::ModeledMemory<ap_uint<64>>  mem(ddr, words);
+ *    Mem2Stream_Batch<64, numBytes>(mem.ptr(), out, numReps);
+ *    ddr.stats().print(std::cout);
+ *
+ *  The model follows the accesses in program order:
+ *   - consecutive accesses to the same burst in the same direction form a
+ *     single burst of burst_length beats on the bus_bytes wide data bus,
+ *   - a burst to the open row of its bank streams at the bus rate,
+ *   - a burst to a closed bank first activates the row (tRCD), a burst to
+ *     another row of an open bank also precharges the bank first (tRP),
+ *   - the CAS latency (tCL) is paid after every activation and whenever the
+ *     transfer direction changes, together with the bus turnaround.
+ *  Activations of other banks overlap with the transfer of the previous burst,
+ *  so that bank-interleaved address mappings hide part of the row misses.
+ *  Refresh, bank groups and reordering by the memory controller are not
+ *  modelled, and the model is meant for the default (sequential) C simulation.
+ *
+ *****************************************************************************/
+
+#ifndef DRAM_MODEL_H
+#define DRAM_MODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include <ap_int.h>
+
+namespace finn {
+namespace dram {
+
+typedef unsigned long long  cycles_t;
+
+/** Mapping of byte addresses onto DRAM rows, banks and columns, from the most significant bits down. */
+enum class AddressMapping {
+  RowBankColumn,  //!< Consecutive addresses fill a whole row before moving to the next bank
+  RowColumnBank   //!< Consecutive bursts are interleaved across the banks
+};
+
+/**
+ * \brief   Geometry and timing of a DDR channel
+ *
+ * The defaults describe a 64-bit DDR4-2400 channel (x8 devices, 8 KB pages),
+ * timings are given in memory clock cycles.
+ */
+struct DramConfig {
+  unsigned  bus_bytes;     //!< Width of the data bus in bytes
+  unsigned  burst_length;  //!< Beats per burst, two per clock cycle
+  unsigned  banks;         //!< Number of banks
+  unsigned  row_bytes;     //!< Bytes per row (page) of a bank
+  unsigned  tCL;           //!< CAS latency
+  unsigned  tRCD;          //!< Activate to column command delay
+  unsigned  tRP;           //!< Precharge time
+  unsigned  tTurnaround;   //!< Bus turnaround between reads and writes
+  double    clock_mhz;     //!< Memory clock frequency, for the reported times
+  AddressMapping  mapping;
+
+  DramConfig()
+    : bus_bytes(8), burst_length(8), banks(16), row_bytes(8192),
+      tCL(17), tRCD(17), tRP(17), tTurnaround(8), clock_mhz(1200), mapping(AddressMapping::RowBankColumn) {}
+
+  unsigned burst_bytes() const { return  bus_bytes * burst_length; }
+  unsigned burst_cycles() const { return  burst_length / 2; }
+};
+
+/**
+ * \brief   Access statistics of a DramModel
+ *
+ * Differences of two snapshots give the cost of the accesses in between,
+ * e.g. of a single ORAM access.
+ */
+struct DramStats {
+  unsigned long long  bytes_read;
+  unsigned long long  bytes_written;
+  unsigned long long  bursts;
+  unsigned long long  row_hits;       //!< Bursts to the open row of their bank
+  unsigned long long  row_misses;     //!< Bursts to a bank without an open row
+  unsigned long long  row_conflicts;  //!< Bursts to a bank with another row open
+  unsigned long long  turnarounds;    //!< Changes of the transfer direction
+  cycles_t            cycles;         //!< Memory clock cycles until the last burst completed
+  double              clock_mhz;
+
+  DramStats()
+    : bytes_read(0), bytes_written(0), bursts(0), row_hits(0), row_misses(0),
+      row_conflicts(0), turnarounds(0), cycles(0), clock_mhz(0) {}
+
+  DramStats operator-(DramStats const &o) const {
+    DramStats  d(*this);
+    d.bytes_read    -= o.bytes_read;
+    d.bytes_written -= o.bytes_written;
+    d.bursts        -= o.bursts;
+    d.row_hits      -= o.row_hits;
+    d.row_misses    -= o.row_misses;
+    d.row_conflicts -= o.row_conflicts;
+    d.turnarounds   -= o.turnarounds;
+    d.cycles        -= o.cycles;
+    return  d;
+  }
+
+  double row_hit_rate() const {
+    return  bursts? double(row_hits) / bursts : 0.0;
+  }
+  /** Achieved share of the peak bandwidth of the channel. */
+  double bus_utilization(unsigned const  burst_cycles) const {
+    return  cycles? double(bursts * burst_cycles) / cycles : 0.0;
+  }
+  double microseconds() const {
+    return  clock_mhz > 0? cycles / clock_mhz : 0.0;
+  }
+
+  void print(std::ostream &os) const {
+    os << "DRAM: " << cycles << " cycles (" << microseconds() << " us), "
+       << bytes_read << " B read, " << bytes_written << " B written, "
+       << bursts << " bursts, row hits/misses/conflicts " << row_hits << '/' << row_misses << '/' << row_conflicts
+       << ", " << turnarounds << " turnarounds" << std::endl;
+  }
+};
+
+/**
+ * \brief   Timing model of a single DDR channel
+ */
+class DramModel {
+  static unsigned long long const  CLOSED = ~0ull;
+
+  DramConfig  m_cfg;
+  DramStats   m_stats;
+
+  std::vector<unsigned long long>  m_open_row;   // per bank
+  std::vector<cycles_t>            m_bank_idle;  // per bank, end of its last transfer
+  unsigned long long  m_burst;       // burst address of the last burst
+  bool                m_write;       // direction of the last burst
+  bool                m_active;      // whether there was a burst yet
+  cycles_t            m_last_start;  // data start of the last burst
+
+ public:
+  DramModel(DramConfig const &cfg = DramConfig()) : m_cfg(cfg) {
+    reset();
+  }
+
+ public:
+  DramConfig const& config() const { return  m_cfg; }
+  DramStats const& stats() const { return  m_stats; }
+
+  /** Closes all rows and clears the statistics. */
+  void reset() {
+    m_stats = DramStats();
+    m_stats.clock_mhz = m_cfg.clock_mhz;
+    m_open_row.assign(m_cfg.banks, (unsigned long long)CLOSED);
+    m_bank_idle.assign(m_cfg.banks, 0);
+    m_burst = 0;
+    m_write = false;
+    m_active = false;
+    m_last_start = 0;
+  }
+
+  /** Records an access of bytes bytes at the byte address addr. */
+  void access(unsigned long long const  addr, unsigned const  bytes, bool const  write) {
+    if(write)  m_stats.bytes_written += bytes;
+    else       m_stats.bytes_read += bytes;
+    unsigned long long const  first = addr / m_cfg.burst_bytes();
+    unsigned long long const  last = (addr + bytes - 1) / m_cfg.burst_bytes();
+    for(unsigned long long  b = first; b <= last; b++)  burst(b, write);
+  }
+
+ private:
+  void burst(unsigned long long const  b, bool const  write) {
+    // Continuation of the current burst
+    if(m_active && (b == m_burst) && (write == m_write))  return;
+
+    unsigned long long const  row_bursts = m_cfg.row_bytes / m_cfg.burst_bytes();
+    unsigned const  bank = m_cfg.mapping == AddressMapping::RowColumnBank?
+      unsigned(b % m_cfg.banks) : unsigned((b / row_bursts) % m_cfg.banks);
+    unsigned long long const  row = b / (row_bursts * m_cfg.banks);
+    bool const  turnaround = m_active && (write != m_write);
+
+    // The row is prepared once the bank is idle and the request is known, i.e. the previous burst started
+    cycles_t  ready = m_bank_idle[bank] > m_last_start? m_bank_idle[bank] : m_last_start;
+    if(m_open_row[bank] == row) {
+      m_stats.row_hits++;
+      if(turnaround || !m_active)  ready += m_cfg.tCL;
+    }
+    else {
+      if(m_open_row[bank] == CLOSED) {
+        m_stats.row_misses++;
+      }
+      else {
+        m_stats.row_conflicts++;
+        ready += m_cfg.tRP;
+      }
+      ready += m_cfg.tRCD + m_cfg.tCL;
+      m_open_row[bank] = row;
+    }
+
+    cycles_t  bus = m_stats.cycles;
+    if(turnaround) {
+      m_stats.turnarounds++;
+      bus += m_cfg.tTurnaround;
+    }
+    cycles_t const  start = ready > bus? ready : bus;
+    m_stats.cycles = start + m_cfg.burst_cycles();
+    m_stats.bursts++;
+    m_bank_idle[bank] = m_stats.cycles;
+    m_last_start = start;
+
+    m_burst = b;
+    m_write = write;
+    m_active = true;
+  }
+};
+
+/** Bytes occupied in memory by an element of type T. */
+template<typename T>
+struct element_bytes {
+  static unsigned const  value = sizeof(T);
+};
+template<int W>
+struct element_bytes<ap_uint<W> > {
+  static unsigned const  value = (W + 7) / 8;
+};
+template<int W>
+struct element_bytes<ap_int<W> > {
+  static unsigned const  value = (W + 7) / 8;
+};
+
+/**
+ * \brief   Pointer into a ModeledMemory recording its accesses in a DramModel
+ *
+ * Supports the pointer arithmetic, dereferencing and indexing used on memory
+ * pointers. Elements are accessed through a proxy that records a read when
+ * converted to T and a write when assigned, and whose address is again a
+ * ModeledPtr, so that &p[i] works as for raw pointers.
+ */
+template<typename T>
+class ModeledPtr {
+  T          *m_ptr;
+  T          *m_base;
+  DramModel  *m_model;
+  unsigned long long  m_base_addr;
+
+ public:
+  class Ref {
+    ModeledPtr const  m_p;
+   public:
+    Ref(ModeledPtr const &p) : m_p(p) {}
+    operator T() const {
+      m_p.record(false);
+      return  *m_p.m_ptr;
+    }
+    Ref& operator=(T const &v) {
+      m_p.record(true);
+      *m_p.m_ptr = v;
+      return *this;
+    }
+    Ref& operator=(Ref const &o) {
+      return  *this = T(o);
+    }
+    ModeledPtr operator&() const {
+      return  m_p;
+    }
+  };
+
+ public:
+  ModeledPtr() : m_ptr(nullptr), m_base(nullptr), m_model(nullptr), m_base_addr(0) {}
+  ModeledPtr(T *base, DramModel &model, unsigned long long const  base_addr)
+    : m_ptr(base), m_base(base), m_model(&model), m_base_addr(base_addr) {}
+
+ public:
+  Ref operator*() const { return  Ref(*this); }
+  Ref operator[](std::ptrdiff_t const  i) const { return  Ref(*this + i); }
+
+  ModeledPtr operator+(std::ptrdiff_t const  i) const {
+    ModeledPtr  p(*this);
+    p.m_ptr += i;
+    return  p;
+  }
+  ModeledPtr operator-(std::ptrdiff_t const  i) const { return  *this + (-i); }
+  std::ptrdiff_t operator-(ModeledPtr const &o) const { return  m_ptr - o.m_ptr; }
+  ModeledPtr& operator+=(std::ptrdiff_t const  i) { m_ptr += i; return *this; }
+  ModeledPtr& operator-=(std::ptrdiff_t const  i) { m_ptr -= i; return *this; }
+  ModeledPtr& operator++() { ++m_ptr; return *this; }
+  ModeledPtr operator++(int) { ModeledPtr const  p(*this); ++m_ptr; return  p; }
+
+  bool operator==(ModeledPtr const &o) const { return  m_ptr == o.m_ptr; }
+  bool operator!=(ModeledPtr const &o) const { return  m_ptr != o.m_ptr; }
+
+  /** Byte address of the pointed element in the modelled memory. */
+  unsigned long long address() const {
+    return  m_base_addr + (unsigned long long)(m_ptr - m_base) * element_bytes<T>::value;
+  }
+
+ private:
+  void record(bool const  write) const {
+    m_model->access(address(), element_bytes<T>::value, write);
+  }
+};
+
+/**
+ * \brief   Memory region of count elements at byte address base_addr of a DramModel
+ *
+ * Several regions, e.g. weights and activations, may share one model to
+ * account for their interference.
+ */
+template<typename T>
+class ModeledMemory {
+  std::vector<T>      m_data;
+  DramModel          &m_model;
+  unsigned long long  m_base_addr;
+
+ public:
+  ModeledMemory(DramModel &model, std::size_t const  count, unsigned long long const  base_addr = 0)
+    : m_data(count), m_model(model), m_base_addr(base_addr) {}
+
+ public:
+  /** Pointer to the first element, accesses through it are modelled. */
+  ModeledPtr<T> ptr() { return  ModeledPtr<T>(m_data.data(), m_model, m_base_addr); }
+  /** Raw storage, e.g. to fill in inputs or check outputs without affecting the model. */
+  T* data() { return  m_data.data(); }
+  std::size_t size() const { return  m_data.size(); }
+  DramModel& model() { return  m_model; }
+};
+
+} // namespace dram
+} // namespace finn
+
+#endif
@@ -51,6 +51,7 @@
 #include <ap_int.h>
 #include <hls_stream.h>
 
+#include "dataflow.h"
 #include "streamtools.h"
 #include "mvau.hpp"
 
@@ -98,16 +99,17 @@ void StreamingFCLayer_Batch(hls::stream<ap_uint<InStreamW>>  &in,
 			    unsigned const   reps,
 				R const &r) {
 #pragma HLS INLINE
+  FINN_DATAFLOW_REGION;
   unsigned const  InpPerImage = MatrixW / InStreamW * TSrcI::width;
   unsigned const  OutPerImage = MatrixH / PE;
 
   WidthAdjustedInputStream <InStreamW, SIMD*TSrcI::width, InpPerImage>  wa_in (in,  reps);
   WidthAdjustedOutputStream<PE*TDstI::width,  OutStreamW, OutPerImage>  wa_out(out, reps);
 
-  Matrix_Vector_Activate_Batch<MatrixW, MatrixH, SIMD, PE, TSrcI, TDstI, TWeightI>
+  FINN_DATAFLOW_STAGE(Matrix_Vector_Activate_Batch<MatrixW, MatrixH, SIMD, PE, TSrcI, TDstI, TWeightI>
     (static_cast<hls::stream<ap_uint<SIMD*TSrcI::width>>&>(wa_in),
      static_cast<hls::stream<ap_uint<PE*TDstI::width>>&>  (wa_out),
-     weights, activation, reps, r);
+     weights, activation, reps, r));
 }
 
 
@@ -0,0 +1,393 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  \file instrumentation.h
+ *
+ *  Run-time measurement of the frame latency and throughput of a network
+ *  top, and of the stalls of its streams.
+ *
+ *  InputMonitor_Batch and OutputMonitor_Batch wrap the input and output
+ *  streams of a network, StreamMonitor_Batch can be placed on any stream in
+ *  between (Network_Batch_Instrumented of network.h does all of this). The
+ *  input monitor timestamps the first word of every frame, the output
+ *  monitor the last one and accumulates the latencies into a histogram,
+ *  from which the host derives percentiles (see InstrumentReport). The
+ *  counters of all monitors travel down a daisy chain of report streams to
+ *  the output monitor, which writes them to a stats array to be mapped to
+ *  AXI-lite, e.g.
+ *
+ *    #pragma HLS INTERFACE s_axilite port=stats bundle=control
+ *
+ *  In hardware, the monitors poll their streams in II=1 loops and count
+ *  loop iterations, so timestamps and stalls are in clock cycles. As all
+ *  monitors start together with the dataflow region, their counters share
+ *  the time base. Latencies are only recorded for up to TSDepth frames in
+ *  flight; more throttle the input, without counting as input stalls. The stats array is only written once
+ *  the last frame of the batch has left, so it holds the values of the
+ *  previous batch while one runs; split long runs into several batches to
+ *  observe them.
+ *  In C simulation, the timestamps are steady_clock nanoseconds, stalls count
+ *  the blocking accesses of the threaded simulation (see dataflow.h), and
+ *  every frame is additionally appended to the side stream InstrumentTrace().
+ *
+ *****************************************************************************/
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <ap_int.h>
+#include <hls_stream.h>
+
+#include "dataflow.h"
+#include "streamtools.h"
+
+#ifndef __SYNTHESIS__
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#endif
+
+/**
+ * \brief   Layout of the stats array written by OutputMonitor_Batch
+ *
+ * 64-bit values take two words, low word first. The monitors of the
+ * internal streams follow the fixed fields in pipeline order with two
+ * counters each, the latency histogram comes last; its bin i counts the
+ * latencies in [i << BinShift, (i+1) << BinShift), the last bin everything
+ * above.
+ *
+ * \tparam NumMonitors  Number of StreamMonitor_Batch in the report chain
+ * \tparam NumBins      Number of bins of the latency histogram
+ */
+template<unsigned NumMonitors, unsigned NumBins>
+struct InstrumentLayout {
+  static unsigned const  FRAMES     = 0;  // frames completed
+  static unsigned const  LAT_MIN    = 1;  // minimum frame latency
+  static unsigned const  LAT_MAX    = 2;  // maximum frame latency
+  static unsigned const  LAT_SUM    = 3;  // sum of the frame latencies (64 bit)
+  static unsigned const  SPAN       = 5;  // first input word to last output word (64 bit)
+  static unsigned const  IN_STALL   = 7;  // cycles the network did not accept available input
+  static unsigned const  OUT_STARVE = 8;  // cycles the output waited for the network
+  static unsigned const  MONITORS   = 9;  // per monitor: stalled on output, starved on input
+  static unsigned const  HIST       = MONITORS + 2 * NumMonitors;
+  static unsigned const  SIZE       = HIST + NumBins;
+  static unsigned const  REPORTS    = 1 + 2 * NumMonitors;  // words on the report chain
+};
+
+/**
+ * \brief   Instrumentation parameters of Network_Batch_Instrumented
+ *
+ * \tparam NumBins   Number of bins of the latency histogram
+ * \tparam BinShift  log2 of the width of a histogram bin
+ * \tparam TSDepth   Depth of the timestamp stream, i.e. number of frames in flight
+ */
+template<unsigned NumBins_ = 64, unsigned BinShift_ = 8, unsigned TSDepth_ = 32>
+struct InstrumentCfg {
+  static unsigned const  NumBins = NumBins_;
+  static unsigned const  BinShift = BinShift_;
+  static unsigned const  TSDepth = TSDepth_;
+};
+
+#ifndef __SYNTHESIS__
+/** Per-frame record of the C simulation side stream. */
+struct FrameTiming {
+  unsigned long long  frame;
+  unsigned long long  first_in;
+  unsigned long long  last_out;
+};
+
+/** Side stream of the frame timings of the C simulation, in nanoseconds. */
+inline hls::stream<FrameTiming>& InstrumentTrace() {
+#ifdef FINN_DATAFLOW_THREADED
+  // unbounded, even if first used within a region
+  finn::dataflow::Region::Detach const  detach;
+#endif
+  static hls::stream<FrameTiming>  trace("InstrumentTrace");
+  return  trace;
+}
+
+/** Timestamp of the C simulation. */
+inline ap_uint<64> instrument_now() {
+  static std::chrono::steady_clock::time_point const  epoch = std::chrono::steady_clock::now();
+  return  ap_uint<64>((unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+#endif
+
+/**
+ * \brief   Input monitor - passes the network input and timestamps the first word of each frame
+ *
+ * \tparam DataWidth      Width of the stream
+ * \tparam WordsPerFrame  Number of stream words per frame
+ *
+ * \param in        Input stream of the network top
+ * \param out       Input stream of the network
+ * \param numReps   Number of frames
+ * \param ts        Timestamps of the first words, to OutputMonitor_Batch
+ * \param reports   Report chain: stall count
+ */
+template<unsigned DataWidth, unsigned WordsPerFrame>
+void InputMonitor_Batch(hls::stream<ap_uint<DataWidth> > &in, hls::stream<ap_uint<DataWidth> > &out,
+                        unsigned const  numReps, hls::stream<ap_uint<64> > &ts, hls::stream<ap_uint<32> > &reports) {
+  ap_uint<32>  stall = 0;
+  unsigned  word = 0;
+#ifdef __SYNTHESIS__
+  ap_uint<64>  cycle = 0;
+  for(unsigned  i = 0; i < numReps * WordsPerFrame; cycle++) {
+#pragma HLS PIPELINE II=1
+    // a new frame waits for room in ts without blocking, so that cycle keeps counting
+    if(!in.empty() && ((word != 0) || !ts.full())) {
+      if(out.full())  stall++;
+      else {
+        if(word == 0)  ts.write(cycle);
+        out.write(in.read());
+        if(++word == WordsPerFrame)  word = 0;
+        i++;
+      }
+    }
+  }
+#else
+  for(unsigned  i = 0; i < numReps * WordsPerFrame; i++) {
+    ap_uint<DataWidth> const  w = in.read();
+    if(word == 0)  ts.write(instrument_now());
+    if(out.full())  stall++;
+    out.write(w);
+    if(++word == WordsPerFrame)  word = 0;
+  }
+#endif
+  reports.write(stall);
+}
+
+/**
+ * \brief   Stream monitor - passes a stream and counts its stalls
+ *
+ * Forwards the NumReports words of the report chain received from upstream
+ * and appends the cycles it could not write (consumer stalled) and the
+ * cycles it had nothing to read (producer starved).
+ *
+ * \tparam DataWidth      Width of the stream
+ * \tparam WordsPerFrame  Number of stream words per frame
+ * \tparam NumReports     Number of report words of the upstream monitors
+ */
+template<unsigned DataWidth, unsigned WordsPerFrame, unsigned NumReports>
+void StreamMonitor_Batch(hls::stream<ap_uint<DataWidth> > &in, hls::stream<ap_uint<DataWidth> > &out, unsigned const  numReps,
+                         hls::stream<ap_uint<32> > &reports_in, hls::stream<ap_uint<32> > &reports_out) {
+  ap_uint<32>  words = 0, stall = 0, starve = 0;
+  StreamProbeLoop<DataWidth>(in, out, numReps * WordsPerFrame, words, starve, stall);
+  for(unsigned  i = 0; i < NumReports; i++) {
+    reports_out.write(reports_in.read());
+  }
+  reports_out.write(stall);
+  reports_out.write(starve);
+}
+
+/**
+ * \brief   Frame latency statistics of OutputMonitor_Batch
+ */
+template<unsigned NumBins, unsigned BinShift>
+class LatencyStats {
+ public:
+  ap_uint<32>  m_hist[NumBins];
+  ap_uint<32>  m_frames;
+  ap_uint<32>  m_min;
+  ap_uint<32>  m_max;
+  ap_uint<64>  m_sum;
+  ap_uint<64>  m_first;  // first input of the first frame
+  ap_uint<64>  m_last;   // last output of the last frame
+
+ public:
+  LatencyStats() : m_frames(0), m_min(~ap_uint<32>(0)), m_max(0), m_sum(0), m_first(0), m_last(0) {
+    for(unsigned  i = 0; i < NumBins; i++) {
+#pragma HLS PIPELINE II=1
+      m_hist[i] = 0;
+    }
+  }
+
+ public:
+  /** Records a frame from its first input to its last output timestamp. */
+  void record(ap_uint<64> const &first_in, ap_uint<64> const &last_out) {
+#pragma HLS inline
+    ap_uint<64> const  d = last_out - first_in;
+    ap_uint<32> const  lat = d(63, 32) != 0? ~ap_uint<32>(0) : ap_uint<32>(d(31, 0));
+    if(m_frames == 0)  m_first = first_in;
+    m_last = last_out;
+    m_frames++;
+    m_sum += lat;
+    if(lat < m_min)  m_min = lat;
+    if(lat > m_max)  m_max = lat;
+    ap_uint<32> const  bin = lat >> BinShift;
+    m_hist[bin < NumBins? unsigned(bin) : NumBins - 1]++;
+  }
+};
+
+/**
+ * \brief   Output monitor - passes the network output, measures the frame latencies and writes the stats
+ *
+ * The cycles the network top's consumer does not accept output count as
+ * neither starved nor stalled. The stats are written after the last frame.
+ *
+ * \tparam DataWidth      Width of the stream
+ * \tparam WordsPerFrame  Number of stream words per frame
+ * \tparam NumMonitors    Number of StreamMonitor_Batch in the report chain
+ * \tparam NumBins        Number of bins of the latency histogram
+ * \tparam BinShift       log2 of the width of a histogram bin
+ *
+ * \param in        Output stream of the network
+ * \param out       Output stream of the network top
+ * \param numReps   Number of frames
+ * \param ts        Timestamps of the first words, from InputMonitor_Batch
+ * \param reports   Report chain
+ * \param stats     Stats array of InstrumentLayout<NumMonitors, NumBins>::SIZE words
+ */
+template<unsigned DataWidth, unsigned WordsPerFrame, unsigned NumMonitors, unsigned NumBins, unsigned BinShift>
+void OutputMonitor_Batch(hls::stream<ap_uint<DataWidth> > &in, hls::stream<ap_uint<DataWidth> > &out, unsigned const  numReps,
+                         hls::stream<ap_uint<64> > &ts, hls::stream<ap_uint<32> > &reports, ap_uint<32> *stats) {
+  typedef InstrumentLayout<NumMonitors, NumBins>  Layout;
+  LatencyStats<NumBins, BinShift>  lat;
+  ap_uint<32>  starve = 0;
+  unsigned  word = 0;
+#ifdef __SYNTHESIS__
+  // in registers, so that back-to-back frames can update the histogram at II=1
+#pragma HLS ARRAY_PARTITION variable=lat.m_hist complete
+  ap_uint<64>  cycle = 0;
+  for(unsigned  i = 0; i < numReps * WordsPerFrame; cycle++) {
+#pragma HLS PIPELINE II=1
+    // never block, so that cycle keeps counting in step with InputMonitor_Batch
+    if(in.empty())  starve++;
+    else if(!out.full()) {
+      out.write(in.read());
+      i++;
+      if(++word == WordsPerFrame) {
+        word = 0;
+        lat.record(ts.read(), cycle);
+      }
+    }
+  }
+#else
+  for(unsigned  i = 0; i < numReps * WordsPerFrame; i++) {
+    if(in.empty())  starve++;
+    out.write(in.read());
+    if(++word == WordsPerFrame) {
+      word = 0;
+      ap_uint<64> const  now = instrument_now();
+      ap_uint<64> const  start = ts.read();
+      lat.record(start, now);
+      FrameTiming const  t = { (unsigned long long)(lat.m_frames - 1), start.to_uint64(), now.to_uint64() };
+      InstrumentTrace().write(t);
+    }
+  }
+#endif
+
+  ap_uint<64> const  span = lat.m_last - lat.m_first;
+  stats[Layout::FRAMES] = lat.m_frames;
+  stats[Layout::LAT_MIN] = lat.m_frames == 0? ap_uint<32>(0) : lat.m_min;
+  stats[Layout::LAT_MAX] = lat.m_max;
+  stats[Layout::LAT_SUM] = lat.m_sum(31, 0);
+  stats[Layout::LAT_SUM + 1] = lat.m_sum(63, 32);
+  stats[Layout::SPAN] = span(31, 0);
+  stats[Layout::SPAN + 1] = span(63, 32);
+  stats[Layout::IN_STALL] = reports.read();
+  stats[Layout::OUT_STARVE] = starve;
+  for(unsigned  i = 0; i < 2 * NumMonitors; i++) {
+    stats[Layout::MONITORS + i] = reports.read();
+  }
+  for(unsigned  i = 0; i < NumBins; i++) {
+#pragma HLS PIPELINE II=1
+    stats[Layout::HIST + i] = lat.m_hist[i];
+  }
+}
+
+#ifndef __SYNTHESIS__
+/**
+ * \brief   Host-side view of a stats array
+ *
+ * Latencies and spans are in the unit of the timestamps: cycles in hardware,
+ * nanoseconds in C simulation.
+ */
+template<unsigned NumMonitors, unsigned NumBins, unsigned BinShift>
+class InstrumentReport {
+  typedef InstrumentLayout<NumMonitors, NumBins>  Layout;
+  ap_uint<32> const *m_stats;
+
+  unsigned long long word64(unsigned const  idx) const {
+    return  (unsigned long long)m_stats[idx + 1].to_uint64() << 32 | m_stats[idx].to_uint64();
+  }
+
+ public:
+  InstrumentReport(ap_uint<32> const *stats) : m_stats(stats) {}
+
+ public:
+  unsigned long long frames()   const { return  m_stats[Layout::FRAMES].to_uint64(); }
+  unsigned long long min()      const { return  m_stats[Layout::LAT_MIN].to_uint64(); }
+  unsigned long long max()      const { return  m_stats[Layout::LAT_MAX].to_uint64(); }
+  unsigned long long span()     const { return  word64(Layout::SPAN); }
+  double mean() const {
+    return  frames() == 0? 0.0 : double(word64(Layout::LAT_SUM)) / frames();
+  }
+
+  /** Upper bound of the latency percentile p (0 < p <= 100) from the histogram. */
+  unsigned long long percentile(double const  p) const {
+    unsigned long long const  n = frames();
+    if(n == 0)  return  0;
+    unsigned long long  seen = 0;
+    for(unsigned  i = 0; i < NumBins; i++) {
+      seen += m_stats[Layout::HIST + i].to_uint64();
+      if(seen * 100.0 >= p * n) {
+        unsigned long long const  upper = ((unsigned long long)(i + 1) << BinShift) - 1;
+        return  i + 1 == NumBins || upper > max()? max() : upper;
+      }
+    }
+    return  max();
+  }
+
+  /** Frames per second for timestamps at the given clock (in MHz, 0 for nanoseconds). */
+  double frames_per_second(double const  fclk_mhz = 0.0) const {
+    if(frames() < 2 || span() == 0)  return  0.0;
+    double const  per_second = fclk_mhz > 0.0? fclk_mhz * 1e6 : 1e9;
+    return  frames() * per_second / span();
+  }
+
+  void print(std::ostream &os, double const  fclk_mhz = 0.0) const {
+    char const *const  unit = fclk_mhz > 0.0? " cycles" : " ns";
+    os << "frames " << frames() << ", " << std::fixed << std::setprecision(1) << frames_per_second(fclk_mhz) << " frames/s\n"
+       << "latency min " << min() << unit << ", mean " << mean() << unit
+       << ", p50 " << percentile(50) << unit << ", p99 " << percentile(99) << unit << ", max " << max() << unit << '\n'
+       << "input stalls " << m_stats[Layout::IN_STALL] << ", output starved " << m_stats[Layout::OUT_STARVE] << '\n';
+    for(unsigned  i = 0; i < NumMonitors; i++) {
+      os << "stream " << i << ": stalled " << m_stats[Layout::MONITORS + 2*i] << ", starved " << m_stats[Layout::MONITORS + 2*i + 1] << '\n';
+    }
+  }
+};
+#endif
+
+#endif
@@ -49,6 +49,63 @@
 #define INTERPRET_HPP
 
 #include <ap_int.h>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * Native integer fast paths of the C simulation.
+ *
+ * Outside of synthesis, bit vectors of up to 64 bits are sliced as native
+ * uint64_t rather than through the arbitrary-precision part selects of
+ * ap_[u]int, which dominate the runtime of C simulations. All interfaces
+ * keep their ap_[u]int types so that synthesis sees the very same code.
+ * Define FINN_NO_NATIVE_CSIM to simulate the plain ap_[u]int implementation.
+ */
+#if !defined(__SYNTHESIS__) && !defined(FINN_NO_NATIVE_CSIM)
+#define FINN_NATIVE_CSIM
+#endif
+
+namespace finn {
+namespace native {
+
+  /** Bit width of an ap_[u]int, 0 for types without a native mapping. */
+  template<typename T> struct width_of { static unsigned const  value = 0; };
+  template<int W> struct width_of<ap_uint<W>> { static unsigned const  value = W; };
+  template<int W> struct width_of<ap_int<W>>  { static unsigned const  value = W; };
+  template<typename T> struct width_of<T const> : width_of<T> {};
+
+  /** Whether T maps onto a native uint64_t. */
+  template<typename T> struct fits {
+    static bool const  value = (width_of<T>::value > 0) && (width_of<T>::value <= 64);
+  };
+
+  /** Mask of the w least significant bits. */
+  constexpr uint64_t mask(unsigned const  w) {
+    return  w >= 64? ~uint64_t(0) : (uint64_t(1) << w) - 1;
+  }
+
+  template<typename T>
+  inline uint64_t bits(T const &v, std::true_type) { return  v.to_uint64(); }
+  template<typename T>
+  inline uint64_t bits(T const&, std::false_type) { return  0; }
+
+  /** Bits of v as a native integer, 0 if T does not fit. */
+  template<typename T>
+  inline uint64_t bits(T const &v) {
+    return  bits(v, std::integral_constant<bool, fits<T>::value>());
+  }
+
+  /** The w-bit field of v starting at bit lo. */
+  inline uint64_t field(uint64_t const  v, unsigned const  lo, unsigned const  w) {
+    return (v >> lo) & mask(w);
+  }
+
+  inline unsigned popcount(uint64_t const  v) {
+    return  __builtin_popcountll(v);
+  }
+
+} // namespace native
+} // namespace finn
 
 /**
  * Thin wrapper around an ap_uint<1> redefining multiplication with
@@ -140,6 +197,11 @@ class Recast {
    public:
     T operator[](unsigned const  idx) const {
 #pragma HLS inline
+#ifdef FINN_NATIVE_CSIM
+      if(finn::native::fits<TV>::value) {
+        return  T(ap_uint<1>(finn::native::field(finn::native::bits(m_val), idx, 1)));
+      }
+#endif
       return  T(m_val[idx]);
     }
     auto operator[](unsigned const  idx) -> decltype(m_val[idx]) {
@@ -153,6 +215,10 @@ class Recast {
    };
 
  public:
+  /** Interpreted value type, e.g. for overloads on Recast<XnorMul> operands. */
+  template<typename TV>
+  using container = Container<TV>;
+
   template<typename TV>
   Container<TV> operator()(TV const &val) const {
 #pragma HLS inline
@@ -200,6 +266,12 @@ class Slice {
    public:
     T operator[](unsigned const  idx) const {
 #pragma HLS inline 
+#ifdef FINN_NATIVE_CSIM
+      if(finn::native::fits<TV>::value) {
+        ap_uint<STRIDE> const  r = finn::native::field(finn::native::bits(m_val), idx*STRIDE, STRIDE);
+        return  Caster<T>::cast(ap_int<STRIDE>(r));
+      }
+#endif
       ap_uint<STRIDE> const  r = m_val((idx+1)*STRIDE-1, idx*STRIDE); 
       return  Caster<T>::cast(ap_int<STRIDE>(r));
     }
@@ -64,6 +64,7 @@
 #define MAC_HPP
 
 #include "utils.hpp"
+#include "interpret.hpp"
 
 
 /**
@@ -170,6 +171,27 @@ T mac(T const &a, TC const &c, TD const &d, R const &r) {
   }
   return  res;
 }
+
+#ifdef FINN_NATIVE_CSIM
+/**
+ * \brief      C-simulation fast path of the XNOR-popcount MAC of binarized layers
+ *
+ * Counts the matching bits of weights and input activations 64 at a time
+ * instead of bit by bit. Not visible to synthesis, which implements the
+ * generic MAC above.
+ */
+template<unsigned N, typename T, int W, typename R>
+T mac(T const &a, ap_uint<W> const &c, Recast<XnorMul>::container<ap_uint<W>> const &d, R const&) {
+  ap_uint<W> const &dv = d;
+  T  res = a;
+  for(unsigned  lo = 0; lo < N; lo += 64) {
+    uint64_t const  eq = ~(ap_uint<W>(c >> lo).to_uint64() ^ ap_uint<W>(dv >> lo).to_uint64());
+    res += finn::native::popcount(eq & finn::native::mask(N - lo));
+  }
+  return  res;
+}
+#endif
+
 template<unsigned N, typename T, typename TC, typename TD>
 inline T mac(T const &a, TC const &c, TD const &d) {
 #pragma HLS inline
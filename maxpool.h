@@ -47,6 +47,8 @@
 #define MAXPOOL_H
  
 #include <limits>
+
+#include "dataflow.h"
  
 /**
  * \brief   Max Pool implementation for Binarized values 
@@ -196,15 +198,17 @@ template<unsigned int ImgDim, unsigned int PoolDim, unsigned int NumChannels, ty
 void StreamingMaxPool_Precision_Batch(stream<ap_uint<InStreamW> > & in,
 		stream<ap_uint<OutStreamW> > & out, unsigned int numReps) {
 #pragma HLS INLINE
+  FINN_DATAFLOW_REGION;
   unsigned const  InpPerImage = ImgDim*ImgDim*NumChannels*ActType::width/InStreamW ;
   unsigned const  OutPerImage = ImgDim*ImgDim / (PoolDim*PoolDim);
   WidthAdjustedInputStream <InStreamW, NumChannels*ActType::width, InpPerImage>  wa_in (in,  numReps);
   WidthAdjustedOutputStream<NumChannels*ActType::width,  OutStreamW, OutPerImage>  wa_out(out, numReps);
+  FINN_DATAFLOW_STAGE(
   for (unsigned int rep = 0; rep < numReps; rep++) {
     StreamingMaxPool_Precision<ImgDim, PoolDim, NumChannels, ActType, min_value>
       (static_cast<hls::stream<ap_uint<NumChannels*ActType::width>>&>(wa_in), 
       static_cast<hls::stream<ap_uint<NumChannels*ActType::width>>&>(wa_out));
-  }
+  });
 }
 
 
@@ -0,0 +1,334 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  \file network.h
+ *
+ *  Declarative description of layer pipelines.
+ *
+ *  A network is a list of layer configurations, e.g.
+ *
+ *    typedef ConvLayerCfg<3, 64, 32, 64, 30, 32, 16, Slice<ap_uint<2>>, Slice<ap_uint<2>>, Identity, L0> Conv0;
+ *    typedef MaxPoolLayerCfg<30, 2, 64, ap_uint<2>, 0>  Pool0;
+ *    typedef FCLayerCfg<14400, 10, 64, 10, Slice<ap_uint<2>>, Slice<ap_int<16>>, Identity, L1>  FC0;
+ *
+ *    void network(hls::stream<ap_uint<InW>> &in, hls::stream<ap_uint<OutW>> &out, unsigned numReps) {
+ *    #pragma HLS DATAFLOW
+ *      Network_Batch<Conv0, Pool0, FC0>(in, out, numReps);
+ *    }
+ *
+ *  where the parameter classes (L0, L1 above) provide the static members
+ *  weights and activation of the respective layers. Network_Batch declares
+ *  the streams between the layers, sized to the least common multiple of the
+ *  output fold of the producer and the input fold of the consumer, so that
+ *  the width adaptation of both layers reduces to a plain DWC. The stream
+ *  depths cover one output burst of the producer. The compatibility of
+ *  adjacent layers is checked at compile time, and DataflowNetwork<...>::perf
+ *  is the model of the pipeline in perf_model.h.
+ *
+ *  Network_Batch is inlined, so its caller must be a DATAFLOW region for
+ *  the layers to run concurrently: the streams between them are only as
+ *  deep as one output burst. The weights must not be written within that
+ *  region, as a layer is their only consumer; load them before calling it,
+ *  e.g. in the enclosing top (see tb/network_top.cpp).
+ *
+ *  Network_Batch_Instrumented additionally measures the frame latencies and
+ *  the stalls of all streams at run time, see instrumentation.h.
+ *
+ *****************************************************************************/
+
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include "dataflow.h"
+#include "perf_model.h"
+#include "instrumentation.h"
+#include "maxpool.h"
+#include "fclayer.h"
+#include "convlayer.h"
+
+/** Greatest common divisor and least common multiple of stream widths. */
+constexpr unsigned network_gcd(unsigned const  a, unsigned const  b) {
+  return  b == 0? a : network_gcd(b, a % b);
+}
+constexpr unsigned network_lcm(unsigned const  a, unsigned const  b) {
+  return  a / network_gcd(a, b) * b;
+}
+
+/**
+ * \brief   Configuration of a ConvLayer_Batch in a network
+ *
+ * \tparam ConvKernelDim  Dimension of the convolutional kernel (assumed square)
+ * \tparam IFMChannels    Number of Input Feature Maps
+ * \tparam IFMDim         Width and Heigth of the Input Feature Map (assumed square)
+ * \tparam OFMChannels    Number of Output Feature Maps
+ * \tparam OFMDim         Width and Heigth of the Output Feature Map (assumed square)
+ * \tparam SIMD           Number of input columns computed in parallel
+ * \tparam PE             Number of output rows computed in parallel
+ * \tparam TSrcI          DataType of the input activation (as used in the MAC)
+ * \tparam TDstI          DataType of the output activation (as generated by the activation)
+ * \tparam TWeightI       DataType of the weights (as used in the MAC)
+ * \tparam TParams        Class with the static members weights and activation of the layer
+ * \tparam R              Resource type for the hardware implementation of the MAC block
+ */
+template<
+  unsigned int ConvKernelDim, unsigned int IFMChannels, unsigned int IFMDim,
+  unsigned int OFMChannels, unsigned int OFMDim,
+  unsigned int SIMD, unsigned int PE,
+  typename TSrcI, typename TDstI, typename TWeightI,
+  typename TParams, typename R = ap_resource_dflt
+>
+struct ConvLayerCfg {
+  static unsigned const  InElemW  = TSrcI::width;
+  static unsigned const  OutElemW = TDstI::width;
+  static unsigned const  InBits   = IFMDim * IFMDim * IFMChannels * TSrcI::width;
+  static unsigned const  OutBits  = OFMDim * OFMDim * OFMChannels * TDstI::width;
+  static unsigned const  InFold   = SIMD * TSrcI::width;
+  static unsigned const  OutFold  = PE * TDstI::width;
+  static unsigned const  OutBurst = OFMChannels / PE;   // one output pixel
+  typedef finn::perf::ConvLayer<ConvKernelDim, IFMChannels, IFMDim, OFMChannels, OFMDim, SIMD, PE>  perf;
+
+  template<int InStreamW, int OutStreamW>
+  static void run(hls::stream<ap_uint<InStreamW>> &in, hls::stream<ap_uint<OutStreamW>> &out, unsigned const  reps) {
+#pragma HLS INLINE
+    ConvLayer_Batch<ConvKernelDim, IFMChannels, IFMDim, OFMChannels, OFMDim, SIMD, PE, TSrcI, TDstI, TWeightI>
+      (in, out, TParams::weights, TParams::activation, reps, R());
+  }
+};
+
+/**
+ * \brief   Configuration of a StreamingFCLayer_Batch in a network
+ *
+ * \tparam MatrixW   Width of the input matrix
+ * \tparam MatrixH   Heigth of the input matrix
+ * \tparam SIMD      Number of input columns computed in parallel
+ * \tparam PE        Number of output rows computed in parallel
+ * \tparam TSrcI     DataType of the input activation (as used in the MAC)
+ * \tparam TDstI     DataType of the output activation (as generated by the activation)
+ * \tparam TWeightI  DataType of the weights (as used in the MAC)
+ * \tparam TParams   Class with the static members weights and activation of the layer
+ * \tparam R         Resource type for the hardware implementation of the MAC block
+ */
+template<
+  unsigned int MatrixW, unsigned int MatrixH,
+  unsigned int SIMD, unsigned int PE,
+  typename TSrcI, typename TDstI, typename TWeightI,
+  typename TParams, typename R = ap_resource_dflt
+>
+struct FCLayerCfg {
+  static unsigned const  InElemW  = TSrcI::width;
+  static unsigned const  OutElemW = TDstI::width;
+  static unsigned const  InBits   = MatrixW * TSrcI::width;
+  static unsigned const  OutBits  = MatrixH * TDstI::width;
+  static unsigned const  InFold   = SIMD * TSrcI::width;
+  static unsigned const  OutFold  = PE * TDstI::width;
+  static unsigned const  OutBurst = 1;
+  typedef finn::perf::FCLayer<MatrixW, MatrixH, SIMD, PE>  perf;
+
+  template<int InStreamW, int OutStreamW>
+  static void run(hls::stream<ap_uint<InStreamW>> &in, hls::stream<ap_uint<OutStreamW>> &out, unsigned const  reps) {
+#pragma HLS INLINE
+    StreamingFCLayer_Batch<MatrixW, MatrixH, SIMD, PE, TSrcI, TDstI, TWeightI>
+      (in, out, TParams::weights, TParams::activation, reps, R());
+  }
+};
+
+/**
+ * \brief   Configuration of a StreamingMaxPool_Precision_Batch in a network
+ *
+ * \tparam ImgDim       Width and Heigth of the Input Feature Map (assumed square)
+ * \tparam PoolDim      Dimension of the Max Pool kernel (assumed square)
+ * \tparam NumChannels  Number of Input Feature Maps
+ * \tparam ActType      DataType of the input activation (as used in the comparison)
+ * \tparam min_value    Minimum value possible with the given ActType
+ */
+template<unsigned int ImgDim, unsigned int PoolDim, unsigned int NumChannels, typename ActType, int min_value>
+struct MaxPoolLayerCfg {
+  static unsigned const  InElemW  = ActType::width;
+  static unsigned const  OutElemW = ActType::width;
+  static unsigned const  InBits   = ImgDim * ImgDim * NumChannels * ActType::width;
+  static unsigned const  OutBits  = (ImgDim / PoolDim) * (ImgDim / PoolDim) * NumChannels * ActType::width;
+  static unsigned const  InFold   = NumChannels * ActType::width;
+  static unsigned const  OutFold  = NumChannels * ActType::width;
+  static unsigned const  OutBurst = ImgDim / PoolDim;   // one output row
+  typedef finn::perf::MaxPool<ImgDim, PoolDim>  perf;
+
+  template<int InStreamW, int OutStreamW>
+  static void run(hls::stream<ap_uint<InStreamW>> &in, hls::stream<ap_uint<OutStreamW>> &out, unsigned const  reps) {
+#pragma HLS INLINE
+    StreamingMaxPool_Precision_Batch<ImgDim, PoolDim, NumChannels, ActType, min_value>(in, out, reps);
+  }
+};
+
+/**
+ * \brief   Pipeline of layer configurations
+ *
+ * run() instantiates the layers as stages of the enclosing dataflow region
+ * together with the streams connecting them. perf is the model of the
+ * pipeline, see finn::perf::Network.
+ */
+template<typename... Layers>
+struct DataflowNetwork;
+
+template<typename L>
+struct DataflowNetwork<L> {
+  typedef L  First;
+  static unsigned const  NumMonitors = 0;
+  typedef finn::perf::Network<typename L::perf>  perf;
+
+  template<int InStreamW, int OutStreamW>
+  static void run(hls::stream<ap_uint<InStreamW>> &in, hls::stream<ap_uint<OutStreamW>> &out, unsigned const  reps) {
+#pragma HLS INLINE
+    // runs on the calling thread: a stage would outlive this frame and its reps
+    L::run(in, out, reps);
+  }
+
+  template<unsigned NumReports, typename Cfg, int InStreamW, int OutStreamW>
+  static void run_monitored(hls::stream<ap_uint<InStreamW>> &in, hls::stream<ap_uint<OutStreamW>> &out, unsigned const  reps,
+                            hls::stream<ap_uint<64>> &ts, hls::stream<ap_uint<32>> &reports, ap_uint<32> *stats) {
+#pragma HLS INLINE
+    static_assert(L::OutBits % OutStreamW == 0, "The output must be a whole number of stream words");
+    hls::stream<ap_uint<OutStreamW>>  net_out("DataflowNetwork.out");
+    FINN_DATAFLOW_STAGE(L::run(in, net_out, reps));
+    OutputMonitor_Batch<OutStreamW, L::OutBits / OutStreamW, (NumReports - 1) / 2, Cfg::NumBins, Cfg::BinShift>
+      (net_out, out, reps, ts, reports, stats);
+  }
+};
+
+template<typename L, typename... Tail>
+struct DataflowNetwork<L, Tail...> {
+  typedef L  First;
+  typedef DataflowNetwork<Tail...>  Next;
+  static unsigned const  NumMonitors = 1 + Next::NumMonitors;
+  typedef finn::perf::Network<typename L::perf, typename Tail::perf...>  perf;
+
+  static_assert(L::OutElemW == Next::First::InElemW, "Adjacent layers must agree on the activation width");
+  static_assert(L::OutBits == Next::First::InBits, "Adjacent layers must agree on the size of the feature map");
+
+  // stream between L and the next layer and its depth in words
+  static unsigned const  StreamW = network_lcm(L::OutFold, Next::First::InFold);
+  static unsigned const  BurstWords = (L::OutBurst * L::OutFold + StreamW - 1) / StreamW;
+  static unsigned const  FifoDepth = BurstWords > 2? BurstWords : 2;
+  static_assert(L::OutBits % StreamW == 0, "The feature map must be a whole number of stream words");
+
+  template<int InStreamW, int OutStreamW>
+  static void run(hls::stream<ap_uint<InStreamW>> &in, hls::stream<ap_uint<OutStreamW>> &out, unsigned const  reps) {
+#pragma HLS INLINE
+    hls::stream<ap_uint<StreamW>>  inter("DataflowNetwork.inter");
+#pragma HLS STREAM variable=inter depth=FifoDepth
+#ifdef FINN_DATAFLOW_THREADED
+    inter.set_depth(FifoDepth);
+#endif
+    FINN_DATAFLOW_STAGE(L::run(in, inter, reps));
+    Next::run(inter, out, reps);
+  }
+
+  template<unsigned NumReports, typename Cfg, int InStreamW, int OutStreamW>
+  static void run_monitored(hls::stream<ap_uint<InStreamW>> &in, hls::stream<ap_uint<OutStreamW>> &out, unsigned const  reps,
+                            hls::stream<ap_uint<64>> &ts, hls::stream<ap_uint<32>> &reports, ap_uint<32> *stats) {
+#pragma HLS INLINE
+    hls::stream<ap_uint<StreamW>>  inter("DataflowNetwork.inter");
+    hls::stream<ap_uint<StreamW>>  monitored("DataflowNetwork.monitored");
+    hls::stream<ap_uint<32>>  chain("DataflowNetwork.reports");
+#pragma HLS STREAM variable=inter depth=FifoDepth
+#pragma HLS STREAM variable=monitored depth=2
+#ifdef FINN_DATAFLOW_THREADED
+    inter.set_depth(FifoDepth);
+#endif
+    FINN_DATAFLOW_STAGE(L::run(in, inter, reps));
+    FINN_DATAFLOW_STAGE(StreamMonitor_Batch<StreamW, L::OutBits / StreamW, NumReports>(inter, monitored, reps, reports, chain));
+    Next::template run_monitored<NumReports + 2, Cfg>(monitored, out, reps, ts, chain, stats);
+  }
+};
+
+/**
+ * \brief   Network top - instantiates a pipeline of layers with its glue logic
+ *
+ * The widths of the network input and output streams are deduced, the widths
+ * and depths of the streams between the layers are derived from the layer
+ * configurations, see DataflowNetwork. To be called from a function with
+ * #pragma HLS DATAFLOW, which must not write the weights of the layers.
+ *
+ * \tparam Layers      Layer configurations in the order of the pipeline
+ * \tparam InStreamW   Width of the input stream
+ * \tparam OutStreamW  Width of the output stream
+ *
+ * \param in           Input stream
+ * \param out          Output stream
+ * \param reps         Number of time the function has to be repeatedly executed (e.g. number of images)
+ */
+template<typename... Layers, int InStreamW, int OutStreamW>
+void Network_Batch(hls::stream<ap_uint<InStreamW>> &in, hls::stream<ap_uint<OutStreamW>> &out, unsigned const  reps) {
+#pragma HLS INLINE
+  FINN_DATAFLOW_REGION;
+  DataflowNetwork<Layers...>::run(in, out, reps);
+}
+
+/**
+ * \brief   Network top with run-time instrumentation, see instrumentation.h
+ *
+ * Like Network_Batch, with monitors on the input, the output and every
+ * stream between two layers, which write the frame latency statistics and
+ * the stall counts to stats. To be called from a DATAFLOW function, as
+ * Network_Batch.
+ *
+ * \tparam Cfg         InstrumentCfg with the histogram parameters
+ * \tparam Layers      Layer configurations in the order of the pipeline
+ * \tparam InStreamW   Width of the input stream
+ * \tparam OutStreamW  Width of the output stream
+ *
+ * \param in           Input stream
+ * \param out          Output stream
+ * \param reps         Number of time the function has to be repeatedly executed (e.g. number of images)
+ * \param stats        Stats array of InstrumentLayout<DataflowNetwork<Layers...>::NumMonitors, Cfg::NumBins>::SIZE words
+ */
+template<typename Cfg, typename... Layers, int InStreamW, int OutStreamW>
+void Network_Batch_Instrumented(hls::stream<ap_uint<InStreamW>> &in, hls::stream<ap_uint<OutStreamW>> &out,
+                                unsigned const  reps, ap_uint<32> *stats) {
+#pragma HLS INLINE
+  FINN_DATAFLOW_REGION;
+  typedef DataflowNetwork<Layers...>  Net;
+  static_assert(Net::First::InBits % InStreamW == 0, "The input must be a whole number of stream words");
+  hls::stream<ap_uint<InStreamW>>  net_in("Network_Batch_Instrumented.in");
+  hls::stream<ap_uint<64>>  ts("Network_Batch_Instrumented.ts");
+  hls::stream<ap_uint<32>>  reports("Network_Batch_Instrumented.reports");
+  unsigned const  TSDepth = Cfg::TSDepth;
+#pragma HLS STREAM variable=ts depth=TSDepth
+#ifdef FINN_DATAFLOW_THREADED
+  ts.set_depth(TSDepth);
+#endif
+  FINN_DATAFLOW_STAGE(InputMonitor_Batch<InStreamW, Net::First::InBits / InStreamW>(in, net_in, reps, ts, reports));
+  Net::template run_monitored<1, Cfg>(net_in, out, reps, ts, reports, stats);
+}
+
+#endif
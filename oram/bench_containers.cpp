@@ -0,0 +1,229 @@
+// C-simulation throughput of the oram/memory containers: inserts, erases,
+// lookups (half of them misses) and full iterations, each measured at 25%,
+// 50% and 90% fill. Build with -DCMAKE_BUILD_TYPE=Release for meaningful
+// numbers; see bench_containers.tcl for the HLS latency and II of the same
+// operations.
+//
+// Usage: container_bench [--filter <substring>] [--min-time <seconds>] [--csv <file>]
+#include "bench_containers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+
+constexpr uint32_t FILL_PERCENT[] = {25, 50, 90};
+constexpr uint32_t BATCH = container_capacity / 20;  // keys per timed insert/erase/lookup batch
+
+static volatile uint32_t g_sink;
+
+using Clock = std::chrono::steady_clock;
+
+
+struct Result {
+	std::string container;
+	const char* op;
+	uint32_t    fill;
+	uint32_t    size;
+	uint64_t    ops = 0;
+	double      seconds = 0;
+
+	double opsPerSec() const {
+		return (seconds > 0) ? ops / seconds : 0;
+	}
+};
+
+
+// Keys in a container and keys out of it, updated by the benchmarks as they go
+struct KeySets {
+	std::vector<uint32_t> present;
+	std::vector<uint32_t> absent;
+	uint32_t next_present = 0;
+	uint32_t next_absent  = 0;
+
+	uint32_t takePresent() {
+		next_present = (next_present + 1) % present.size();
+		return present[next_present];
+	}
+
+	uint32_t takeAbsent() {
+		next_absent = (next_absent + 1) % absent.size();
+		return absent[next_absent];
+	}
+
+	// Moves a key that could not be inserted again (BinaryHeap does not rebalance) to the absent ones
+	void drop(uint32_t key) {
+		present.erase(std::find(present.begin(), present.end(), key));
+		absent.push_back(key);
+	}
+};
+
+
+// Fills c with random keys up to fill percent of the capacity, or until the
+// container turns keys down (BinaryHeap may before it is full)
+template<typename Bench>
+KeySets fill(typename Bench::type& c, uint32_t percent, std::mt19937& gen) {
+	std::vector<uint32_t> keys(container_key_range);
+	for (uint32_t i = 0; i < container_key_range; ++i) keys[i] = i;
+	std::shuffle(keys.begin(), keys.end(), gen);
+
+	KeySets sets;
+	const uint32_t target = container_capacity * percent / 100;
+	for (uint32_t key : keys) {
+		if ((sets.present.size() < target) && Bench::insert(c, key)) sets.present.push_back(key);
+		else                                                          sets.absent.push_back(key);
+	}
+	return sets;
+}
+
+
+// Runs round until the timed parts add up to min_time; round returns the
+// operations it performed and adds its timed part to seconds
+template<typename RoundT>
+void measure(Result& r, double min_time, RoundT&& round) {
+	r.ops = 0;
+	r.seconds = 0;
+	while (r.seconds < min_time) {
+		r.ops += round(r.seconds);
+	}
+}
+
+double since(Clock::time_point start) {
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+
+template<typename Bench>
+void benchContainer(uint32_t percent, double min_time, std::vector<Result>& results) {
+	using type = typename Bench::type;
+	std::mt19937 gen{percent};
+	std::unique_ptr<type> c{new type()};
+	KeySets sets = fill<Bench>(*c, percent, gen);
+	const uint32_t size = sets.present.size();
+	uint32_t keys[BATCH];
+
+	// Inserts of absent keys, erased again untimed
+	Result insert{Bench::name(), "insert", percent, size};
+	measure(insert, min_time, [&](double& seconds) {
+		for (uint32_t i = 0; i < BATCH; ++i) keys[i] = sets.takeAbsent();
+		bool added[BATCH];
+		const auto start = Clock::now();
+		for (uint32_t i = 0; i < BATCH; ++i) added[i] = Bench::insert(*c, keys[i]);
+		seconds += since(start);
+		for (uint32_t i = 0; i < BATCH; ++i) {
+			if (added[i]) Bench::erase(*c, keys[i]);
+		}
+		return BATCH;
+	});
+
+	// Erases of present keys, inserted again untimed
+	Result erase{Bench::name(), "erase", percent, size};
+	measure(erase, min_time, [&](double& seconds) {
+		for (uint32_t i = 0; i < BATCH; ++i) keys[i] = sets.takePresent();
+		const auto start = Clock::now();
+		for (uint32_t i = 0; i < BATCH; ++i) Bench::erase(*c, keys[i]);
+		seconds += since(start);
+		for (uint32_t i = 0; i < BATCH; ++i) {
+			if (!Bench::insert(*c, keys[i])) sets.drop(keys[i]);
+		}
+		return BATCH;
+	});
+
+	// Lookups, alternating hits and misses
+	Result lookup{Bench::name(), "lookup", percent, size};
+	measure(lookup, min_time, [&](double& seconds) {
+		for (uint32_t i = 0; i < BATCH; ++i) keys[i] = (i % 2) ? sets.takeAbsent() : sets.takePresent();
+		uint32_t hits = 0;
+		const auto start = Clock::now();
+		for (uint32_t i = 0; i < BATCH; ++i) hits += Bench::lookup(*c, keys[i]);
+		seconds += since(start);
+		g_sink = hits;
+		return BATCH;
+	});
+
+	// Full iterations, counted per element visited
+	Result iterate{Bench::name(), "iterate", percent, size};
+	measure(iterate, min_time, [&](double& seconds) {
+		const auto start = Clock::now();
+		const uint32_t n = Bench::iterate(*c);
+		seconds += since(start);
+		if (n != sets.present.size()) {
+			std::cerr << Bench::name() << ": iterated " << n << " of " << sets.present.size() << " elements" << std::endl;
+			std::exit(EXIT_FAILURE);
+		}
+		g_sink = n;
+		return n;
+	});
+
+	results.push_back(insert);
+	results.push_back(erase);
+	results.push_back(lookup);
+	results.push_back(iterate);
+}
+
+template<typename Bench>
+void benchVariant(const char* filter, double min_time, std::vector<Result>& results) {
+	if (filter && (std::string(Bench::name()).find(filter) == std::string::npos)) return;
+	for (uint32_t percent : FILL_PERCENT) {
+		benchContainer<Bench>(percent, min_time, results);
+	}
+}
+
+
+int main(int argc, char** argv) {
+	const char* filter = nullptr;
+	const char* csv = nullptr;
+	double min_time = 0.05;
+
+	for (int i = 1; i < argc; ++i) {
+		const bool has_arg = (i + 1 < argc);
+		if      (!std::strcmp(argv[i], "--filter") && has_arg)   filter = argv[++i];
+		else if (!std::strcmp(argv[i], "--csv") && has_arg)      csv = argv[++i];
+		else if (!std::strcmp(argv[i], "--min-time") && has_arg) min_time = std::atof(argv[++i]);
+		else {
+			std::cerr << "Usage: " << argv[0] << " [--filter <substring>] [--min-time <seconds>] [--csv <file>]" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::vector<Result> results;
+	benchVariant<SparseSetBench>(filter, min_time, results);
+	benchVariant<ResourcePoolBench>(filter, min_time, results);
+	benchVariant<BinaryTreeBench>(filter, min_time, results);
+	benchVariant<BinaryHeapBench>(filter, min_time, results);
+	benchVariant<CuckooHashMapBench<2>>(filter, min_time, results);
+	benchVariant<CuckooHashMapBench<4>>(filter, min_time, results);
+	benchVariant<LinearMapBench>(filter, min_time, results);
+
+	std::cout << std::left << std::setw(24) << "container" << std::setw(9) << "op"
+	          << std::right << std::setw(6) << "fill" << std::setw(6) << "size" << std::setw(14) << "ops/s" << std::endl;
+	for (const Result& r : results) {
+		std::cout << std::left << std::setw(24) << r.container << std::setw(9) << r.op
+		          << std::right << std::setw(5) << r.fill << "%" << std::setw(6) << r.size
+		          << std::setw(14) << std::fixed << std::setprecision(0) << r.opsPerSec() << std::endl;
+	}
+
+	if (csv) {
+		std::ofstream out{csv};
+		out << std::setprecision(10);
+		out << "container,op,fill_percent,capacity,size,ops,seconds,ops_per_sec\n";
+		for (const Result& r : results) {
+			out << '"' << r.container << "\"," << r.op << ',' << r.fill << ',' << container_capacity << ','
+			    << r.size << ',' << r.ops << ',' << r.seconds << ',' << r.opsPerSec() << '\n';
+		}
+		if (!out) {
+			std::cerr << "Could not write " << csv << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+#include <ap_int.h>
+
+#include "memory/ap_array.h"
+#include "memory/fpga_binary_heap.h"
+#include "memory/fpga_binary_tree.h"
+#include "memory/fpga_cuckoo_map.h"
+#include "memory/fpga_resource_pool.h"
+#include "memory/fpga_sparse_set.h"
+#include "util.h"
+
+
+// Container variants of the microbenchmarks (bench_containers.cpp) and of the
+// HLS kernels (bench_containers_top.cpp), all holding about container_capacity
+// elements with keys below container_key_range. Every variant wraps its
+// container in the same static interface:
+//   insert(c, key)  -> whether the key was added
+//   erase(c, key)
+//   lookup(c, key)  -> whether the key is present
+//   iterate(c)      -> number of elements visited
+constexpr uint32_t container_capacity  = 256;
+constexpr uint32_t container_key_range = 1024;
+
+
+// Baseline: unordered key-value pairs in an ap_array, found by linear scan
+template<typename KeyT, typename ValueT, size_t Size>
+class LinearMap {
+public:
+	bool insert(const KeyT& key, const ValueT& value) {
+		if (find(key) != count || count == Size) return false;
+		items[count++] = {key, value};
+		return true;
+	}
+
+	void erase(const KeyT& key) {
+		const size_t idx = find(key);
+		if (idx == count) return;
+		items[idx] = items[--count];
+	}
+
+	size_t find(const KeyT& key) const {
+		size_t idx = count;
+		for (size_t i = 0; i < Size; ++i) {
+			#pragma HLS unroll factor=8
+			if ((i < count) && (items[i].first == key)) idx = i;
+		}
+		return idx;
+	}
+
+	size_t size() const noexcept {
+		return count;
+	}
+
+	const std::pair<KeyT, ValueT>& operator[](size_t idx) const {
+		return items[idx];
+	}
+
+private:
+	ap_array<std::pair<KeyT, ValueT>, Size> items;
+	size_t count = 0;
+};
+
+
+struct SparseSetBench {
+	using type = SparseSet<ap_uint<10>, container_key_range, container_capacity>;
+	static const char* name() { return "SparseSet"; }
+
+	static bool insert(type& c, uint32_t key) {
+		if (c.contains(key) || (c.size() == type::capacity())) return false;
+		c.insert(key);
+		return true;
+	}
+	static void erase(type& c, uint32_t key) { c.erase(key); }
+	static bool lookup(const type& c, uint32_t key) { return c.contains(key); }
+	static uint32_t iterate(const type& c) {
+		uint32_t n = 0;
+		for (auto it = c.begin(); it != c.end(); ++it) {
+			#pragma HLS pipeline
+			#pragma HLS loop_tripcount max=container_capacity
+			n += (it.access(c) < container_key_range);
+		}
+		return n;
+	}
+};
+
+struct ResourcePoolBench {
+	using type = ResourcePool<ap_uint<10>, uint64_t, container_capacity>;
+	static const char* name() { return "ResourcePool"; }
+
+	static bool insert(type& c, uint32_t key) { return c.emplace(key, key).second; }
+	static void erase(type& c, uint32_t key) { c.erase(key); }
+	static bool lookup(const type& c, uint32_t key) { return c.contains(key); }
+	static uint32_t iterate(type& c) {
+		uint32_t n = 0;
+		for (auto it = c.begin(); it != c.end(); ++it) {
+			#pragma HLS pipeline
+			#pragma HLS loop_tripcount max=container_capacity
+			n += (it.access(c) < container_key_range);
+		}
+		return n;
+	}
+};
+
+struct BinaryTreeBench {
+	using type = BinaryTree<uint32_t, uint64_t, container_capacity - 1>;
+	static const char* name() { return "BinaryTree"; }
+
+	static bool insert(type& c, uint32_t key) { return c.insert({key, key}).second; }
+	static void erase(type& c, uint32_t key) { c.erase(key); }
+	static bool lookup(const type& c, uint32_t key) { return c.contains(key); }
+	static uint32_t iterate(type& c) {
+		uint32_t n = 0;
+		for (auto it = c.begin(); it != c.end(); it.increment(c)) {
+			#pragma HLS loop_tripcount max=container_capacity
+			n += (it.access(c).first < container_key_range);
+		}
+		return n;
+	}
+};
+
+struct BinaryHeapBench {
+	using type = BinaryHeap<uint32_t, uint64_t, util::ceil_int_log2(container_capacity) - 1>;
+	static const char* name() { return "BinaryHeap"; }
+
+	static bool insert(type& c, uint32_t key) { return c.insert({key, key}).second; }
+	static void erase(type& c, uint32_t key) { c.erase(key); }
+	static bool lookup(const type& c, uint32_t key) { return c.contains(key); }
+	static uint32_t iterate(type& c) {
+		uint32_t n = 0;
+		for (auto it = c.begin(); it != c.end(); it.increment(c)) {
+			#pragma HLS loop_tripcount max=container_capacity
+			n += (it.access(c).first < container_key_range);
+		}
+		return n;
+	}
+};
+
+template<size_t Tables>
+struct CuckooHashMapBench {
+	using type = CuckooHashMap<uint32_t, uint64_t, container_capacity / Tables, Tables>;
+	static const char* name() { return (Tables == 2) ? "CuckooHashMap<2>" : "CuckooHashMap<4>"; }
+
+	static bool insert(type& c, uint32_t key) { return c.insert({key, key}).second; }
+	static void erase(type& c, uint32_t key) { c.erase(key); }
+	static bool lookup(const type& c, uint32_t key) { return c.contains(key); }
+	static uint32_t iterate(type& c) {
+		uint32_t n = 0;
+		for (auto it = c.begin(); it != c.end(); it.increment(c)) {
+			#pragma HLS loop_tripcount max=container_capacity
+			n += (it.access(c).first < container_key_range);
+		}
+		return n;
+	}
+};
+
+struct LinearMapBench {
+	using type = LinearMap<uint32_t, uint64_t, container_capacity>;
+	static const char* name() { return "ap_array (linear scan)"; }
+
+	static bool insert(type& c, uint32_t key) { return c.insert(key, key); }
+	static void erase(type& c, uint32_t key) { c.erase(key); }
+	static bool lookup(const type& c, uint32_t key) { return c.find(key) != c.size(); }
+	static uint32_t iterate(const type& c) {
+		uint32_t n = 0;
+		for (size_t i = 0; i < c.size(); ++i) {
+			#pragma HLS pipeline
+			#pragma HLS loop_tripcount max=container_capacity
+			n += (c[i].first < container_key_range);
+		}
+		return n;
+	}
+};
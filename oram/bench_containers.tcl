@@ -0,0 +1,32 @@
+# Synthesizes every top of bench_containers_top.cpp in a solution of its own,
+# for the estimated latency and II of the container operations.
+#
+# Usage (from oram/): vitis_hls -f bench_containers.tcl
+#         then:       python3 parse_hls_reports.py hls-container-bench -o containers_hls.csv
+#
+# Optionally, set CONTAINER_BENCH_TOPS to a space separated subset of the tops.
+set containers {sparse_set resource_pool binary_tree binary_heap cuckoo_map2 cuckoo_map4 linear_map}
+set ops        {insert erase lookup iterate}
+
+set tops {}
+if {[info exists ::env(CONTAINER_BENCH_TOPS)]} {
+	set tops $::env(CONTAINER_BENCH_TOPS)
+} else {
+	foreach container $containers {
+		foreach op $ops {
+			lappend tops ${container}_${op}
+		}
+	}
+}
+
+open_project hls-container-bench
+add_files bench_containers_top.cpp -cflags "-std=c++14"
+
+foreach top $tops {
+	set_top $top
+	open_solution $top
+	set_part {xczu3eg-sbva484-1-i}
+	create_clock -period 5 -name default
+	csynth_design
+}
+exit
@@ -0,0 +1,67 @@
+// HLS top functions of the container microbenchmarks: one per container
+// variant (bench_containers.h) and operation, each running a batch of
+// container_batch operations on a static container. Synthesized by
+// bench_containers.tcl for the estimated latency and II of every operation.
+#include "bench_containers.h"
+
+
+constexpr uint32_t container_batch = 32;
+
+
+template<typename Bench>
+void insertKernel(typename Bench::type& c, const uint32_t keys[container_batch], bool results[container_batch]) {
+	#pragma HLS inline
+	ops: for (uint32_t i = 0; i < container_batch; ++i) {
+		#pragma HLS pipeline
+		results[i] = Bench::insert(c, keys[i]);
+	}
+}
+
+template<typename Bench>
+void eraseKernel(typename Bench::type& c, const uint32_t keys[container_batch], bool results[container_batch]) {
+	#pragma HLS inline
+	ops: for (uint32_t i = 0; i < container_batch; ++i) {
+		#pragma HLS pipeline
+		Bench::erase(c, keys[i]);
+		results[i] = true;
+	}
+}
+
+template<typename Bench>
+void lookupKernel(typename Bench::type& c, const uint32_t keys[container_batch], bool results[container_batch]) {
+	#pragma HLS inline
+	ops: for (uint32_t i = 0; i < container_batch; ++i) {
+		#pragma HLS pipeline
+		results[i] = Bench::lookup(c, keys[i]);
+	}
+}
+
+template<typename Bench>
+void iterateKernel(typename Bench::type& c, const uint32_t*, bool results[container_batch]) {
+	#pragma HLS inline
+	results[0] = (Bench::iterate(c) != 0);
+}
+
+
+#define CONTAINER_BENCH_TOP(Prefix, Bench, Op) \
+	void Prefix##_##Op(const uint32_t keys[container_batch], bool results[container_batch]) { \
+		static Bench::type c; \
+		Op##Kernel<Bench>(c, keys, results); \
+	}
+
+#define CONTAINER_BENCH_TOPS(Prefix, Bench) \
+	CONTAINER_BENCH_TOP(Prefix, Bench, insert) \
+	CONTAINER_BENCH_TOP(Prefix, Bench, erase) \
+	CONTAINER_BENCH_TOP(Prefix, Bench, lookup) \
+	CONTAINER_BENCH_TOP(Prefix, Bench, iterate)
+
+using CuckooHashMap2Bench = CuckooHashMapBench<2>;
+using CuckooHashMap4Bench = CuckooHashMapBench<4>;
+
+CONTAINER_BENCH_TOPS(sparse_set,    SparseSetBench)
+CONTAINER_BENCH_TOPS(resource_pool, ResourcePoolBench)
+CONTAINER_BENCH_TOPS(binary_tree,   BinaryTreeBench)
+CONTAINER_BENCH_TOPS(binary_heap,   BinaryHeapBench)
+CONTAINER_BENCH_TOPS(cuckoo_map2,   CuckooHashMap2Bench)
+CONTAINER_BENCH_TOPS(cuckoo_map4,   CuckooHashMap4Bench)
+CONTAINER_BENCH_TOPS(linear_map,    LinearMapBench)
@@ -0,0 +1,98 @@
+#include "oblivious_sort.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+
+// Records of a 64-bit key and a payload derived from it, as in FPGASqrtORAM
+constexpr uint32_t RECORD_SIZE = 24;
+
+struct HostRecord {
+	uint8_t bytes[RECORD_SIZE];
+
+	uint64_t key() const {
+		uint64_t word;
+		std::memcpy(&word, bytes, sizeof(word));
+		return word;
+	}
+};
+
+
+std::vector<HostRecord> generateRecords(uint64_t count, uint64_t seed) {
+	std::vector<uint64_t> keys(count);
+	std::iota(keys.begin(), keys.end(), 0);
+	std::shuffle(keys.begin(), keys.end(), std::mt19937_64{seed});
+
+	std::vector<HostRecord> records(count);
+	for (uint64_t i = 0; i < count; ++i) {
+		const uint64_t key = keys[i] * 0x9E3779B97F4A7C15ull;  // distinct, spread over 64 bits
+		std::memcpy(records[i].bytes, &key, sizeof(key));
+		for (uint32_t b = sizeof(key); b < RECORD_SIZE; ++b) {
+			records[i].bytes[b] = static_cast<uint8_t>(key >> (b % 8 * 8)) ^ static_cast<uint8_t>(b);
+		}
+	}
+	return records;
+}
+
+
+// Sorts the records through the hardware engine, compares with std::sort
+// and returns the records per second of the engine, or 0 on a mismatch
+template<uint32_t ChunkRecords>
+double benchSorter(const std::vector<HostRecord>& input, int reps) {
+	std::vector<HostRecord> reference = input;
+	std::sort(reference.begin(), reference.end(), [](const HostRecord& a, const HostRecord& b) { return a.key() < b.key(); });
+
+	std::vector<HostRecord> data;
+	double seconds = 0;
+	for (int r = 0; r < reps; ++r) {
+		data = input;
+		const auto start = std::chrono::steady_clock::now();
+		ObliviousSorter<RECORD_SIZE, ChunkRecords>::sort(reinterpret_cast<uint8_t*>(data.data()), data.size());
+		seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	if (std::memcmp(data.data(), reference.data(), data.size() * sizeof(HostRecord)) != 0) {
+		std::cout << "  chunk " << ChunkRecords << ": MISMATCH with host reference" << std::endl;
+		return 0;
+	}
+	const double rate = reps * input.size() / seconds;
+	std::cout << "  chunk " << ChunkRecords << ": " << rate << " records/s, "
+	          << ObliviousSorter<RECORD_SIZE, ChunkRecords>::passes(input.size()) << " passes over memory" << std::endl;
+	return rate;
+}
+
+
+// Usage: oblivious_sort_bench [log2 record count] [repetitions]
+int main(int argc, char** argv) {
+	const unsigned log_count = (argc > 1) ? std::atoi(argv[1]) : 16;
+	const int reps = (argc > 2) ? std::atoi(argv[2]) : 3;
+	const uint64_t count = 1ull << log_count;
+
+	const std::vector<HostRecord> input = generateRecords(count, 0x50A7ull);
+	std::cout << "Oblivious sort of " << count << " records of " << RECORD_SIZE << " bytes" << std::endl;
+
+	bool ok = true;
+	ok &= benchSorter<1>(input, reps) > 0;
+	ok &= benchSorter<16>(input, reps) > 0;
+	ok &= benchSorter<64>(input, reps) > 0;
+	ok &= benchSorter<256>(input, reps) > 0;
+
+	// Host reference for scale
+	double seconds = 0;
+	for (int r = 0; r < reps; ++r) {
+		std::vector<HostRecord> data = input;
+		const auto start = std::chrono::steady_clock::now();
+		std::sort(data.begin(), data.end(), [](const HostRecord& a, const HostRecord& b) { return a.key() < b.key(); });
+		seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+	std::cout << "  std::sort: " << reps * count / seconds << " records/s" << std::endl;
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// Throughput of an ORAM shared by K concurrent clients through an ORAMArbiter,
+// with every client and the arbiter on a thread of their own. Requires the
+// threaded C simulation: -DFINN_THREADED_CSIM and the streams of ../sim.
+#include "oram_arbiter.h"
+#include "../dataflow.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#ifndef FINN_DATAFLOW_THREADED
+#error "The arbiter benchmark requires FINN_THREADED_CSIM"
+#endif
+
+
+using ORAM = FPGAPathORAM2<10, 64, 4>;
+constexpr uint32_t ACCESSES_PER_CLIENT = 2000;
+
+static ORAM g_oram;
+static uint8_t g_server_data[ORAM::server_size];
+
+
+// Every client reads random blocks of its own range and checks their content
+template<typename Arbiter>
+bool client(uint32_t id, uint32_t clients, hls::stream<typename Arbiter::Request>& requests, hls::stream<typename Arbiter::Response>& responses) {
+	ORAMArbiterPort<ORAM> port{requests, responses};
+	const uint64_t range = ORAM::block_count_N / 2 / clients;
+	std::mt19937_64 gen{id};
+	bool ok = true;
+
+	typename ORAM::Block block;
+	for (uint64_t blk = id * range; blk < (id + 1) * range; ++blk) {
+		block.fill(static_cast<uint8_t>(blk));
+		port.write(blk, block.data());
+	}
+	for (uint32_t i = 0; i < ACCESSES_PER_CLIENT; ++i) {
+		const uint64_t blk = id * range + gen() % range;
+		port.read(blk, block.data());
+		ok &= (block[0] == static_cast<uint8_t>(blk));
+	}
+	port.close();
+	return ok;
+}
+
+
+// Runs K clients against one arbiter; returns false on wrong data
+template<uint32_t ClientsK, typename Arbitration>
+bool benchArbiter(const char* policy) {
+	using Arbiter = ORAMArbiter<ORAM, ClientsK, Arbitration>;
+	g_oram.initRNG(0x6A510E8A2A376982ull);
+	g_oram.initServerMem(g_server_data);
+	Arbiter arbiter{g_oram};
+	bool ok[ClientsK];
+
+	const auto start = std::chrono::steady_clock::now();
+	{
+		FINN_DATAFLOW_REGION;
+		hls::stream<typename Arbiter::Request>  requests[ClientsK];
+		hls::stream<typename Arbiter::Response> responses[ClientsK];
+		for (uint32_t c = 0; c < ClientsK; ++c) {
+			finn::dataflow::spawn([&, c]() { ok[c] = client<Arbiter>(c, ClientsK, requests[c], responses[c]); });
+		}
+		FINN_DATAFLOW_STAGE(arbiter.serve(requests, responses, g_server_data));
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	uint64_t served = 0;
+	uint64_t min_waits = ~0ull;
+	uint64_t max_waits = 0;
+	bool all_ok = true;
+	for (uint32_t c = 0; c < ClientsK; ++c) {
+		const ORAMArbiterCounters& cnt = arbiter.counters(c);
+		served += cnt.served;
+		min_waits = std::min(min_waits, cnt.waits);
+		max_waits = std::max(max_waits, cnt.waits);
+		all_ok &= ok[c];
+	}
+
+	std::cout << std::left << std::setw(16) << policy << std::right << std::setw(8) << ClientsK
+	          << std::setw(16) << static_cast<uint64_t>(served / seconds)
+	          << std::setw(16) << static_cast<uint64_t>(served / seconds / ClientsK)
+	          << std::setw(12) << static_cast<double>(min_waits) / (served / ClientsK)
+	          << std::setw(12) << static_cast<double>(max_waits) / (served / ClientsK)
+	          << (all_ok ? "" : "  MISMATCH") << std::endl;
+	return all_ok;
+}
+
+
+int main() {
+	std::cout << std::left << std::setw(16) << "policy" << std::right << std::setw(8) << "clients"
+	          << std::setw(16) << "accesses/s" << std::setw(16) << "per client"
+	          << std::setw(12) << "min waits" << std::setw(12) << "max waits" << std::endl;
+
+	bool ok = true;
+	ok &= benchArbiter<1, RoundRobinArbitration>("round robin");
+	ok &= benchArbiter<2, RoundRobinArbitration>("round robin");
+	ok &= benchArbiter<4, RoundRobinArbitration>("round robin");
+	ok &= benchArbiter<8, RoundRobinArbitration>("round robin");
+	ok &= benchArbiter<2, FixedPriorityArbitration>("fixed priority");
+	ok &= benchArbiter<4, FixedPriorityArbitration>("fixed priority");
+	ok &= benchArbiter<8, FixedPriorityArbitration>("fixed priority");
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
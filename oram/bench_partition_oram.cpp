@@ -0,0 +1,137 @@
+// Partition ORAM against a single FPGAPathORAM2 over the same 1024 blocks.
+// The partitions of FPGAPartitionORAM have a memory each and run their path
+// accesses of a round in parallel, on a thread each in the threaded C
+// simulation (-DFINN_THREADED_CSIM and the streams of ../sim). Besides the
+// host throughput, which depends on the cores available, the benchmark
+// reports the buckets per request on the critical path (one path of the
+// big tree for FPGAPathORAM2, one partition path per round for the
+// partition ORAM) and in total, which set the hardware throughput with a
+// memory channel per partition.
+#include "partition_oram.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+constexpr uint32_t BLOCKS = 1024;
+constexpr uint32_t BLOCK_SIZE = 64;
+constexpr uint32_t REQUESTS = 8000;
+constexpr uint64_t RNG_INIT = 0x6A510E8A2A376982ull;
+
+
+struct BenchResult {
+	double   seconds;
+	uint64_t critical_buckets;  // buckets accessed one after the other
+	uint64_t total_buckets;     // buckets accessed over all memories
+	bool     ok;
+};
+
+
+void printResult(const char* name, uint32_t partitions, const BenchResult& r) {
+	std::cout << std::left << std::setw(16) << name << std::right << std::setw(12) << partitions
+	          << std::setw(16) << static_cast<uint64_t>(REQUESTS / r.seconds)
+	          << std::setw(16) << std::fixed << std::setprecision(2) << static_cast<double>(r.critical_buckets) / REQUESTS
+	          << std::setw(16) << static_cast<double>(r.total_buckets) / REQUESTS
+	          << (r.ok ? "" : "  MISMATCH") << std::endl;
+}
+
+
+// Batches of batch_size random reads and writes, checked against a reference
+template<typename Access>
+bool runRequests(uint32_t batch_size, Access access) {
+	std::mt19937_64 gen{0xBE7C};
+	std::vector<std::array<uint8_t, BLOCK_SIZE>> expected(BLOCKS);
+	std::vector<bool> written(BLOCKS, false);
+	bool ok = true;
+
+	for (uint32_t base = 0; base < REQUESTS; base += batch_size) {
+		std::vector<ORAMOp> ops(batch_size);
+		std::vector<uint32_t> blks(batch_size);
+		std::vector<std::array<uint8_t, BLOCK_SIZE>> buffers(batch_size);
+		std::vector<std::array<uint8_t, BLOCK_SIZE>> reads(batch_size);
+		for (uint32_t i = 0; i < batch_size; ++i) {
+			blks[i] = gen() % BLOCKS;
+			ops[i] = (!written[blks[i]] || (gen() % 4 == 0)) ? ORAMOp::Write : ORAMOp::Read;
+			if (ops[i] == ORAMOp::Write) {
+				expected[blks[i]].fill(static_cast<uint8_t>(base + i));
+				written[blks[i]] = true;
+				buffers[i] = expected[blks[i]];
+			}
+			else {
+				reads[i] = expected[blks[i]];
+			}
+		}
+		access(ops.data(), blks.data(), buffers.data());
+		for (uint32_t i = 0; i < batch_size; ++i) {
+			ok &= (ops[i] != ORAMOp::Read) || (buffers[i] == reads[i]);
+		}
+	}
+	return ok;
+}
+
+
+template<uint8_t HeightL>
+BenchResult benchPathORAM() {
+	using ORAM = FPGAPathORAM2<HeightL, BLOCK_SIZE, 4>;
+	static ORAM oram;
+	static uint8_t server_data[ORAM::server_size];
+	oram.initRNG(RNG_INIT);
+	oram.initServerMem(server_data);
+
+	const auto start = std::chrono::steady_clock::now();
+	const bool ok = runRequests(1, [&](const ORAMOp* ops, const uint32_t* blks, std::array<uint8_t, BLOCK_SIZE>* data) {
+		oram.access(ops[0], blks[0], data[0].data(), server_data);
+	});
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const uint64_t buckets = static_cast<uint64_t>(REQUESTS) * (HeightL + 1);
+	return {seconds, buckets, buckets, ok};
+}
+
+
+template<uint32_t PartitionsP, uint8_t PartitionHeightL>
+BenchResult benchPartitionORAM() {
+	using ORAM = FPGAPartitionORAM<BLOCKS, PartitionsP, PartitionHeightL, BLOCK_SIZE>;
+	static ORAM oram;
+	static uint8_t partition_mem[PartitionsP][ORAM::partition_server_size];
+	uint8_t* partition_data[PartitionsP];
+	for (uint32_t p = 0; p < PartitionsP; ++p) partition_data[p] = partition_mem[p];
+	oram.initRNG(RNG_INIT);
+	oram.initServerMem(partition_data);
+
+	const auto start = std::chrono::steady_clock::now();
+	const bool ok = runRequests(PartitionsP, [&](const ORAMOp* ops, const uint32_t* blks, std::array<uint8_t, BLOCK_SIZE>* data) {
+		typename ORAM::client_block_id ids[PartitionsP];
+		uint8_t* ptrs[PartitionsP];
+		for (uint32_t i = 0; i < PartitionsP; ++i) {
+			ids[i] = blks[i];
+			ptrs[i] = data[i].data();
+		}
+		oram.accessBatch(PartitionsP, ops, ids, ptrs, partition_data);
+	});
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const uint64_t rounds = oram.counters().rounds;
+	return {seconds, rounds * (PartitionHeightL + 1), rounds * PartitionsP * (PartitionHeightL + 1), ok};
+}
+
+
+int main() {
+	std::cout << std::left << std::setw(16) << "ORAM" << std::right << std::setw(12) << "partitions"
+	          << std::setw(16) << "requests/s" << std::setw(16) << "critical bkts" << std::setw(16) << "total bkts" << std::endl;
+
+	// Trees of about twice as many block slots as blocks
+	BenchResult r;
+	bool ok = true;
+	r = benchPathORAM<8>();          printResult("path", 1, r);      ok &= r.ok;
+	r = benchPartitionORAM<2, 7>();  printResult("partition", 2, r); ok &= r.ok;
+	r = benchPartitionORAM<4, 6>();  printResult("partition", 4, r); ok &= r.ok;
+	r = benchPartitionORAM<8, 5>();  printResult("partition", 8, r); ok &= r.ok;
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
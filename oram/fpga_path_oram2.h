@@ -11,15 +11,22 @@
 
 #include "memory/fpga_resource_pool.h"
 #include "memory/ap_array.h"
+#include "position_map.h"
 #include "util.h"
 
 
 enum class ORAMOp : uint8_t {
-	Read  = 0,
-	Write = 1
+	Read   = 0,
+	Write  = 1,
+	Remove = 2   // Read and remove the block, e.g. to move it to another ORAM
 };
 
-template<uint8_t HeightL, uint32_t BlockSizeB, uint8_t BucketSizeZ = 4>
+// PositionMapMode selects how block leaves are kept: RandomLeaves stores a
+// random leaf per block, PRFLeaves<CounterBits, GroupSize> only per-block and
+// per-group access counters from which the leaf is derived with a keyed hash.
+// ServerPtr is the type of the server memory pointer, e.g. a
+// finn::dram::ModeledPtr<uint8_t> to estimate DRAM timing in C simulation.
+template<uint8_t HeightL, uint32_t BlockSizeB, uint8_t BucketSizeZ = 4, typename PositionMapMode = RandomLeaves, typename ServerPtr = uint8_t*>
 class FPGAPathORAM2 {
 public:
 	static constexpr uint64_t bucket_count  = (1ull << (HeightL + 1)) - 1;
@@ -27,9 +34,12 @@ public:
 	static constexpr uint32_t block_size_B  = BlockSizeB;
 	static constexpr uint8_t  bucket_size_Z = BucketSizeZ;
 	static constexpr uint64_t block_count_N = BucketSizeZ * bucket_count;
+	static constexpr uint64_t server_size   = block_count_N * (sizeof(uint64_t) + BlockSizeB);
+
+	using PositionMap = typename PositionMapMode::template map<block_count_N, HeightL>;
 
 	// An integer with the least number of bits required to address all blocks
-	using client_block_id = ap_uint<util::ceil_int_log2(block_count_N)>;
+	using client_block_id = typename PositionMap::block_id;
 
 	// An integer with the least number of bits required to address all buckets
 	using client_bucket_id = ap_uint<util::ceil_int_log2(bucket_count)>;
@@ -54,7 +64,7 @@ public:
 		rng = xorshift64{rng_init};
 	}
 
-	void initServerMem(uint8_t* server_data) {
+	void initServerMem(ServerPtr server_data) {
 		const uint64_t id_size = SIZEOF_MEMBER(IDBlock, id);
 
 		for (uint64_t block = 0; block < block_count_N; ++block) {
@@ -66,27 +76,51 @@ public:
 				*(server_data + offset + i) = static_cast<uint8_t>(IDBlock::invalid_block >> (i*8));
 			}
 		}
-		for (uint64_t i = 0; i < block_count_N; ++i) {
-			position_map[i] = randomPath();
-		}
+		position_map.init(rng);
+	}
+
+	const PositionMap& positionMap() const noexcept {
+		return position_map;
 	}
 
-	void read(client_block_id blk, uint8_t* blk_data, uint8_t* server_data) {
+	PositionMap& positionMap() noexcept {
+		return position_map;
+	}
+
+	void read(client_block_id blk, uint8_t* blk_data, ServerPtr server_data) {
 		access(ORAMOp::Read, blk, blk_data, server_data);
 	}
 
-	void write(client_block_id blk, const uint8_t* blk_data, uint8_t* server_data) {
+	void write(client_block_id blk, const uint8_t* blk_data, ServerPtr server_data) {
 		access(ORAMOp::Write, blk, const_cast<uint8_t*>(blk_data), server_data); //won't actually modify b
 	}
 
-	void access(ORAMOp op, client_block_id blk, uint8_t* blk_data, uint8_t* server_data) {
-		const client_leaf_id leaf = position_map[blk];
-		position_map[blk] = randomPath();
+	// Refused, leaving blk_data untouched, once the position map is exhausted
+	void access(ORAMOp op, client_block_id blk, uint8_t* blk_data, ServerPtr server_data) {
+		if (position_map.exhausted()) {
+			return;
+		}
+		accessPath(op, blk, position_map.remap(blk, rng), blk_data, server_data);
 
+		// Re-place the blocks whose leaves changed along with blk's
+		for (uint32_t i = 0; i < PositionMap::max_moves; ++i) {
+			client_block_id moved;
+			if (!position_map.nextMove(moved)) {
+				break;
+			}
+			evictPath(position_map.move(moved), server_data);
+		}
+	}
+
+	// Accesses a block along the path of the given leaf, for front-ends that
+	// manage the leaves themselves (see SharedLeaves). The leaf must be the
+	// block's current one, or a random one if the block is not in this ORAM.
+	void accessPath(ORAMOp op, client_block_id blk, client_leaf_id leaf, uint8_t* blk_data, ServerPtr server_data) {
 		readPath(leaf, server_data);
 
 		switch (op) {
-			case ORAMOp::Read: {
+			case ORAMOp::Read:
+			case ORAMOp::Remove: {
 				if (stash.contains(blk)) {
 					const auto& stash_block = stash.at(blk);
 					//memcpy(blk_data, stash_block.data(), BlockSizeB);
@@ -94,6 +128,9 @@ public:
 						#pragma HLS pipeline
 						blk_data[i] = stash_block[i];
 					}
+					if (op == ORAMOp::Remove) {
+						stash.erase(blk);
+					}
 				}
 				break;
 			}
@@ -118,9 +155,21 @@ public:
 		writePath(leaf, server_data);
 	}
 
+	// Reads and writes back the path of a leaf without accessing any block,
+	// as a dummy access or to evict stashed blocks
+	void evictPath(client_leaf_id leaf, ServerPtr server_data) {
+		readPath(leaf, server_data);
+		writePath(leaf, server_data);
+	}
+
+	client_leaf_id randomLeaf() {
+		#pragma HLS inline
+		return rng.generate() % (1ull << HeightL);
+	}
+
 private:
 
-	void readPath(client_leaf_id leaf, uint8_t* server_data) {
+	void readPath(client_leaf_id leaf, ServerPtr server_data) {
 		for (uint8_t l = 0; l <= HeightL; ++l) {
 			Bucket bucket;
 			readBucket(bucket, getNodeOnPath(leaf, l), server_data);
@@ -128,7 +177,7 @@ private:
 		}
 	}
 
-	void writePath(client_leaf_id leaf, uint8_t* server_data) {
+	void writePath(client_leaf_id leaf, ServerPtr server_data) {
 		for (int16_t l = HeightL; l >= 0; --l) {
 			const client_bucket_id node = getNodeOnPath(leaf, static_cast<uint8_t>(l));
 
@@ -148,7 +197,7 @@ private:
 		for (auto it = stash.handles().begin(); it != stash.handles().end(); ++it) {
 			const client_block_id block_id = it.access(stash.handles());
 
-			if (getNodeOnPath(position_map[block_id], height) == node) {
+			if (getNodeOnPath(position_map.leaf(block_id), height) == node) {
 				valid_blocks[valid_idx] = block_id;
 				valid_idx++;
 			}
@@ -197,7 +246,7 @@ private:
 		}
 	}
 
-	void readBucket(Bucket& out, client_bucket_id index, uint8_t* server_data) {
+	void readBucket(Bucket& out, client_bucket_id index, ServerPtr server_data) {
 		#pragma HLS inline
 		const uint64_t block_idx = static_cast<uint64_t>(index) * BucketSizeZ;
 		for (uint8_t i = 0; i < BucketSizeZ; ++i) {
@@ -206,7 +255,7 @@ private:
 		}
 	}
 
-	void writeBucket(const Bucket& in, client_bucket_id index, uint8_t* server_data) {
+	void writeBucket(const Bucket& in, client_bucket_id index, ServerPtr server_data) {
 		#pragma HLS inline
 		const uint64_t block_idx = static_cast<uint64_t>(index) * BucketSizeZ;
 		for (uint8_t i = 0; i < BucketSizeZ; ++i) {
@@ -216,7 +265,7 @@ private:
 	}
 
 
-	void readBlock(IDBlock& out, uint64_t index, uint8_t* server_data) {
+	void readBlock(IDBlock& out, uint64_t index, ServerPtr server_data) {
 		const uint64_t id_size = SIZEOF_MEMBER(IDBlock, id);
 		const uint64_t offset = index * (id_size + BlockSizeB);
 
@@ -235,7 +284,7 @@ private:
 		
 	}
 
-	void writeBlock(const IDBlock& in, uint64_t index, uint8_t* server_data) {
+	void writeBlock(const IDBlock& in, uint64_t index, ServerPtr server_data) {
 		const uint64_t id_size = SIZEOF_MEMBER(IDBlock, id);
 		const uint64_t offset = index * (id_size + BlockSizeB);
 
@@ -253,13 +302,7 @@ private:
 		
 	}
 
-	client_leaf_id randomPath() {
-		#pragma HLS inline
-		return rng.generate() % (1ull << HeightL);
-	}
-
-
-	client_leaf_id position_map[block_count_N];
+	PositionMap position_map;
 	ResourcePool<client_block_id, Block, (util::ceil_int_log2(block_count_N) << 2)> stash; //size: HeightL * BucketSizeZ ?
 
 	xorshift64 rng;
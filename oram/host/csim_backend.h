@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "../top.h"
+#include "oram_driver.h"
+
+
+// C simulation stand-in for the hardware side of ORAMHostQueues: a worker
+// thread pops the requests, runs ORAMController on each of them and pushes
+// the completions, so that host code using ORAMHostDriver runs unchanged
+// against the simulated controller.
+//
+// The ORAM must have been initialized, and ORAMController must not be called
+// from elsewhere while the backend runs. The destructor serves the requests
+// still queued, then stops the worker; as it has to push their completions,
+// the host must not leave more than QueueDepth requests uncollected then.
+template<uint32_t QueueDepth = 64>
+class ORAMCSimBackend {
+public:
+	using Queues = ORAMHostQueues<ORAM_BLOCK_SIZE, QueueDepth>;
+
+
+	ORAMCSimBackend(Queues& queues, uint8_t* server_data)
+		: queues(queues), server_data(server_data), worker(&ORAMCSimBackend::serve, this) {}
+
+	ORAMCSimBackend(const ORAMCSimBackend&) = delete;
+
+	~ORAMCSimBackend() {
+		stop = true;
+		worker.join();
+	}
+
+	// Requests served so far
+	uint64_t served() const noexcept {
+		return served_cnt.load();
+	}
+
+private:
+
+	void serve() {
+		typename Queues::Request req;
+		typename Queues::Completion completion;
+		while (true) {
+			if (!queues.requests.pop(req)) {
+				if (stop) return;
+				std::this_thread::yield();
+				continue;
+			}
+
+			ORAMController(static_cast<uint32_t>(ProgramMode::AccessORAM), static_cast<uint32_t>(req.op),
+			               req.block_addr, req.data, server_data);
+
+			completion.tag = req.tag;
+			std::memcpy(completion.data, req.data, ORAM_BLOCK_SIZE);
+			while (!queues.completions.push(completion)) {
+				std::this_thread::yield();
+			}
+			served_cnt++;
+		}
+	}
+
+
+	Queues& queues;
+	uint8_t* const server_data;
+	std::atomic<bool> stop{false};
+	std::atomic<uint64_t> served_cnt{0};
+	std::thread worker;  // last, so that it starts on an initialized backend
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+
+#include "spsc_ring.h"
+#include "../fpga_path_oram2.h"
+
+
+// Request and completion queues between the host and an ORAM controller.
+//
+// The host pushes requests and pops completions, the controller does the
+// opposite; a completion carries the tag of its request and, for reads, the
+// block data. The queues are plain memory, to be placed in a region shared
+// with the controller, e.g.
+//   auto* queues = new (shm_base) ORAMHostQueues<ORAM_BLOCK_SIZE>;
+template<uint32_t BlockSizeB, uint32_t QueueDepth = 64>
+struct ORAMHostQueues {
+	struct Request {
+		uint64_t tag;
+		uint64_t block_addr;
+		ORAMOp   op;
+		uint8_t  data[BlockSizeB];  // written data, unused for reads
+	};
+
+	struct Completion {
+		uint64_t tag;
+		uint8_t  data[BlockSizeB];  // read data, unused for writes
+	};
+
+	static constexpr uint32_t block_size_B = BlockSizeB;
+	static constexpr uint32_t queue_depth  = QueueDepth;
+
+	SPSCRing<Request, QueueDepth>    requests;
+	SPSCRing<Completion, QueueDepth> completions;
+};
+
+
+// Asynchronous host interface of an ORAM controller serving ORAMHostQueues.
+//
+// submit() queues a request and returns its tag without waiting for the
+// controller, so that many requests can be in flight while the host does
+// other work. Completions are collected with poll(), or waited for by tag
+// with wait(); completions that arrive while waiting for another tag are
+// kept until they are polled or waited for. The controller serves the
+// requests in order, but callers should only rely on the tags.
+//
+// A driver is the only producer of the requests and the only consumer of the
+// completions of its queues, and is not thread-safe itself.
+template<typename Queues>
+class ORAMHostDriver {
+public:
+	using Request    = typename Queues::Request;
+	using Completion = typename Queues::Completion;
+
+	static constexpr uint32_t block_size_B = Queues::block_size_B;
+
+
+	explicit ORAMHostDriver(Queues& queues) : queues(queues) {}
+
+	ORAMHostDriver(const ORAMHostDriver&) = delete;
+
+	// Queues a request unless the request queue is full; blk_data is only read, and only for writes
+	bool trySubmit(ORAMOp op, uint64_t blk, const uint8_t* blk_data, uint64_t& tag) {
+		Request req;
+		req.tag = next_tag;
+		req.block_addr = blk;
+		req.op = op;
+		if (op == ORAMOp::Write) {
+			std::memcpy(req.data, blk_data, block_size_B);
+		}
+		if (!queues.requests.push(req)) {
+			return false;
+		}
+		tag = next_tag++;
+		return true;
+	}
+
+	// Queues a request, collecting completions while the request queue is full
+	uint64_t submit(ORAMOp op, uint64_t blk, const uint8_t* blk_data) {
+		uint64_t tag;
+		while (!trySubmit(op, blk, blk_data, tag)) {
+			if (!collect()) std::this_thread::yield();
+		}
+		return tag;
+	}
+
+	uint64_t submitRead(uint64_t blk) {
+		return submit(ORAMOp::Read, blk, nullptr);
+	}
+
+	uint64_t submitWrite(uint64_t blk, const uint8_t* blk_data) {
+		return submit(ORAMOp::Write, blk, blk_data);
+	}
+
+	// Takes any available completion; returns false if there is none
+	bool poll(Completion& completion) {
+		if (!parked.empty()) {
+			const auto it = parked.begin();
+			completion = it->second;
+			parked.erase(it);
+		}
+		else if (!queues.completions.pop(completion)) {
+			return false;
+		}
+		completed++;
+		return true;
+	}
+
+	// Waits for the completion of tag and copies its block data, if blk_data is given
+	void wait(uint64_t tag, uint8_t* blk_data = nullptr) {
+		auto it = parked.find(tag);
+		while (it == parked.end()) {
+			if (!collect()) std::this_thread::yield();
+			it = parked.find(tag);
+		}
+		if (blk_data) {
+			std::memcpy(blk_data, it->second.data, block_size_B);
+		}
+		parked.erase(it);
+		completed++;
+	}
+
+	// Requests submitted and not yet returned by poll() or wait()
+	uint64_t inFlight() const noexcept {
+		return next_tag - completed;
+	}
+
+private:
+
+	// Moves a completion from the queue to the parked ones; returns false if there was none
+	bool collect() {
+		Completion completion;
+		if (!queues.completions.pop(completion)) {
+			return false;
+		}
+		parked[completion.tag] = completion;
+		return true;
+	}
+
+
+	Queues& queues;
+	uint64_t next_tag  = 0;
+	uint64_t completed = 0;
+	std::unordered_map<uint64_t, Completion> parked;
+};
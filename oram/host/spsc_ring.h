@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+
+// Lock-free ring buffer between a single producer and a single consumer.
+//
+// The ring holds its slots inline and no pointers, so it can be placed in
+// memory shared by two processes (or by the host and a device) with placement
+// new. The producer only writes tail, the consumer only head; both indices run
+// freely and are reduced modulo Capacity on access, so that all Capacity slots
+// can be used.
+template<typename T, uint32_t Capacity>
+class SPSCRing {
+	static_assert((Capacity != 0) && ((Capacity & (Capacity - 1)) == 0), "Capacity must be a power of two");
+	static_assert(std::is_trivially_copyable<T>::value, "Ring elements are copied as plain memory");
+	static_assert(ATOMIC_INT_LOCK_FREE == 2, "Shared memory rings require lock-free atomics");
+
+public:
+	static constexpr uint32_t capacity = Capacity;
+
+	SPSCRing() = default;
+	SPSCRing(const SPSCRing&) = delete;
+
+	// Producer side; returns false if the ring is full
+	bool push(const T& item) {
+		const uint32_t tail = tail_idx.load(std::memory_order_relaxed);
+		if (tail - head_idx.load(std::memory_order_acquire) == Capacity) {
+			return false;
+		}
+		slots[tail % Capacity] = item;
+		tail_idx.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side; returns false if the ring is empty
+	bool pop(T& item) {
+		const uint32_t head = head_idx.load(std::memory_order_relaxed);
+		if (head == tail_idx.load(std::memory_order_acquire)) {
+			return false;
+		}
+		item = slots[head % Capacity];
+		head_idx.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Approximate while the other side is active
+	uint32_t size() const noexcept {
+		return tail_idx.load(std::memory_order_acquire) - head_idx.load(std::memory_order_acquire);
+	}
+
+	bool empty() const noexcept {
+		return size() == 0;
+	}
+
+	bool full() const noexcept {
+		return size() == Capacity;
+	}
+
+private:
+	// On separate cache lines, so that producer and consumer do not contend
+	alignas(64) std::atomic<uint32_t> head_idx{0};
+	alignas(64) std::atomic<uint32_t> tail_idx{0};
+	alignas(64) T slots[Capacity];
+};
@@ -359,7 +359,7 @@ private:
 		while ((leaf < num_elements) && !equal(key, data[leaf].key())) {
 			leaf += less(key, data[leaf].key()) ? (leaf + 1) : (leaf + 2);
 		}
-		return (leaf < num_elements) ? leaf : num_elements;
+		return (leaf < num_elements) ? leaf : size_type(num_elements);
 	}
 
 	// Find the first element that has a matching key or an invalid key
@@ -370,7 +370,7 @@ private:
 		while ((leaf < num_elements) && !equal(key, data[leaf].key()) && data[leaf].valid) {
 			leaf += less(key, data[leaf].key()) ? (leaf + 1) : (leaf + 2);
 		}
-		return (leaf < num_elements) ? leaf : num_elements;
+		return (leaf < num_elements) ? leaf : size_type(num_elements);
 	}
 
 	size_type find_min(size_type leaf) const {
@@ -0,0 +1,386 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include <ap_int.h>
+#include "../util.h"
+#include "ap_array.h"
+
+
+template<typename MapT, bool ConstIter>
+class cuckoo_map_iterator {
+	friend MapT;
+
+	using map_type = typename std::conditional<ConstIter, const MapT, MapT>::type;
+
+public:
+	using difference_type   = typename map_type::difference_type;
+	using size_type         = typename map_type::size_type;
+	using value_type        = typename std::conditional<ConstIter, const typename map_type::value_type, typename map_type::value_type>::type;
+	using pointer           = typename std::conditional<ConstIter, typename map_type::const_pointer, typename map_type::pointer>::type;
+	using reference         = typename std::conditional<ConstIter, typename map_type::const_reference, typename map_type::reference>::type;
+
+private:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	cuckoo_map_iterator(difference_type idx) : slot(idx) {
+		#pragma HLS inline
+	}
+
+public:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	cuckoo_map_iterator() = default;
+	cuckoo_map_iterator(const cuckoo_map_iterator&) = default;
+	cuckoo_map_iterator(cuckoo_map_iterator&&) noexcept = default;
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~cuckoo_map_iterator() = default;
+
+	//----------------------------------------------------------------------------------
+	// Operators - Assignment
+	//----------------------------------------------------------------------------------
+	cuckoo_map_iterator& operator=(const cuckoo_map_iterator&) = default;
+	cuckoo_map_iterator& operator=(cuckoo_map_iterator&&) noexcept = default;
+
+	//----------------------------------------------------------------------------------
+	// Operators - Access
+	//----------------------------------------------------------------------------------
+	reference access(map_type& map) const {
+		#pragma HLS inline
+		return map.slot_ref(slot).kv_pair;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Operators - Arithmetic
+	//----------------------------------------------------------------------------------
+	cuckoo_map_iterator& increment(map_type& map) {
+		slot = map.next_valid(slot + 1);
+		return *this;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Operators - Equality
+	//----------------------------------------------------------------------------------
+	bool operator==(const cuckoo_map_iterator& other) const noexcept {
+		#pragma HLS inline
+		return other.slot == slot;
+	}
+
+	bool operator!=(const cuckoo_map_iterator& other) const noexcept {
+		#pragma HLS inline
+		return !(*this == other);
+	}
+
+private:
+
+	difference_type slot;
+};
+
+
+// Cuckoo hash map of TableCount tables of BucketCount single-slot buckets and
+// a stash of StashSize slots, for integral keys (built-in or ap_uint).
+//
+// Every key has one candidate bucket per table, given by a multiplicative
+// hash of its own. The tables are partitioned into separate memories, so a
+// lookup reads all candidate buckets and compares the stash in parallel: its
+// latency is constant and lookups can be pipelined at II=1. An insert places
+// the key in a free candidate bucket or evicts the occupant of one, which
+// then takes a free candidate bucket of its own or evicts in turn, for at
+// most MaxKicks evictions; a key left without a bucket goes to the stash. An insert fails,
+// without changing the map, only if all candidate buckets and the stash are
+// taken. Iteration order is unspecified.
+template<typename KeyT, typename ValueT, size_t BucketCount, size_t TableCount = 2, size_t StashSize = 4, size_t MaxKicks = 16>
+class CuckooHashMap {
+	static_assert((BucketCount >= 2) && ((BucketCount & (BucketCount - 1)) == 0), "BucketCount must be a power of two");
+	static_assert((TableCount >= 2) && (TableCount <= 4), "CuckooHashMap supports 2 to 4 tables");
+
+	template<typename, bool>
+	friend class cuckoo_map_iterator;
+
+	static constexpr size_t slot_count = TableCount * BucketCount + StashSize;
+
+	// The minimum width integer required to represent the number of slots in the container
+	using slot_id   = ap_uint<util::ceil_int_log2(slot_count + 1)>;
+	using bucket_id = ap_uint<util::ceil_int_log2(BucketCount)>;
+
+public:
+
+	using key_type        = KeyT;
+	using mapped_type     = ValueT;
+	using value_type      = std::pair<KeyT, ValueT>;
+	using pointer         = value_type*;
+	using const_pointer   = const value_type*;
+	using reference       = value_type&;
+	using const_reference = const value_type&;
+	using size_type       = slot_id;
+	using difference_type = ap_int<slot_id::width + 1>;
+
+	using iterator       = cuckoo_map_iterator<CuckooHashMap<KeyT, ValueT, BucketCount, TableCount, StashSize, MaxKicks>, false>;
+	using const_iterator = cuckoo_map_iterator<CuckooHashMap<KeyT, ValueT, BucketCount, TableCount, StashSize, MaxKicks>, true>;
+
+	static constexpr size_t table_count  = TableCount;
+	static constexpr size_t bucket_count = BucketCount;
+	static constexpr size_t stash_size   = StashSize;
+	static constexpr size_t capacity     = slot_count;
+
+private:
+
+	static constexpr size_t invalid_slot = slot_count;
+
+	struct Slot {
+		ap_uint<1> valid = false;
+		value_type kv_pair;
+	};
+
+	using table_type = ap_array<Slot, BucketCount>;
+	using stash_type = ap_array<Slot, StashSize>;
+
+public:
+
+	CuckooHashMap() {
+		#pragma HLS array_partition variable=tables dim=1 complete
+		#pragma HLS array_partition variable=stash complete
+	}
+
+	std::pair<iterator, bool> insert(const value_type& value) {
+		const slot_id existing = find_slot(value.first);
+		if (existing != invalid_slot) {
+			return {make_iterator(existing), false};
+		}
+
+		// Place the key in a free candidate bucket, if any
+		const slot_id free_slot = free_candidate(value.first);
+		if (free_slot != invalid_slot) {
+			fill(slot_ref(free_slot), value);
+			++count;
+			return {make_iterator(free_slot), true};
+		}
+
+		// Evicting needs room in the stash for a key that ends up without a bucket
+		const slot_id stash_slot = free_stash_slot();
+		if (stash_slot == invalid_slot) {
+			return {end(), false};
+		}
+
+		// Evict the occupant of a candidate bucket, taking the tables in turn,
+		// until the evicted key finds a free candidate bucket of its own
+		value_type homeless = value;
+		for (size_t kick = 0; kick < MaxKicks; ++kick) {
+			const size_t table = kick % TableCount;
+			Slot& slot = tables[table][hash(table, homeless.first)];
+			const value_type evicted = slot.kv_pair;
+			slot.kv_pair = homeless;
+			homeless = evicted;
+			++kicks;
+
+			const slot_id home = free_candidate(homeless.first);
+			if (home != invalid_slot) {
+				fill(slot_ref(home), homeless);
+				++count;
+				return {find(value.first), true};
+			}
+		}
+
+		fill(slot_ref(stash_slot), homeless);
+		++count;
+		return {find(value.first), true};
+	}
+
+	template<typename... ArgsT>
+	std::pair<iterator, bool> emplace(const key_type& key, ArgsT&&... args) {
+		#pragma HLS inline
+		return insert(value_type(key, mapped_type(std::forward<ArgsT>(args)...)));
+	}
+
+	void erase(const key_type& key) {
+		const slot_id id = find_slot(key);
+		if (id == invalid_slot) return;
+		slot_ref(id).valid = false;
+		--count;
+	}
+
+	void clear() {
+		for (size_t i = 0; i < BucketCount; ++i) {
+			#pragma HLS pipeline
+			for (size_t t = 0; t < TableCount; ++t) {
+				#pragma HLS unroll
+				tables[t][i].valid = false;
+			}
+		}
+		for (size_t s = 0; s < StashSize; ++s) {
+			#pragma HLS unroll
+			stash[s].valid = false;
+		}
+		count = 0;
+	}
+
+	bool contains(const key_type& key) const {
+		#pragma HLS inline
+		return find_slot(key) != invalid_slot;
+	}
+
+	mapped_type& at(const key_type& key) {
+		#pragma HLS inline
+		assert(contains(key));
+		return slot_ref(find_slot(key)).kv_pair.second;
+	}
+
+	const mapped_type& at(const key_type& key) const {
+		#pragma HLS inline
+		assert(contains(key));
+		return slot_ref(find_slot(key)).kv_pair.second;
+	}
+
+	iterator find(const key_type& key) {
+		#pragma HLS inline
+		return make_iterator(find_slot(key));
+	}
+
+	const_iterator find(const key_type& key) const {
+		#pragma HLS inline
+		return make_const_iterator(find_slot(key));
+	}
+
+	iterator begin() {
+		#pragma HLS inline
+		return make_iterator(next_valid(0));
+	}
+
+	const_iterator begin() const {
+		#pragma HLS inline
+		return make_const_iterator(next_valid(0));
+	}
+
+	iterator end() noexcept {
+		#pragma HLS inline
+		return make_iterator(invalid_slot);
+	}
+
+	const_iterator end() const noexcept {
+		#pragma HLS inline
+		return make_const_iterator(invalid_slot);
+	}
+
+	size_type size() const noexcept {
+		return count;
+	}
+
+	bool empty() const noexcept {
+		return count == 0;
+	}
+
+	// Keys currently in the stash
+	size_type stash_count() const {
+		size_type n = 0;
+		for (size_t s = 0; s < StashSize; ++s) {
+			#pragma HLS unroll
+			n += stash[s].valid;
+		}
+		return n;
+	}
+
+	// Evictions performed by all inserts so far
+	uint64_t kick_count() const noexcept {
+		return kicks;
+	}
+
+private:
+
+	iterator make_iterator(size_type slot) {
+		#pragma HLS inline
+		return iterator{static_cast<difference_type>(slot)};
+	}
+
+	const_iterator make_const_iterator(size_type slot) const {
+		#pragma HLS inline
+		return const_iterator{static_cast<difference_type>(slot)};
+	}
+
+	static bucket_id hash(size_t table, const key_type& key) {
+		#pragma HLS inline
+		// Odd multipliers of multiplicative hashing, one per table
+		static const uint64_t multipliers[4] = {
+			0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0xD6E8FEB86659FD93ull
+		};
+		const uint64_t product = static_cast<uint64_t>(key) * multipliers[table];
+		return static_cast<bucket_id>(product >> (64 - util::ceil_int_log2(BucketCount)));
+	}
+
+	// All candidate buckets and the stash are compared in parallel
+	slot_id find_slot(const key_type& key) const {
+		#pragma HLS inline
+		slot_id found = invalid_slot;
+		for (size_t t = 0; t < TableCount; ++t) {
+			#pragma HLS unroll
+			const bucket_id bucket = hash(t, key);
+			const Slot& slot = tables[t][bucket];
+			if (slot.valid && (slot.kv_pair.first == key)) found = t * BucketCount + bucket;
+		}
+		for (size_t s = 0; s < StashSize; ++s) {
+			#pragma HLS unroll
+			if (stash[s].valid && (stash[s].kv_pair.first == key)) found = TableCount * BucketCount + s;
+		}
+		return found;
+	}
+
+	// A free candidate bucket of the key, or invalid_slot
+	slot_id free_candidate(const key_type& key) const {
+		#pragma HLS inline
+		slot_id free_slot = invalid_slot;
+		for (size_t t = TableCount; t > 0; --t) {
+			#pragma HLS unroll
+			const bucket_id bucket = hash(t-1, key);
+			if (!tables[t-1][bucket].valid) free_slot = (t-1) * BucketCount + bucket;
+		}
+		return free_slot;
+	}
+
+	slot_id free_stash_slot() const {
+		#pragma HLS inline
+		slot_id free_slot = invalid_slot;
+		for (size_t s = StashSize; s > 0; --s) {
+			#pragma HLS unroll
+			if (!stash[s-1].valid) free_slot = TableCount * BucketCount + (s-1);
+		}
+		return free_slot;
+	}
+
+	// The first valid slot from slot on, or invalid_slot
+	difference_type next_valid(difference_type slot) const {
+		while ((slot < static_cast<difference_type>(invalid_slot)) && !slot_ref(slot).valid) {
+			++slot;
+		}
+		return slot;
+	}
+
+	Slot& slot_ref(size_type slot) {
+		#pragma HLS inline
+		return (slot < TableCount * BucketCount) ? tables[slot / BucketCount][slot % BucketCount] : stash[slot - TableCount * BucketCount];
+	}
+
+	const Slot& slot_ref(size_type slot) const {
+		#pragma HLS inline
+		return (slot < TableCount * BucketCount) ? tables[slot / BucketCount][slot % BucketCount] : stash[slot - TableCount * BucketCount];
+	}
+
+	static void fill(Slot& slot, const value_type& value) {
+		#pragma HLS inline
+		slot.valid = true;
+		slot.kv_pair = value;
+	}
+
+
+	ap_array<table_type, TableCount> tables;
+	stash_type stash;
+	size_type  count = 0;
+	uint64_t   kicks = 0;
+};
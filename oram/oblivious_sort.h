@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+#include "memory/ap_array.h"
+#include "util.h"
+
+
+// Bitonic sort of fixed-size records in external memory (e.g. server_data),
+// with an access pattern that depends on the record count only.
+//
+// Records are RecordSizeB bytes, sorted ascending by the little-endian 64-bit
+// word in their first 8 bytes; the count must be a power of two. The network
+// is split at ChunkRecords:
+//  - chunk passes load ChunkRecords consecutive records on chip in one burst,
+//    run all the stages whose compare distance lies within the chunk through
+//    an on-chip sorting network and write the chunk back in one burst,
+//  - merge passes handle the stages of larger distance, streaming pairs of
+//    chunks that lie that distance apart.
+// A sort of n records thus takes log2(n/C) * (log2(n/C) + 1) / 2 merge passes
+// and log2(n/C) + 1 chunk passes over the data, with C = ChunkRecords.
+template<uint32_t RecordSizeB, uint32_t ChunkRecords = 64>
+class ObliviousSorter {
+	static_assert(RecordSizeB >= sizeof(uint64_t), "Records must hold a 64-bit key");
+	static_assert((ChunkRecords & (ChunkRecords - 1)) == 0, "ChunkRecords must be a power of two");
+
+public:
+	static constexpr uint32_t record_size   = RecordSizeB;
+	static constexpr uint32_t chunk_records = ChunkRecords;
+
+	using Record = ap_array<uint8_t, RecordSizeB>;
+
+
+	static void sort(uint8_t* data, uint64_t count) {
+		assert((count & (count - 1)) == 0);
+		if (count < 2) return;
+
+		const uint64_t chunk = (count < ChunkRecords) ? count : ChunkRecords;
+
+		// All stages within a chunk, for every merge size up to the chunk
+		chunkPass(data, count, chunk, 2, chunk);
+
+		for (uint64_t k = 2 * chunk; k <= count; k <<= 1) {
+			for (uint64_t j = k >> 1; j >= chunk; j >>= 1) {
+				mergePass(data, count, chunk, k, j);
+			}
+			chunkPass(data, count, chunk, k, k);
+		}
+	}
+
+	// Number of passes over the data, each reading and writing all records once
+	static constexpr uint64_t passes(uint64_t count) {
+		return (count < 2) ? 0 : (count <= ChunkRecords) ? 1 :
+			(1 + util::integer_log2(count / ChunkRecords)) * (2 + util::integer_log2(count / ChunkRecords)) / 2;
+	}
+
+private:
+
+	// Runs the merges of size k_first to k_last, for the distances below the chunk size
+	static void chunkPass(uint8_t* data, uint64_t count, uint64_t chunk, uint64_t k_first, uint64_t k_last) {
+		Record buf[ChunkRecords];
+
+		for (uint64_t base = 0; base < count; base += chunk) {
+			loadChunk(buf, data, base, chunk);
+
+			for (uint64_t k = k_first; k <= k_last; k <<= 1) {
+				for (uint64_t j = ((k >> 1) < chunk ? (k >> 1) : (chunk >> 1)); j > 0; j >>= 1) {
+					for (uint64_t i = 0; i < chunk; ++i) {
+						#pragma HLS pipeline
+						const uint64_t l = i ^ j;
+						if (l > i) {
+							compareExchange(buf[i], buf[l], ((base + i) & k) == 0);
+						}
+					}
+				}
+			}
+
+			storeChunk(buf, data, base, chunk);
+		}
+	}
+
+	// Runs the stage of merge size k and distance j >= chunk
+	static void mergePass(uint8_t* data, uint64_t count, uint64_t chunk, uint64_t k, uint64_t j) {
+		Record lo[ChunkRecords];
+		Record hi[ChunkRecords];
+
+		for (uint64_t base = 0; base < count; base += 2 * j) {
+			for (uint64_t off = 0; off < j; off += chunk) {
+				loadChunk(lo, data, base + off, chunk);
+				loadChunk(hi, data, base + off + j, chunk);
+
+				// k > j >= chunk, so the direction is the same for the whole chunk
+				const bool ascending = ((base + off) & k) == 0;
+				for (uint64_t i = 0; i < chunk; ++i) {
+					#pragma HLS pipeline
+					compareExchange(lo[i], hi[i], ascending);
+				}
+
+				storeChunk(lo, data, base + off, chunk);
+				storeChunk(hi, data, base + off + j, chunk);
+			}
+		}
+	}
+
+	static uint64_t key(const Record& rec) {
+		#pragma HLS inline
+		uint64_t word = 0;
+		for (uint8_t i = 0; i < sizeof(uint64_t); ++i) {
+			#pragma HLS unroll
+			word |= static_cast<uint64_t>(rec[i]) << (i*8);
+		}
+		return word;
+	}
+
+	static void compareExchange(Record& a, Record& b, bool ascending) {
+		#pragma HLS inline
+		const uint64_t key_a = key(a);
+		const uint64_t key_b = key(b);
+		if (ascending ? (key_a > key_b) : (key_a < key_b)) {
+			const Record tmp = a;
+			a = b;
+			b = tmp;
+		}
+	}
+
+	static void loadChunk(Record* buf, const uint8_t* data, uint64_t first, uint64_t chunk) {
+		for (uint64_t i = 0; i < chunk * RecordSizeB; ++i) {
+			#pragma HLS pipeline
+			buf[i / RecordSizeB][i % RecordSizeB] = *(data + first * RecordSizeB + i);
+		}
+	}
+
+	static void storeChunk(const Record* buf, uint8_t* data, uint64_t first, uint64_t chunk) {
+		for (uint64_t i = 0; i < chunk * RecordSizeB; ++i) {
+			#pragma HLS pipeline
+			*(data + first * RecordSizeB + i) = buf[i / RecordSizeB][i % RecordSizeB];
+		}
+	}
+};
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+#include <hls_stream.h>
+
+#if defined(FINN_THREADED_CSIM) && !defined(__SYNTHESIS__)
+#include <thread>
+#endif
+
+#include "fpga_path_oram2.h"
+
+
+// Request of an ORAMArbiter client. The tag is returned with the response;
+// a request with last set carries no access and closes the client.
+template<typename ORAM>
+struct ORAMArbiterRequest {
+	ORAMOp                         op;
+	typename ORAM::client_block_id blk;
+	typename ORAM::Block           data;  // written data, unused for reads
+	uint32_t                       tag;
+	bool                           last;
+};
+
+template<typename ORAM>
+struct ORAMArbiterResponse {
+	uint32_t             tag;
+	typename ORAM::Block data;  // read data, or the written data for writes
+};
+
+// Hardware counters of an ORAMArbiter client
+struct ORAMArbiterCounters {
+	uint64_t served = 0;  // requests served
+	uint64_t waits  = 0;  // grants to other clients while this one had a request pending
+};
+
+
+// Arbitration policies: pick a client with a pending request, or ClientsK if there is none
+
+// The client after the last granted one comes first
+struct RoundRobinArbitration {
+	template<uint32_t ClientsK>
+	static uint32_t pick(const bool pending[ClientsK], uint32_t last) {
+		#pragma HLS inline
+		uint32_t grant = ClientsK;
+		for (uint32_t i = ClientsK; i > 0; --i) {
+			#pragma HLS unroll
+			const uint32_t c = (last + i) % ClientsK;
+			if (pending[c]) grant = c;
+		}
+		return grant;
+	}
+};
+
+// Lower client numbers come first, e.g. for the layer on the critical path
+struct FixedPriorityArbitration {
+	template<uint32_t ClientsK>
+	static uint32_t pick(const bool pending[ClientsK], uint32_t) {
+		#pragma HLS inline
+		uint32_t grant = ClientsK;
+		for (uint32_t c = ClientsK; c > 0; --c) {
+			#pragma HLS unroll
+			if (pending[c - 1]) grant = c - 1;
+		}
+		return grant;
+	}
+};
+
+
+// Multi-port front-end sharing one ORAM among ClientsK clients, e.g. the
+// ORAMBinaryWeights and ORAMThresholdsActivation of several dataflow layers.
+//
+// Every client has its own request and response stream. serve() polls the
+// request streams without blocking, grants one pending request at a time
+// according to Arbitration and answers it on the response stream of its
+// client with the request tag, so that a client waiting for a block never
+// stalls the others. It returns once every client has sent a last request.
+// Clients are best connected through an ORAMArbiterPort.
+template<typename ORAM, uint32_t ClientsK, typename Arbitration = RoundRobinArbitration>
+class ORAMArbiter {
+	static_assert(ClientsK >= 1, "At least one client is required");
+
+public:
+	static constexpr uint32_t client_count = ClientsK;
+
+	using Request  = ORAMArbiterRequest<ORAM>;
+	using Response = ORAMArbiterResponse<ORAM>;
+
+
+	explicit ORAMArbiter(ORAM& oram) : oram(oram) {}
+
+	void serve(hls::stream<Request> requests[ClientsK], hls::stream<Response> responses[ClientsK], uint8_t* server_data) {
+		bool     open[ClientsK];
+		bool     pending[ClientsK];
+		Request  heads[ClientsK];
+		#pragma HLS array_partition variable=open complete
+		#pragma HLS array_partition variable=pending complete
+		for (uint32_t c = 0; c < ClientsK; ++c) {
+			#pragma HLS unroll
+			open[c] = true;
+			pending[c] = false;
+		}
+
+		uint32_t open_cnt = ClientsK;
+		uint32_t last = ClientsK - 1;
+		while (open_cnt > 0) {
+			// Fetch the next request of every open client without a pending one
+			for (uint32_t c = 0; c < ClientsK; ++c) {
+				#pragma HLS unroll
+				if (open[c] && !pending[c] && requests[c].read_nb(heads[c])) {
+					if (heads[c].last) {
+						open[c] = false;
+						open_cnt--;
+					}
+					else {
+						pending[c] = true;
+					}
+				}
+			}
+
+			const uint32_t grant = Arbitration::template pick<ClientsK>(pending, last);
+			if (grant == ClientsK) {
+#if defined(FINN_THREADED_CSIM) && !defined(__SYNTHESIS__)
+				std::this_thread::yield();  // let the client threads run
+#endif
+				continue;
+			}
+
+			for (uint32_t c = 0; c < ClientsK; ++c) {
+				#pragma HLS unroll
+				if (pending[c] && (c != grant)) stats[c].waits++;
+			}
+
+			Response resp;
+			resp.tag = heads[grant].tag;
+			resp.data = heads[grant].data;
+			oram.access(heads[grant].op, heads[grant].blk, resp.data.data(), server_data);
+			responses[grant].write(resp);
+
+			pending[grant] = false;
+			stats[grant].served++;
+			last = grant;
+		}
+	}
+
+	const ORAMArbiterCounters& counters(uint32_t client) const noexcept {
+		return stats[client];
+	}
+
+private:
+	ORAM& oram;
+	ORAMArbiterCounters stats[ClientsK];
+};
+
+
+// Client side of an ORAMArbiter with the read/write interface of the ORAM, so
+// that e.g. ORAMBinaryWeights and ORAMThresholdsActivation take a port in
+// place of the shared ORAM. Every access blocks until its response arrives,
+// so the client has to run concurrently with the arbiter (its own dataflow
+// stage); the server_data argument is ignored, the arbiter owns the memory.
+template<typename ORAM>
+class ORAMArbiterPort {
+public:
+	using client_block_id = typename ORAM::client_block_id;
+	using Block           = typename ORAM::Block;
+	using Request         = ORAMArbiterRequest<ORAM>;
+	using Response        = ORAMArbiterResponse<ORAM>;
+
+
+	ORAMArbiterPort(hls::stream<Request>& requests, hls::stream<Response>& responses)
+		: requests(requests), responses(responses) {}
+
+	void read(client_block_id blk, uint8_t* blk_data, uint8_t* = nullptr) {
+		access(ORAMOp::Read, blk, blk_data);
+	}
+
+	void write(client_block_id blk, const uint8_t* blk_data, uint8_t* = nullptr) {
+		access(ORAMOp::Write, blk, const_cast<uint8_t*>(blk_data)); //won't actually modify b
+	}
+
+	void access(ORAMOp op, client_block_id blk, uint8_t* blk_data, uint8_t* = nullptr) {
+		Request req;
+		req.op = op;
+		req.blk = blk;
+		req.tag = next_tag++;
+		req.last = false;
+		if (op == ORAMOp::Write) {
+			for (uint32_t i = 0; i < ORAM::block_size_B; ++i) {
+				#pragma HLS pipeline
+				req.data[i] = blk_data[i];
+			}
+		}
+		requests.write(req);
+
+		const Response resp = responses.read();
+		assert(resp.tag == req.tag);
+		if (op != ORAMOp::Write) {
+			for (uint32_t i = 0; i < ORAM::block_size_B; ++i) {
+				#pragma HLS pipeline
+				blk_data[i] = resp.data[i];
+			}
+		}
+	}
+
+	// Tells the arbiter that this client is done
+	void close() {
+		Request req;
+		req.op = ORAMOp::Read;
+		req.blk = 0;
+		req.tag = next_tag;
+		req.last = true;
+		requests.write(req);
+	}
+
+private:
+	hls::stream<Request>&  requests;
+	hls::stream<Response>& responses;
+	uint32_t next_tag = 0;
+};
@@ -0,0 +1,121 @@
+#   Collects the estimated latency and II of the container microbenchmark
+#   tops from the synthesis reports of bench_containers.tcl, optionally
+#   joined with the C-simulation throughput of container_bench --csv.
+#
+#   Usage: python3 parse_hls_reports.py <hls project> [-o out.csv] [--merge containers.csv]
+#
+#   Every solution of the project is named after its top, <container>_<op>
+#   (see bench_containers_top.cpp). Latencies are in cycles for a batch of
+#   operations; "op_ii" is the II of the pipelined loop over the batch, i.e.
+#   the cycles between two operations. Estimates that HLS could not bound
+#   (data-dependent loops) are kept as reported, e.g. "?".
+#
+import argparse
+import csv
+import os
+import sys
+import xml.etree.ElementTree as ET
+
+# Solution prefixes, and the names container_bench reports for them
+CONTAINERS = {
+    "sparse_set":    "SparseSet",
+    "resource_pool": "ResourcePool",
+    "binary_tree":   "BinaryTree",
+    "binary_heap":   "BinaryHeap",
+    "cuckoo_map2":   "CuckooHashMap<2>",
+    "cuckoo_map4":   "CuckooHashMap<4>",
+    "linear_map":    "ap_array (linear scan)",
+}
+OPS = ("insert", "erase", "lookup", "iterate")
+FIELDS = ["container", "op", "clock_ns", "latency_best", "latency_worst",
+          "interval_min", "interval_max", "op_ii"]
+
+
+def text(node, path, default="undef"):
+    found = node.find(path)
+    return found.text.strip() if found is not None and found.text else default
+
+
+def parse_report(path):
+    root = ET.parse(path).getroot()
+    perf = root.find("PerformanceEstimates")
+    summary = perf.find("SummaryOfOverallLatency")
+    row = {
+        "clock_ns":      text(perf, "SummaryOfTimingAnalysis/EstimatedClockPeriod"),
+        "latency_best":  text(summary, "Best-caseLatency"),
+        "latency_worst": text(summary, "Worst-caseLatency"),
+        "interval_min":  text(summary, "Interval-min"),
+        "interval_max":  text(summary, "Interval-max"),
+        "op_ii":         "",
+    }
+    loops = perf.find("SummaryOfLoopLatency")
+    if loops is not None:
+        for loop in loops.iter():
+            if loop.tag == "ops" or loop.tag.endswith("_ops"):
+                row["op_ii"] = text(loop, "PipelineII")
+                break
+    return row
+
+
+def split_top(top):
+    for prefix, name in CONTAINERS.items():
+        for op in OPS:
+            if top == prefix + "_" + op:
+                return name, op
+    return None
+
+
+def collect(project):
+    rows = []
+    for solution in sorted(os.listdir(project)):
+        container_op = split_top(solution)
+        report = os.path.join(project, solution, "syn", "report", solution + "_csynth.xml")
+        if container_op is None or not os.path.exists(report):
+            continue
+        row = parse_report(report)
+        row["container"], row["op"] = container_op
+        rows.append(row)
+    return rows
+
+
+def merge(rows, csim_csv):
+    # One row per fill level of the C simulation, with the HLS estimates of the operation
+    estimates = {(r["container"], r["op"]): r for r in rows}
+    merged = []
+    with open(csim_csv) as f:
+        for csim in csv.DictReader(f):
+            row = dict(csim)
+            for field in FIELDS[2:]:
+                row[field] = estimates.get((csim["container"], csim["op"]), {}).get(field, "")
+            merged.append(row)
+    return merged
+
+
+def main(argv):
+    ap = argparse.ArgumentParser(description="Collect the HLS estimates of the container microbenchmarks")
+    ap.add_argument("project", help="HLS project of bench_containers.tcl")
+    ap.add_argument("-o", "--output", help="CSV file to write (default: stdout)")
+    ap.add_argument("--merge", metavar="CSV", help="container_bench --csv output to join the estimates with")
+    args = ap.parse_args(argv[1:])
+
+    rows = collect(args.project)
+    if not rows:
+        print("no synthesis reports of the container tops in %s" % args.project, file=sys.stderr)
+        return 1
+    fields = FIELDS
+    if args.merge:
+        rows = merge(rows, args.merge)
+        with open(args.merge) as f:
+            fields = next(csv.reader(f)) + FIELDS[2:]
+
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    writer = csv.DictWriter(out, fieldnames=fields)
+    writer.writeheader()
+    writer.writerows(rows)
+    if args.output:
+        out.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
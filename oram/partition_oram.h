@@ -0,0 +1,345 @@
+#pragma once
+
+#include <cstdint>
+
+#include <ap_int.h>
+
+#include "fpga_path_oram2.h"
+#include "position_map.h"
+#include "util.h"
+#include "../dataflow.h"
+
+
+// Hardware counters of an FPGAPartitionORAM
+struct PartitionORAMCounters {
+	uint64_t requests  = 0;  // block requests served
+	uint64_t rounds    = 0;  // rounds, each with one path access in every partition
+	uint64_t hits      = 0;  // requests served from the eviction cache
+	uint64_t evictions = 0;  // blocks written from the cache to their partition
+	uint32_t max_cache = 0;  // highest eviction cache occupancy
+};
+
+
+// Partition ORAM (in the style of SSS) over PartitionsP small FPGAPathORAM2
+// trees and an on-chip eviction cache.
+//
+// Every block lives in a random partition, at a random leaf, both kept on
+// chip. Requests are served in rounds in which every partition performs
+// exactly one path access:
+//  - a partition holding a requested block removes it from its tree,
+//  - a request for a block in the cache reads a random path of a random
+//    partition instead,
+//  - every other partition evicts one cached block destined for it, or
+//    reads a random path if there is none.
+// A served block moves to the cache with a fresh random partition and leaf.
+// A round takes requests in order until two would need the same partition,
+// and as partitions are random, the round boundaries reveal nothing about
+// the blocks. If the cache could overflow, rounds of evictions only are run.
+//
+// A round is planned on the cache, then the PartitionsP path accesses run
+// as parallel processes (an unrolled loop of non-inlined calls in
+// synthesis, threads of a dataflow region in the threaded C simulation,
+// see ../dataflow.h), and finally the requests are applied to the cache.
+// Each partition has a server memory of its own, given as an array of
+// PartitionsP pointers to be mapped to separate m_axi bundles, e.g.
+//
+//   #pragma HLS INTERFACE m_axi port=partition_data0 offset=slave bundle=gmem0
+//   #pragma HLS INTERFACE m_axi port=partition_data1 offset=slave bundle=gmem1
+//
+// The overloads taking a single server_data pointer place the partitions
+// one after the other in one region, for C simulation and single-port
+// platforms. The partitions share the block id space and the leaves (see
+// SharedLeaves), so their stashes are indexed by global block ids.
+template<uint32_t BlockCountN, uint32_t PartitionsP, uint8_t PartitionHeightL, uint32_t BlockSizeB,
+         uint8_t BucketSizeZ = 4, uint32_t CacheSizeC = 4 * PartitionsP>
+class FPGAPartitionORAM {
+	static_assert(PartitionsP >= 2, "At least two partitions are required");
+	static_assert(CacheSizeC > PartitionsP, "The eviction cache must hold more blocks than one round fetches");
+
+public:
+	using Partition = FPGAPathORAM2<PartitionHeightL, BlockSizeB, BucketSizeZ, SharedLeaves<BlockCountN>>;
+
+	static constexpr uint32_t block_count_N         = BlockCountN;
+	static constexpr uint32_t block_size_B          = BlockSizeB;
+	static constexpr uint32_t partition_count       = PartitionsP;
+	static constexpr uint64_t partition_server_size = Partition::server_size;
+	static constexpr uint64_t server_size           = PartitionsP * partition_server_size;
+
+	using client_block_id = typename Partition::client_block_id;
+	using client_leaf_id  = typename Partition::client_leaf_id;
+	using partition_id    = ap_uint<util::ceil_int_log2(PartitionsP)>;
+	using Block           = typename Partition::Block;
+
+	// Server memories of the partitions
+	using PartitionData = uint8_t* const[PartitionsP];
+
+
+	FPGAPartitionORAM() = default;
+	FPGAPartitionORAM(const FPGAPartitionORAM&) = delete;  // the partitions refer to leaves
+
+	void initRNG(uint64_t rng_init) {
+		rng = xorshift64{rng_init};
+		for (uint32_t p = 0; p < PartitionsP; ++p) {
+			partitions[p].initRNG(rng.generate());
+		}
+	}
+
+	void initServerMem(const PartitionData& partition_data) {
+		for (uint32_t p = 0; p < PartitionsP; ++p) {
+			partitions[p].positionMap().attach(leaves);
+			partitions[p].initServerMem(partition_data[p]);
+		}
+		for (uint32_t blk = 0; blk < BlockCountN; ++blk) {
+			partition_of[blk] = randomPartition();
+			leaves[blk] = randomLeaf();
+		}
+		cache_cnt = 0;
+	}
+
+	void read(client_block_id blk, uint8_t* blk_data, const PartitionData& partition_data) {
+		access(ORAMOp::Read, blk, blk_data, partition_data);
+	}
+
+	void write(client_block_id blk, const uint8_t* blk_data, const PartitionData& partition_data) {
+		access(ORAMOp::Write, blk, const_cast<uint8_t*>(blk_data), partition_data); //won't actually modify b
+	}
+
+	void access(ORAMOp op, client_block_id blk, uint8_t* blk_data, const PartitionData& partition_data) {
+		accessBatch(1, &op, &blk, &blk_data, partition_data);
+	}
+
+	// Serves count requests in as few rounds as the partitions allow, with the
+	// results of sequential accesses in request order
+	void accessBatch(uint32_t count, const ORAMOp* ops, const client_block_id* blks, uint8_t* const* blk_data, const PartitionData& partition_data) {
+		uint32_t next = 0;
+		while (next < count) {
+			while (cache_cnt + PartitionsP > CacheSizeC) {
+				evictionRound(partition_data);
+			}
+			next = round(next, count, ops, blks, blk_data, partition_data);
+		}
+	}
+
+	// The same on one server region holding the partitions one after the other
+	void initServerMem(uint8_t* server_data) {
+		initServerMem(split(server_data).ptrs);
+	}
+
+	void read(client_block_id blk, uint8_t* blk_data, uint8_t* server_data) {
+		read(blk, blk_data, split(server_data).ptrs);
+	}
+
+	void write(client_block_id blk, const uint8_t* blk_data, uint8_t* server_data) {
+		write(blk, blk_data, split(server_data).ptrs);
+	}
+
+	void access(ORAMOp op, client_block_id blk, uint8_t* blk_data, uint8_t* server_data) {
+		access(op, blk, blk_data, split(server_data).ptrs);
+	}
+
+	void accessBatch(uint32_t count, const ORAMOp* ops, const client_block_id* blks, uint8_t* const* blk_data, uint8_t* server_data) {
+		accessBatch(count, ops, blks, blk_data, split(server_data).ptrs);
+	}
+
+	const PartitionORAMCounters& counters() const noexcept {
+		return stats;
+	}
+
+private:
+
+	static constexpr int32_t idle = -1;
+
+	struct PartitionPtrs {
+		uint8_t* ptrs[PartitionsP];
+	};
+
+	static PartitionPtrs split(uint8_t* server_data) {
+		PartitionPtrs parts;
+		for (uint32_t p = 0; p < PartitionsP; ++p) {
+			#pragma HLS unroll
+			parts.ptrs[p] = server_data + p * partition_server_size;
+		}
+		return parts;
+	}
+
+	// The path access of a partition in a round
+	struct PathStep {
+		ORAMOp          op = ORAMOp::Read;  // Remove to fetch a block, Write to evict one
+		bool            dummy = true;       // only read and write back the path
+		client_block_id blk = 0;
+		client_leaf_id  leaf = 0;
+		Block           data;               // fetched or evicted block
+	};
+
+	static void pathAccess(Partition& partition, PathStep& step, uint8_t* partition_data) {
+		#pragma HLS inline off
+		if (step.dummy) {
+			partition.evictPath(step.leaf, partition_data);
+		}
+		else {
+			partition.accessPath(step.op, step.blk, step.leaf, step.data.data(), partition_data);
+		}
+	}
+
+	// Runs the path accesses of all partitions in parallel
+	void pathAccesses(PathStep (&steps)[PartitionsP], const PartitionData& partition_data) {
+		FINN_DATAFLOW_REGION;
+		for (uint32_t p = 0; p < PartitionsP; ++p) {
+			#pragma HLS unroll
+#ifdef FINN_DATAFLOW_THREADED
+			finn::dataflow::spawn([&, p]() { pathAccess(partitions[p], steps[p], partition_data[p]); });
+#else
+			pathAccess(partitions[p], steps[p], partition_data[p]);
+#endif
+		}
+	}
+
+	// Serves requests from first on until a partition conflict; returns the first request left
+	uint32_t round(uint32_t first, uint32_t count, const ORAMOp* ops, const client_block_id* blks, uint8_t* const* blk_data, const PartitionData& partition_data) {
+		PathStep steps[PartitionsP];
+		int32_t  request_of[PartitionsP];  // request fetching from each partition, or idle
+		for (uint32_t p = 0; p < PartitionsP; ++p) {
+			#pragma HLS unroll
+			request_of[p] = idle;
+			steps[p].dummy = true;
+		}
+
+		// Assign partitions in request order until one is taken twice
+		uint32_t last = first;
+		for (; (last < count) && (last - first < PartitionsP); ++last) {
+			bool fetched_before = false;
+			for (uint32_t i = first; i < last; ++i) {
+				fetched_before |= (blks[i] == blks[last]);
+			}
+			const bool hit = fetched_before || (cacheSlot(blks[last]) != cache_cnt);
+			const uint32_t p = hit ? static_cast<uint32_t>(randomPartition()) : static_cast<uint32_t>(partition_of[blks[last]]);
+			if (request_of[p] != idle) break;
+			request_of[p] = last;
+			if (hit) {
+				steps[p].leaf = partitions[p].randomLeaf();
+				stats.hits++;
+			}
+			else {
+				steps[p].dummy = false;
+				steps[p].op = ORAMOp::Remove;
+				steps[p].blk = blks[last];
+				steps[p].leaf = leaves[blks[last]];
+			}
+		}
+
+		// The other partitions evict a cached block not requested in this round
+		for (uint32_t p = 0; p < PartitionsP; ++p) {
+			if (request_of[p] == idle) {
+				planEviction(p, steps[p], blks + first, last - first);
+			}
+		}
+
+		pathAccesses(steps, partition_data);
+
+		// Apply the requests in order through the cache, moving fetched blocks there
+		for (uint32_t i = first; i < last; ++i) {
+			const client_block_id blk = blks[i];
+			uint32_t slot = cacheSlot(blk);
+			if (slot == cache_cnt) {
+				for (uint32_t p = 0; p < PartitionsP; ++p) {
+					if ((request_of[p] == static_cast<int32_t>(i)) && !steps[p].dummy) {
+						cache[slot] = steps[p].data;
+					}
+				}
+				cache_ids[slot] = blk;
+				cache_cnt++;
+				partition_of[blk] = randomPartition();
+				leaves[blk] = randomLeaf();
+			}
+
+			for (uint32_t b = 0; b < BlockSizeB; ++b) {
+				#pragma HLS pipeline
+				if (ops[i] == ORAMOp::Write) cache[slot][b] = blk_data[i][b];
+				else                         blk_data[i][b] = cache[slot][b];
+			}
+			stats.requests++;
+		}
+		if (cache_cnt > stats.max_cache) stats.max_cache = cache_cnt;
+
+		stats.rounds++;
+		return last;
+	}
+
+	void evictionRound(const PartitionData& partition_data) {
+		PathStep steps[PartitionsP];
+		for (uint32_t p = 0; p < PartitionsP; ++p) {
+			planEviction(p, steps[p], nullptr, 0);
+		}
+		pathAccesses(steps, partition_data);
+		stats.rounds++;
+	}
+
+	// Takes a cached block destined for partition p, other than the count
+	// requested ones, out of the cache to be written into p, or else plans
+	// the read of a random path
+	void planEviction(uint32_t p, PathStep& step, const client_block_id* requested, uint32_t count) {
+		uint32_t slot = cache_cnt;
+		for (uint32_t i = 0; i < CacheSizeC; ++i) {
+			#pragma HLS unroll
+			bool is_requested = false;
+			for (uint32_t r = 0; r < count; ++r) {
+				is_requested |= (requested[r] == cache_ids[i]);
+			}
+			if ((i < cache_cnt) && (partition_of[cache_ids[i]] == p) && !is_requested) {
+				slot = i;
+			}
+		}
+
+		step.leaf = partitions[p].randomLeaf();
+		if (slot == cache_cnt) {
+			step.dummy = true;
+			return;
+		}
+
+		step.dummy = false;
+		step.op = ORAMOp::Write;
+		step.blk = cache_ids[slot];
+		step.data = cache[slot];
+		stats.evictions++;
+
+		cache_cnt--;
+		cache_ids[slot] = cache_ids[cache_cnt];
+		cache[slot] = cache[cache_cnt];
+	}
+
+	// Cache slot of a block, or cache_cnt if it is not cached
+	uint32_t cacheSlot(client_block_id blk) const {
+		uint32_t slot = cache_cnt;
+		for (uint32_t i = 0; i < CacheSizeC; ++i) {
+			#pragma HLS unroll
+			if ((i < cache_cnt) && (cache_ids[i] == blk)) {
+				slot = i;
+			}
+		}
+		return slot;
+	}
+
+	partition_id randomPartition() {
+		#pragma HLS inline
+		return rng.generate() % PartitionsP;
+	}
+
+	client_leaf_id randomLeaf() {
+		#pragma HLS inline
+		return rng.generate() % (1ull << PartitionHeightL);
+	}
+
+
+	Partition partitions[PartitionsP];
+
+	partition_id   partition_of[BlockCountN];
+	client_leaf_id leaves[BlockCountN];
+
+	// Eviction cache
+	client_block_id cache_ids[CacheSizeC];
+	Block           cache[CacheSizeC];
+	uint32_t        cache_cnt = 0;
+
+	xorshift64 rng;
+	PartitionORAMCounters stats;
+};
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include <ap_int.h>
+
+#include "siphash.h"
+#include "util.h"
+
+
+// Position maps of FPGAPathORAM2, mapping every block to the leaf whose path
+// holds it. remap() returns the current leaf of a block and moves it to a
+// fresh one, leaf() returns the current leaf without changing it.
+// A map may also change the leaves of blocks other than the accessed one:
+// after every access, FPGAPathORAM2 asks nextMove() for up to max_moves such
+// blocks and re-places each on its new path with move(). exhausted() tells
+// that the map has no fresh leaves left and the ORAM refuses all accesses.
+
+
+//----------------------------------------------------------------------------------
+// Random position map
+//----------------------------------------------------------------------------------
+
+// Stores a uniformly random leaf per block, HeightL bits each.
+template<uint64_t BlockCount, uint8_t HeightL>
+class RandomPositionMap {
+public:
+	using leaf_id  = ap_uint<HeightL>;
+	using block_id = ap_uint<util::ceil_int_log2(BlockCount)>;
+
+	static constexpr uint32_t max_moves = 0;
+
+	void init(xorshift64& rng) {
+		for (uint64_t i = 0; i < BlockCount; ++i) {
+			#pragma HLS pipeline
+			leaves[i] = rng.generate() % (1ull << HeightL);
+		}
+	}
+
+	leaf_id leaf(block_id blk) const {
+		#pragma HLS inline
+		return leaves[blk];
+	}
+
+	leaf_id remap(block_id blk, xorshift64& rng) {
+		#pragma HLS inline
+		const leaf_id old_leaf = leaves[blk];
+		leaves[blk] = rng.generate() % (1ull << HeightL);
+		return old_leaf;
+	}
+
+	bool nextMove(block_id&) {
+		return false;
+	}
+
+	leaf_id move(block_id blk) {
+		return leaves[blk];
+	}
+
+	bool exhausted() const noexcept {
+		return false;
+	}
+
+private:
+	leaf_id leaves[BlockCount];
+};
+
+
+//----------------------------------------------------------------------------------
+// PRF position map
+//----------------------------------------------------------------------------------
+
+// Derives the leaf of a block as SipHash(key, block id, group counter,
+// block counter) with the split counters of Freecursive ORAM, so that the
+// on-chip map shrinks from HeightL to CounterBits + 1 bits per block plus a
+// wide counter per group of GroupSize blocks. The key is drawn once from
+// the RNG at init.
+// A block counter never wraps to a leaf used before: when it overflows, the
+// group counter advances, which changes the leaves of all blocks of the
+// group, and the ORAM re-places the other blocks of the group on their new
+// paths through nextMove() and move(), GroupSize - 1 path accesses per
+// 2^CounterBits accesses to a group. A parity bit per block tells the blocks
+// still to be moved, which keep the leaf of the previous group counter. Once
+// a group counter would wrap, the map is exhausted and must be re-initialized.
+template<uint64_t BlockCount, uint8_t HeightL, uint8_t CounterBits, uint32_t GroupSize>
+class PRFPositionMap {
+	static constexpr uint8_t block_bits = util::ceil_int_log2(BlockCount);
+	static constexpr uint8_t group_bits = 64 - block_bits - CounterBits;
+	static constexpr uint64_t group_count = (BlockCount + GroupSize - 1) / GroupSize;
+
+	static_assert(block_bits + CounterBits + 16 <= 64, "Block id, block counter and a group counter of at least 16 bits must fit into the 64-bit PRF input");
+	static_assert(GroupSize > 0 && (GroupSize & (GroupSize - 1)) == 0, "GroupSize must be a power of two");
+
+public:
+	using leaf_id  = ap_uint<HeightL>;
+	using block_id = ap_uint<block_bits>;
+	using counter  = ap_uint<CounterBits>;
+	using group_counter = ap_uint<group_bits>;
+
+	static constexpr uint32_t max_moves = GroupSize - 1;
+
+	void init(xorshift64& rng) {
+		prf.k0 = rng.generate();
+		prf.k1 = rng.generate();
+		rolls = 0;
+		rolling = false;
+		out_of_leaves = false;
+		for (uint64_t i = 0; i < BlockCount; ++i) {
+			#pragma HLS pipeline
+			counters[i] = 0;
+			parities[i] = 0;
+		}
+		for (uint64_t g = 0; g < group_count; ++g) {
+			#pragma HLS pipeline
+			groups[g] = 0;
+		}
+	}
+
+	leaf_id leaf(block_id blk) const {
+		#pragma HLS inline
+		return derive(blk, groupCounter(blk), counters[blk]);
+	}
+
+	leaf_id remap(block_id blk, xorshift64&) {
+		#pragma HLS inline
+		const leaf_id old_leaf = leaf(blk);
+		if (counters[blk] != counter(-1)) {
+			counters[blk] = counters[blk] + 1;
+		}
+		else if (groups[blk / GroupSize] != group_counter(-1)) {
+			startRoll(blk);
+		}
+		else {
+			// Keeps the leaf just revealed; the ORAM refuses further accesses
+			out_of_leaves = true;
+		}
+		return old_leaf;
+	}
+
+	// The next block of a rolled group still on the path of the previous group counter
+	bool nextMove(block_id& blk) {
+		#pragma HLS inline
+		if (rolling && roll_next == roll_skip) {
+			roll_next++;
+		}
+		if (!rolling || roll_next >= roll_end) {
+			rolling = false;
+			return false;
+		}
+		blk = static_cast<block_id>(roll_next);
+		return true;
+	}
+
+	// Moves a block returned by nextMove() to the current group counter, returning its old leaf
+	leaf_id move(block_id blk) {
+		#pragma HLS inline
+		const leaf_id old_leaf = leaf(blk);
+		counters[blk] = 0;
+		parities[blk] = groups[blk / GroupSize][0];
+		roll_next++;
+		return old_leaf;
+	}
+
+	bool exhausted() const noexcept {
+		return out_of_leaves;
+	}
+
+	// Number of group counter increments since init
+	uint32_t group_rolls() const noexcept {
+		return rolls;
+	}
+
+private:
+	void startRoll(block_id blk) {
+		const uint64_t grp = blk / GroupSize;
+		groups[grp] = groups[grp] + 1;
+		counters[blk] = 0;
+		parities[blk] = groups[grp][0];
+		rolls++;
+		rolling = true;
+		roll_skip = blk;
+		roll_next = grp * GroupSize;
+		roll_end = std::min<uint64_t>(roll_next + GroupSize, BlockCount);
+	}
+
+	group_counter groupCounter(block_id blk) const {
+		#pragma HLS inline
+		const group_counter grp = groups[blk / GroupSize];
+		// not yet moved in the running roll of its group
+		return (parities[blk] == grp[0]) ? grp : group_counter(grp - 1);
+	}
+
+	leaf_id derive(block_id blk, group_counter grp, counter cnt) const {
+		#pragma HLS inline
+		const uint64_t input = (static_cast<uint64_t>(blk) << (group_bits + CounterBits))
+		                     | (static_cast<uint64_t>(grp) << CounterBits)
+		                     | static_cast<uint64_t>(cnt);
+		return prf(input) % (1ull << HeightL);
+	}
+
+	counter counters[BlockCount];
+	ap_uint<1> parities[BlockCount];
+	group_counter groups[group_count];
+	SipHash24 prf;
+	uint32_t rolls = 0;
+	bool rolling = false;
+	bool out_of_leaves = false;
+	uint64_t roll_skip = 0;
+	uint64_t roll_next = 0;
+	uint64_t roll_end = 0;
+};
+
+
+//----------------------------------------------------------------------------------
+// Shared position map
+//----------------------------------------------------------------------------------
+
+// Refers to the leaves kept by a front-end over several ORAMs, for a block
+// space of BlockCount blocks, e.g. FPGAPartitionORAM. The front-end attaches
+// its leaf array and picks the paths itself through accessPath().
+template<uint64_t BlockCount, uint8_t HeightL>
+class SharedPositionMap {
+public:
+	using leaf_id  = ap_uint<HeightL>;
+	using block_id = ap_uint<util::ceil_int_log2(BlockCount)>;
+
+	static constexpr uint32_t max_moves = 0;
+
+	void attach(const leaf_id* shared_leaves) noexcept {
+		leaves = shared_leaves;
+	}
+
+	void init(xorshift64&) {
+	}
+
+	leaf_id leaf(block_id blk) const {
+		#pragma HLS inline
+		return leaves[blk];
+	}
+
+	leaf_id remap(block_id blk, xorshift64&) {
+		#pragma HLS inline
+		return leaves[blk];
+	}
+
+	bool nextMove(block_id&) {
+		return false;
+	}
+
+	leaf_id move(block_id blk) {
+		return leaves[blk];
+	}
+
+	bool exhausted() const noexcept {
+		return false;
+	}
+
+private:
+	const leaf_id* leaves = nullptr;
+};
+
+
+//----------------------------------------------------------------------------------
+// Position map modes, selected through FPGAPathORAM2's PositionMapMode
+//----------------------------------------------------------------------------------
+
+struct RandomLeaves {
+	template<uint64_t BlockCount, uint8_t HeightL>
+	using map = RandomPositionMap<BlockCount, HeightL>;
+};
+
+template<uint8_t CounterBits = 8, uint32_t GroupSize = 16>
+struct PRFLeaves {
+	template<uint64_t BlockCount, uint8_t HeightL>
+	using map = PRFPositionMap<BlockCount, HeightL, CounterBits, GroupSize>;
+};
+
+// Leaves of a block space of BlockCount blocks kept outside the ORAM
+template<uint64_t BlockCount>
+struct SharedLeaves {
+	template<uint64_t, uint8_t HeightL>
+	using map = SharedPositionMap<BlockCount, HeightL>;
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+
+#include "fpga_path_oram2.h"
+
+
+// Hardware counters of an ORAMRequestCoalescer. The coalescing rate is
+// 1 - accesses / requests.
+struct ORAMCoalescerCounters {
+	uint64_t requests = 0;  // requests pushed
+	uint64_t accesses = 0;  // ORAM accesses issued for them
+};
+
+
+// Request queue in front of an ORAM that merges the outstanding requests for
+// the same block. Requests are pushed, each returning a ticket, until the
+// queue is full or the caller needs the results; flush() then issues at most
+// one read and one write per distinct block:
+//  - a read, if the first request for the block is a read, and
+//  - a write of the last written data, if any request for it is a write.
+// Every read request sees the data of the latest write queued before it, or
+// else the block as read from the ORAM, and is served through result() from
+// the flush until the next push.
+template<typename ORAM, uint32_t QueueDepth>
+class ORAMRequestCoalescer {
+public:
+	static constexpr uint32_t queue_depth = QueueDepth;
+	static constexpr int32_t  no_request  = -1;
+
+	using client_block_id = typename ORAM::client_block_id;
+	using Block           = typename ORAM::Block;
+
+
+	bool full() const noexcept {
+		return !flushed && (request_cnt == QueueDepth);
+	}
+
+	bool empty() const noexcept {
+		return flushed || (request_cnt == 0);
+	}
+
+	// Queues a request; blk_data is only read, and only for writes. Must not be called when full.
+	uint32_t push(ORAMOp op, client_block_id blk, const uint8_t* blk_data) {
+		if (flushed) {
+			flushed = false;
+			request_cnt = 0;
+			block_cnt = 0;
+		}
+
+		// Find the block among the queued ones, or add it
+		uint32_t slot = block_cnt;
+		for (uint32_t i = 0; i < QueueDepth; ++i) {
+			#pragma HLS unroll
+			if ((i < block_cnt) && (block_ids[i] == blk)) {
+				slot = i;
+			}
+		}
+		if (slot == block_cnt) {
+			block_ids[slot]  = blk;
+			needs_read[slot] = (op == ORAMOp::Read);
+			last_write[slot] = no_request;
+			block_cnt++;
+		}
+
+		const uint32_t ticket = request_cnt++;
+		request_slot[ticket] = slot;
+		if (op == ORAMOp::Write) {
+			for (uint32_t i = 0; i < ORAM::block_size_B; ++i) {
+				#pragma HLS pipeline
+				request_data[ticket][i] = blk_data[i];
+			}
+			last_write[slot] = ticket;
+			source[ticket] = ticket;
+		}
+		else {
+			source[ticket] = last_write[slot];
+		}
+
+		stats.requests++;
+		return ticket;
+	}
+
+	uint32_t read(client_block_id blk) {
+		#pragma HLS inline
+		return push(ORAMOp::Read, blk, nullptr);
+	}
+
+	uint32_t write(client_block_id blk, const uint8_t* blk_data) {
+		#pragma HLS inline
+		return push(ORAMOp::Write, blk, blk_data);
+	}
+
+	// Issues the merged accesses of all queued requests
+	void flush(ORAM& oram, uint8_t* server_data) {
+		if (flushed) return;
+
+		for (uint32_t slot = 0; slot < block_cnt; ++slot) {
+			if (needs_read[slot]) {
+				oram.read(block_ids[slot], fetched[slot].data(), server_data);
+				stats.accesses++;
+			}
+			if (last_write[slot] != no_request) {
+				oram.write(block_ids[slot], request_data[last_write[slot]].data(), server_data);
+				stats.accesses++;
+			}
+		}
+		flushed = true;
+	}
+
+	// Data seen by a request, valid from the flush until the next push
+	const Block& result(uint32_t ticket) const {
+		#pragma HLS inline
+		return (source[ticket] == no_request) ? fetched[request_slot[ticket]] : request_data[source[ticket]];
+	}
+
+	void result(uint32_t ticket, uint8_t* blk_data) const {
+		const Block& blk = result(ticket);
+		for (uint32_t i = 0; i < ORAM::block_size_B; ++i) {
+			#pragma HLS pipeline
+			blk_data[i] = blk[i];
+		}
+	}
+
+	const ORAMCoalescerCounters& counters() const noexcept {
+		return stats;
+	}
+
+private:
+
+	// Distinct blocks of the queued requests
+	client_block_id block_ids[QueueDepth];
+	bool            needs_read[QueueDepth];
+	int32_t         last_write[QueueDepth];
+	Block           fetched[QueueDepth];
+	uint32_t        block_cnt = 0;
+
+	// Queued requests
+	uint32_t request_slot[QueueDepth];
+	int32_t  source[QueueDepth];  // write request whose data a request sees, or no_request for the fetched block
+	Block    request_data[QueueDepth];
+	uint32_t request_cnt = 0;
+
+	bool flushed = false;
+	ORAMCoalescerCounters stats;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+
+
+// SipHash-2-4 of a single 64-bit word under a 128-bit key, used as a PRF.
+// All rounds are unrolled into one expression, so a pipelined caller
+// accepts a new input every cycle.
+struct SipHash24 final {
+	uint64_t k0 = 0;
+	uint64_t k1 = 0;
+
+	uint64_t operator()(uint64_t m) const {
+		#pragma HLS inline
+		uint64_t v0 = k0 ^ 0x736f6d6570736575ull;
+		uint64_t v1 = k1 ^ 0x646f72616e646f6dull;
+		uint64_t v2 = k0 ^ 0x6c7967656e657261ull;
+		uint64_t v3 = k1 ^ 0x7465646279746573ull;
+
+		// Message word, 2 compression rounds
+		v3 ^= m;
+		round(v0, v1, v2, v3);
+		round(v0, v1, v2, v3);
+		v0 ^= m;
+
+		// Final block holding only the message length (8 bytes), 2 compression rounds
+		const uint64_t b = 8ull << 56;
+		v3 ^= b;
+		round(v0, v1, v2, v3);
+		round(v0, v1, v2, v3);
+		v0 ^= b;
+
+		// 4 finalization rounds
+		v2 ^= 0xff;
+		round(v0, v1, v2, v3);
+		round(v0, v1, v2, v3);
+		round(v0, v1, v2, v3);
+		round(v0, v1, v2, v3);
+
+		return v0 ^ v1 ^ v2 ^ v3;
+	}
+
+private:
+
+	static uint64_t rotl(uint64_t x, unsigned b) {
+		#pragma HLS inline
+		return (x << b) | (x >> (64 - b));
+	}
+
+	static void round(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+		#pragma HLS inline
+		v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+		v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+		v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+		v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+	}
+};
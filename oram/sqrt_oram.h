@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstdint>
+
+#include <ap_int.h>
+
+#include "memory/ap_array.h"
+#include "fpga_path_oram2.h"
+#include "oblivious_sort.h"
+#include "util.h"
+
+
+// Square-root ORAM for read-mostly data, with the read/write/access interface
+// of FPGAPathORAM2.
+//
+// The server holds the N blocks and ShelterSizeS dummy blocks at the slots of
+// a random permutation, kept on chip in the position map. Every access scans
+// the on-chip shelter and fetches a single slot: the block's own if it is not
+// sheltered, else the next unused dummy. After ShelterSizeS accesses, the
+// shelter is written back to the slots read during the epoch and the server
+// array is reshuffled by an oblivious sort on fresh random tags (see
+// ObliviousSorter for SortChunkRecords). An access thus costs one block read
+// plus the amortized reshuffle, and no write-back.
+//
+// Server layout: server_slot_count records of an 8-byte word followed by
+// BlockSizeB data bytes. The word holds the block id in its low and the
+// reshuffle tag in its high 32 bits; block ids N and up are dummies, and the
+// padding up to a power of two holds all-ones words.
+template<uint32_t BlockCountN, uint32_t BlockSizeB, uint32_t ShelterSizeS = util::ceil_int_sqrt<uint64_t>(BlockCountN), uint32_t SortChunkRecords = 64>
+class FPGASqrtORAM {
+public:
+	static constexpr uint32_t block_count_N     = BlockCountN;
+	static constexpr uint32_t block_size_B      = BlockSizeB;
+	static constexpr uint32_t shelter_size_S    = ShelterSizeS;
+	static constexpr uint32_t record_count      = BlockCountN + ShelterSizeS;
+	static constexpr uint64_t server_slot_count = 1ull << util::ceil_int_log2(record_count);
+	static constexpr uint64_t record_size       = sizeof(uint64_t) + BlockSizeB;
+	static constexpr uint64_t server_size       = server_slot_count * record_size;
+
+	// An integer with the least number of bits required to address all blocks
+	using client_block_id = ap_uint<util::ceil_int_log2(BlockCountN)>;
+
+	// An integer with the least number of bits required to address all server slots
+	using server_slot_id = ap_uint<util::ceil_int_log2(server_slot_count)>;
+
+	using Block = ap_array<uint8_t, BlockSizeB>;
+
+	static constexpr uint64_t padding_word = ~0ull;
+
+
+	FPGASqrtORAM() = default;
+
+	void initRNG(uint64_t rng_init) {
+		rng = xorshift64{rng_init};
+	}
+
+	void initServerMem(uint8_t* server_data) {
+		for (uint64_t slot = 0; slot < server_slot_count; ++slot) {
+			writeWord(slot < record_count ? slot : padding_word, slot, server_data);
+			for (uint32_t i = 0; i < BlockSizeB; ++i) {
+				#pragma HLS pipeline
+				*(server_data + slot * record_size + sizeof(uint64_t) + i) = 0;
+			}
+		}
+		for (uint32_t i = 0; i < record_count; ++i) {
+			#pragma HLS pipeline
+			position_map[i] = i;
+		}
+		shelter_cnt = 0;
+		reshuffle(server_data);
+	}
+
+	void read(client_block_id blk, uint8_t* blk_data, uint8_t* server_data) {
+		access(ORAMOp::Read, blk, blk_data, server_data);
+	}
+
+	void write(client_block_id blk, const uint8_t* blk_data, uint8_t* server_data) {
+		access(ORAMOp::Write, blk, const_cast<uint8_t*>(blk_data), server_data); //won't actually modify b
+	}
+
+	void access(ORAMOp op, client_block_id blk, uint8_t* blk_data, uint8_t* server_data) {
+		// Scan the whole shelter
+		uint32_t hit = shelter_cnt;
+		for (uint32_t k = 0; k < ShelterSizeS; ++k) {
+			#pragma HLS unroll
+			if ((k < shelter_cnt) && (shelter_ids[k] == blk)) {
+				hit = k;
+			}
+		}
+
+		// Fetch the block, or the dummy of this access if it is sheltered
+		const uint32_t k = shelter_cnt;
+		const uint32_t fetch_id = (hit == k) ? static_cast<uint32_t>(blk) : (BlockCountN + k);
+		read_slots[k]  = position_map[fetch_id];
+		shelter_ids[k] = fetch_id;
+		readBlock(shelter[k], read_slots[k], server_data);
+		shelter_cnt++;
+
+		switch (op) {
+			case ORAMOp::Read: {
+				for (uint32_t i = 0; i < BlockSizeB; ++i) {
+					#pragma HLS pipeline
+					blk_data[i] = shelter[hit][i];
+				}
+				break;
+			}
+
+			case ORAMOp::Write: {
+				for (uint32_t i = 0; i < BlockSizeB; ++i) {
+					#pragma HLS pipeline
+					shelter[hit][i] = blk_data[i];
+				}
+				break;
+			}
+
+			default: break;
+		}
+
+		if (shelter_cnt == ShelterSizeS) {
+			reshuffle(server_data);
+		}
+	}
+
+private:
+
+	void reshuffle(uint8_t* server_data) {
+		// Return the shelter to the slots read during the epoch
+		for (uint32_t k = 0; k < shelter_cnt; ++k) {
+			writeBlock(shelter[k], read_slots[k], server_data);
+		}
+		shelter_cnt = 0;
+
+		// Draw a new permutation and tag every record with its new slot
+		for (uint32_t i = record_count - 1; i > 0; --i) {
+			const uint32_t j = rng.generate() % (i + 1);
+			const server_slot_id tmp = position_map[i];
+			position_map[i] = position_map[j];
+			position_map[j] = tmp;
+		}
+		for (uint64_t slot = 0; slot < server_slot_count; ++slot) {
+			const uint64_t word = readWord(slot, server_data);
+			const uint32_t id = static_cast<uint32_t>(word);
+			if (word != padding_word) {
+				writeWord((static_cast<uint64_t>(position_map[id]) << 32) | id, slot, server_data);
+			}
+		}
+
+		// Sorting by tag moves every record to its new slot
+		ObliviousSorter<record_size, SortChunkRecords>::sort(server_data, server_slot_count);
+	}
+
+	uint64_t readWord(uint64_t slot, uint8_t* server_data) {
+		uint64_t word = 0;
+		for (uint8_t i = 0; i < sizeof(uint64_t); ++i) {
+			#pragma HLS pipeline
+			word |= static_cast<uint64_t>(*(server_data + slot * record_size + i)) << (i*8);
+		}
+		return word;
+	}
+
+	void writeWord(uint64_t word, uint64_t slot, uint8_t* server_data) {
+		for (uint8_t i = 0; i < sizeof(uint64_t); ++i) {
+			#pragma HLS pipeline
+			*(server_data + slot * record_size + i) = static_cast<uint8_t>(word >> (i*8));
+		}
+	}
+
+	void readBlock(Block& out, uint64_t slot, uint8_t* server_data) {
+		for (uint32_t i = 0; i < BlockSizeB; ++i) {
+			#pragma HLS pipeline
+			out[i] = *(server_data + slot * record_size + sizeof(uint64_t) + i);
+		}
+	}
+
+	void writeBlock(const Block& in, uint64_t slot, uint8_t* server_data) {
+		for (uint32_t i = 0; i < BlockSizeB; ++i) {
+			#pragma HLS pipeline
+			*(server_data + slot * record_size + sizeof(uint64_t) + i) = in[i];
+		}
+	}
+
+
+	server_slot_id position_map[record_count];
+
+	// Blocks fetched in this epoch, in access order
+	uint32_t       shelter_ids[ShelterSizeS];
+	server_slot_id read_slots[ShelterSizeS];
+	Block          shelter[ShelterSizeS];
+	uint32_t       shelter_cnt = 0;
+
+	xorshift64 rng;
+};
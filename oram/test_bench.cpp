@@ -1,11 +1,25 @@
 #include "top.h"
 #include "fpga_path_oram2.h"
-
+#include "request_coalescer.h"
+#include "oram_arbiter.h"
+#include "oram_atu.h"
+#include "oblivious_sort.h"
+#include "partition_oram.h"
+#include "sqrt_oram.h"
+#include "memory/fpga_cuckoo_map.h"
+#include "host/csim_backend.h"
+#include "host/oram_driver.h"
+#include "../dram_model.h"
+#include "../weights.hpp"
+#include "../activations.hpp"
+
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <iostream>
 #include <unordered_map>
 #include <random>
+#include <set>
 #include <vector>
 
 #define ORAM_BLOCK_ID_SIZE sizeof(uint64_t)
@@ -31,7 +45,7 @@ void ORAMRead(uint64_t blk_id, uint8_t* blk_data) {
 }
 
 
-void test_oram() {
+size_t test_oram() {
 	std::cout << "Initializing ORAM" << std::endl;
 	ORAMInit();
 
@@ -108,10 +122,651 @@ void test_oram() {
 	}
 
 	std::cout << "Successful tests: " << successes << "\nFailed tests: " << failures << std::endl;
+
+	return failures;
+}
+
+
+size_t test_siphash() {
+	// Reference vector of the SipHash paper: key 00..0f, message 00..07
+	SipHash24 prf;
+	prf.k0 = 0x0706050403020100ull;
+	prf.k1 = 0x0f0e0d0c0b0a0908ull;
+	const uint64_t hash = prf(0x0706050403020100ull);
+
+	const size_t failures = (hash == 0x93f5f5799a932462ull) ? 0 : 1;
+	std::cout << "SipHash-2-4 test " << ((failures == 0) ? "succeeded" : "failed") << std::endl;
+
+	return failures;
+}
+
+
+size_t test_prf_position_map() {
+	// Few counter bits and wide leaves, so that any reuse of a leaf shows
+	using Map = PRFPositionMap<64, 20, 3, 8>;
+	static Map map;
+	xorshift64 rng{ORAM_RNG_INIT};
+	map.init(rng);
+
+	// Three rounds of the block counter of block 13, re-placing its group after every overflow
+	size_t failures = 0;
+	std::vector<uint64_t> leaves;
+	for (int i = 0; i < 3 * 8; ++i) {
+		leaves.push_back(map.remap(13, rng));
+		const uint64_t group_leaf = map.leaf(9);
+		Map::block_id moved;
+		uint32_t moves = 0;
+		while (map.nextMove(moved)) {
+			if (moved / 8 != 13 / 8 || moved == 13) failures += 1;
+			if (moved == 9 && map.move(moved) != group_leaf) failures += 1;
+			else if (moved != 9) map.move(moved);
+			moves += 1;
+		}
+		if (moves != ((i % 8 == 7) ? 7u : 0u)) failures += 1;
+		if ((i % 8 == 7) && map.leaf(9) == group_leaf) failures += 1;
+	}
+	std::sort(leaves.begin(), leaves.end());
+	if (std::adjacent_find(leaves.begin(), leaves.end()) != leaves.end()) failures += 1;
+	if (map.group_rolls() != 3 || map.exhausted()) failures += 1;
+
+	std::cout << "PRF position map test " << ((failures == 0) ? "succeeded" : "failed") << std::endl;
+
+	return failures;
+}
+
+
+size_t test_oram_prf() {
+	// Small counters, so that groups roll over during the test
+	using ORAM = FPGAPathORAM2<ORAM_HEIGHT, ORAM_BLOCK_SIZE, ORAM_BUCKET_SIZE, PRFLeaves<4>>;
+	static ORAM prf_oram;
+	static uint8_t server_data[ORAM_SERVER_SIZE];
+
+	std::cout << "Initializing ORAM with PRF position map" << std::endl;
+	prf_oram.initRNG(ORAM_RNG_INIT);
+	prf_oram.initServerMem(server_data);
+
+	std::mt19937 gen{0xDEADBEEF};
+	std::uniform_int_distribution<uint64_t> addr_dist{0, ORAM_BLOCK_COUNT/4 - 1};
+	std::unordered_map<uint64_t, std::array<uint8_t, ORAM_BLOCK_SIZE>> expected;
+
+	// Random mix of writes and reads, validating every read of a written block
+	//--------------------------------------------------------------------------------
+	size_t failures = 0;
+	size_t successes = 0;
+	std::array<uint8_t, ORAM_BLOCK_SIZE> oram_data;
+	for (int i = 0; i < 20 * ORAM_BLOCK_COUNT; ++i) {
+		const uint64_t blk_id = addr_dist(gen);
+		if ((i % 3 == 0) || (expected.count(blk_id) == 0)) {
+			auto& block = expected[blk_id];
+			block.fill(static_cast<uint8_t>(blk_id + i));
+			prf_oram.write(blk_id, block.data(), server_data);
+		}
+		else {
+			prf_oram.read(blk_id, oram_data.data(), server_data);
+			if (oram_data == expected[blk_id]) successes += 1;
+			else                               failures += 1;
+		}
+	}
+
+	// The test must exercise the re-placement of groups
+	if (prf_oram.positionMap().group_rolls() == 0) failures += 1;
+
+	std::cout << "Successful tests: " << successes << "\nFailed tests: " << failures << std::endl;
+	std::cout << "Group rolls: " << prf_oram.positionMap().group_rolls()
+	          << ((prf_oram.positionMap().group_rolls() > 0) ? "" : " (expected some)") << std::endl;
+
+	return failures;
+}
+
+
+size_t test_coalescer() {
+	using ORAM = FPGAPathORAM2<ORAM_HEIGHT, ORAM_BLOCK_SIZE, ORAM_BUCKET_SIZE>;
+	static ORAM direct_oram;
+	static ORAMRequestCoalescer<ORAM, 8> queue;
+	static uint8_t server_data[ORAM_SERVER_SIZE];
+
+	std::cout << "Initializing ORAM behind a request coalescer" << std::endl;
+	direct_oram.initRNG(ORAM_RNG_INIT);
+	direct_oram.initServerMem(server_data);
+
+	// Few distinct blocks, so that the queue finds duplicates
+	std::mt19937 gen{0xC0A1E5CE};
+	std::uniform_int_distribution<uint64_t> addr_dist{0, 11};
+	std::uniform_int_distribution<int> op_dist{0, 3};
+
+	// Write all blocks once, so that every read has a defined result
+	//--------------------------------------------------------------------------------
+	std::unordered_map<uint64_t, std::array<uint8_t, ORAM_BLOCK_SIZE>> reference;
+	for (uint64_t blk_id = 0; blk_id <= 11; ++blk_id) {
+		reference[blk_id].fill(static_cast<uint8_t>(blk_id));
+		direct_oram.write(blk_id, reference[blk_id].data(), server_data);
+	}
+
+	// Batches of mixed requests, validated against sequential semantics
+	//--------------------------------------------------------------------------------
+	size_t failures = 0;
+	size_t successes = 0;
+	for (int batch = 0; batch < 200; ++batch) {
+		uint32_t tickets[8];
+		std::array<uint8_t, ORAM_BLOCK_SIZE> expected[8];
+		bool is_read[8];
+
+		for (int i = 0; i < 8; ++i) {
+			const uint64_t blk_id = addr_dist(gen);
+			is_read[i] = (op_dist(gen) != 0);
+			if (is_read[i]) {
+				tickets[i] = queue.read(blk_id);
+				expected[i] = reference[blk_id];
+			}
+			else {
+				reference[blk_id].fill(static_cast<uint8_t>(batch * 8 + i));
+				tickets[i] = queue.write(blk_id, reference[blk_id].data());
+			}
+		}
+		queue.flush(direct_oram, server_data);
+
+		std::array<uint8_t, ORAM_BLOCK_SIZE> oram_data;
+		for (int i = 0; i < 8; ++i) {
+			if (!is_read[i]) continue;
+			queue.result(tickets[i], oram_data.data());
+			if (oram_data == expected[i]) successes += 1;
+			else                          failures += 1;
+		}
+	}
+
+	// Written blocks must have reached the ORAM
+	std::array<uint8_t, ORAM_BLOCK_SIZE> oram_data;
+	for (const auto& entry : reference) {
+		direct_oram.read(entry.first, oram_data.data(), server_data);
+		if (oram_data == entry.second) successes += 1;
+		else                           failures += 1;
+	}
+
+	const ORAMCoalescerCounters& cnt = queue.counters();
+	std::cout << "Successful tests: " << successes << "\nFailed tests: " << failures << std::endl;
+	std::cout << "Requests: " << cnt.requests << ", ORAM accesses: " << cnt.accesses
+	          << ", coalescing rate: " << (1.0 - double(cnt.accesses) / double(cnt.requests)) << std::endl;
+
+	return failures;
+}
+
+
+size_t test_coalesced_loaders() {
+	// A layer of weights and one of thresholds, several elements per block,
+	// loaded directly and through a request coalescer from the same ORAM
+	constexpr unsigned SIMD = 8, PE = 4, TILES = 12, NF = 6, NumTH = 3;
+	using WT = ap_int<4>;
+	using TA = ap_int<16>;
+	using ORAM = FPGAPathORAM2<ORAM_HEIGHT, ORAM_BLOCK_SIZE, ORAM_BUCKET_SIZE>;
+	using Coalescer = ORAMRequestCoalescer<ORAM, 8>;
+	static ORAM param_oram;
+	static Coalescer queue;
+	static uint8_t server_data[ORAM_SERVER_SIZE];
+
+	std::cout << "Initializing ORAM with layer parameters" << std::endl;
+	param_oram.initRNG(ORAM_RNG_INIT);
+	param_oram.initServerMem(server_data);
+
+	const WeightAddressTranslator<1> watu{ORAM_BLOCK_SIZE, {SIMD}, {WT::width}, {PE}, {TILES}};
+	const ThresholdAddressTranslator<1> tatu{ORAM_BLOCK_SIZE, {NF}, {PE}, {NumTH}, {TA::width}, watu.start_block(0) + watu.block_count(0)};
+
+	// Random parameters, packed into their blocks as the translators lay them out
+	//--------------------------------------------------------------------------------
+	std::mt19937 gen{0x10AD};
+	std::unordered_map<uint64_t, std::array<uint8_t, ORAM_BLOCK_SIZE>> blocks;
+	static FixedPointWeights<SIMD, WT, PE, TILES> expected_w, direct_w, coalesced_w;
+	static ThresholdsActivation<NF, PE, NumTH, TA, ap_uint<2>> expected_t, direct_t, coalesced_t;
+	for (unsigned pe = 0; pe < PE; ++pe) {
+		for (unsigned tile = 0; tile < TILES; ++tile) {
+			const uint32_t word = static_cast<uint32_t>(gen());
+			expected_w.m_weights[pe][tile] = word;
+			const std::pair<size_t, size_t> block_byte = watu.index_to_block(0, pe, tile);
+			for (size_t i = 0; i < watu.element_size(0); ++i) {
+				blocks[block_byte.first][block_byte.second + i] = static_cast<uint8_t>(word >> (i*8));
+			}
+		}
+		for (unsigned nf = 0; nf < NF; ++nf) {
+			for (unsigned th = 0; th < NumTH; ++th) {
+				const uint16_t word = static_cast<uint16_t>(gen());
+				expected_t.m_thresholds[pe][nf][th] = static_cast<int16_t>(word);
+				const std::pair<size_t, size_t> block_byte = tatu.index_to_block(0, pe, nf, th);
+				for (size_t i = 0; i < tatu.element_size(0); ++i) {
+					blocks[block_byte.first][block_byte.second + i] = static_cast<uint8_t>(word >> (i*8));
+				}
+			}
+		}
+	}
+	for (auto& entry : blocks) {
+		param_oram.write(entry.first, entry.second.data(), server_data);
+	}
+
+	// Both loaders, against the parameters and each other
+	//--------------------------------------------------------------------------------
+	std::array<uint8_t, ORAM_BLOCK_SIZE> block_cache;
+	loadORAMWeights<0, SIMD, WT, PE, TILES>(direct_w, param_oram, watu, block_cache.data(), server_data);
+	loadORAMThresholds<0, NF, PE, NumTH, TA>(direct_t, param_oram, tatu, block_cache.data(), server_data);
+	loadORAMWeightsCoalesced<0, SIMD, WT, PE, TILES>(coalesced_w, queue, param_oram, watu, server_data);
+	loadORAMThresholdsCoalesced<0, NF, PE, NumTH, TA>(coalesced_t, queue, param_oram, tatu, server_data);
+
+	size_t failures = 0;
+	size_t successes = 0;
+	for (unsigned pe = 0; pe < PE; ++pe) {
+		for (unsigned tile = 0; tile < TILES; ++tile) {
+			const bool ok = (direct_w.m_weights[pe][tile] == expected_w.m_weights[pe][tile])
+			             && (coalesced_w.m_weights[pe][tile] == expected_w.m_weights[pe][tile]);
+			if (ok) successes += 1;
+			else    failures += 1;
+		}
+		for (unsigned nf = 0; nf < NF; ++nf) {
+			for (unsigned th = 0; th < NumTH; ++th) {
+				const bool ok = (direct_t.m_thresholds[pe][nf][th] == expected_t.m_thresholds[pe][nf][th])
+				             && (coalesced_t.m_thresholds[pe][nf][th] == expected_t.m_thresholds[pe][nf][th]);
+				if (ok) successes += 1;
+				else    failures += 1;
+			}
+		}
+	}
+
+	// One request per element, one read per distinct block of every queue flush
+	//--------------------------------------------------------------------------------
+	uint64_t expected_accesses = 0;
+	for (unsigned base = 0; base < PE * TILES; base += Coalescer::queue_depth) {
+		std::set<size_t> distinct;
+		for (unsigned e = base; e < std::min(base + Coalescer::queue_depth, PE * TILES); ++e) {
+			distinct.insert(watu.index_to_block(0, e / TILES, e % TILES).first);
+		}
+		expected_accesses += distinct.size();
+	}
+	for (unsigned base = 0; base < PE * NF * NumTH; base += Coalescer::queue_depth) {
+		std::set<size_t> distinct;
+		for (unsigned e = base; e < std::min(base + Coalescer::queue_depth, PE * NF * NumTH); ++e) {
+			distinct.insert(tatu.index_to_block(0, e / (NF * NumTH), (e / NumTH) % NF, e % NumTH).first);
+		}
+		expected_accesses += distinct.size();
+	}
+	const ORAMCoalescerCounters& cnt = queue.counters();
+	if (cnt.requests != PE * TILES + PE * NF * NumTH) failures += 1;
+	if (cnt.accesses != expected_accesses) failures += 1;
+
+	std::cout << "Successful tests: " << successes << "\nFailed tests: " << failures << std::endl;
+	std::cout << "Parameter requests: " << cnt.requests << ", ORAM accesses: " << cnt.accesses
+	          << " (expected " << expected_accesses << ")" << std::endl;
+
+	return failures;
+}
+
+size_t test_oblivious_sort() {
+	// 24-byte records with random keys, against std::sort of the keys
+	constexpr uint32_t record_size = 24;
+	constexpr uint64_t count = 1024;
+	static uint8_t records[count * record_size];
+
+	std::mt19937_64 gen{0x0B11};
+	std::vector<uint64_t> keys(count);
+	for (uint64_t i = 0; i < count; ++i) {
+		keys[i] = gen() % 512;  // with duplicates
+		for (uint32_t b = 0; b < record_size; ++b) {
+			records[i * record_size + b] = static_cast<uint8_t>((b < 8) ? (keys[i] >> (b*8)) : i);
+		}
+	}
+	std::sort(keys.begin(), keys.end());
+
+	ObliviousSorter<record_size, 16>::sort(records, count);
+
+	size_t failures = 0;
+	for (uint64_t i = 0; i < count; ++i) {
+		uint64_t key = 0;
+		for (uint32_t b = 0; b < 8; ++b) {
+			key |= static_cast<uint64_t>(records[i * record_size + b]) << (b*8);
+		}
+		if (key != keys[i]) failures += 1;
+	}
+
+	std::cout << "Oblivious sort test " << ((failures == 0) ? "succeeded" : "failed") << std::endl;
+
+	return failures;
+}
+
+
+size_t test_sqrt_oram() {
+	using ORAM = FPGASqrtORAM<ORAM_BLOCK_COUNT, ORAM_BLOCK_SIZE>;
+	static ORAM sqrt_oram;
+	static uint8_t server_data[ORAM::server_size];
+
+	std::cout << "Initializing square-root ORAM" << std::endl;
+	sqrt_oram.initRNG(ORAM_RNG_INIT);
+	sqrt_oram.initServerMem(server_data);
+
+	// Write every block once, then read them many times
+	//--------------------------------------------------------------------------------
+	std::array<uint8_t, ORAM_BLOCK_SIZE> block;
+	for (uint64_t blk_id = 0; blk_id < ORAM_BLOCK_COUNT; ++blk_id) {
+		block.fill(static_cast<uint8_t>(blk_id * 3 + 1));
+		sqrt_oram.write(blk_id, block.data(), server_data);
+	}
+
+	std::mt19937 gen{0x5C0A7E};
+	std::uniform_int_distribution<uint64_t> addr_dist{0, ORAM_BLOCK_COUNT-1};
+	size_t failures = 0;
+	size_t successes = 0;
+	for (int i = 0; i < 10 * ORAM_BLOCK_COUNT; ++i) {
+		const uint64_t blk_id = addr_dist(gen);
+		sqrt_oram.read(blk_id, block.data(), server_data);
+
+		std::array<uint8_t, ORAM_BLOCK_SIZE> expected;
+		expected.fill(static_cast<uint8_t>(blk_id * 3 + 1));
+		if (block == expected) successes += 1;
+		else                   failures += 1;
+	}
+
+	std::cout << "Successful tests: " << successes << "\nFailed tests: " << failures << std::endl;
+
+	return failures;
+}
+
+
+size_t test_partition_oram() {
+	// 256 blocks over 8 partitions of 124 slots each
+	using ORAM = FPGAPartitionORAM<256, 8, 4, ORAM_BLOCK_SIZE>;
+	static ORAM partition_oram;
+	static uint8_t partition_mem[8][ORAM::partition_server_size];  // a memory per partition
+	uint8_t* server_data[8];
+	for (int p = 0; p < 8; ++p) server_data[p] = partition_mem[p];
+
+	std::cout << "Initializing partition ORAM" << std::endl;
+	partition_oram.initRNG(ORAM_RNG_INIT);
+	partition_oram.initServerMem(server_data);
+
+	std::mt19937 gen{0x9A27};
+	std::uniform_int_distribution<uint64_t> addr_dist{0, 255};
+	std::unordered_map<uint64_t, std::array<uint8_t, ORAM_BLOCK_SIZE>> expected;
+	size_t failures = 0;
+	size_t successes = 0;
+
+	// Single accesses
+	//--------------------------------------------------------------------------------
+	std::array<uint8_t, ORAM_BLOCK_SIZE> oram_data;
+	for (uint64_t blk_id = 0; blk_id < 256; ++blk_id) {
+		expected[blk_id].fill(static_cast<uint8_t>(blk_id));
+		partition_oram.write(blk_id, expected[blk_id].data(), server_data);
+	}
+	for (int i = 0; i < 1000; ++i) {
+		const uint64_t blk_id = addr_dist(gen);
+		partition_oram.read(blk_id, oram_data.data(), server_data);
+		if (oram_data == expected[blk_id]) successes += 1;
+		else                               failures += 1;
+	}
+
+	// Batches of 8 mixed requests, possibly for the same block
+	//--------------------------------------------------------------------------------
+	const uint64_t rounds_before = partition_oram.counters().rounds;
+	for (int batch = 0; batch < 500; ++batch) {
+		ORAMOp ops[8];
+		ORAM::client_block_id blks[8];
+		std::array<uint8_t, ORAM_BLOCK_SIZE> buffers[8];
+		uint8_t* data[8];
+		std::array<uint8_t, ORAM_BLOCK_SIZE> reads[8];
+
+		for (int i = 0; i < 8; ++i) {
+			const uint64_t blk_id = addr_dist(gen) % ((batch % 2) ? 256 : 16);
+			blks[i] = blk_id;
+			data[i] = buffers[i].data();
+			ops[i] = (i % 3 == 0) ? ORAMOp::Write : ORAMOp::Read;
+			if (ops[i] == ORAMOp::Write) {
+				expected[blk_id].fill(static_cast<uint8_t>(batch + i));
+				buffers[i] = expected[blk_id];
+			}
+			else {
+				reads[i] = expected[blk_id];
+			}
+		}
+		partition_oram.accessBatch(8, ops, blks, data, server_data);
+
+		for (int i = 0; i < 8; ++i) {
+			if (ops[i] != ORAMOp::Read) continue;
+			if (buffers[i] == reads[i]) successes += 1;
+			else                        failures += 1;
+		}
+	}
+
+	const PartitionORAMCounters& cnt = partition_oram.counters();
+	std::cout << "Successful tests: " << successes << "\nFailed tests: " << failures << std::endl;
+	std::cout << "Requests: " << cnt.requests << ", rounds: " << cnt.rounds
+	          << " (batched: " << (cnt.rounds - rounds_before) / 500.0 << " per 8 requests)"
+	          << ", cache hits: " << cnt.hits << ", evictions: " << cnt.evictions
+	          << ", max cache: " << cnt.max_cache << std::endl;
+
+	return failures;
+}
+
+
+size_t test_dram_model() {
+	// The same ORAM over modelled DRAM with both address mappings, with a
+	// server larger than the open rows of all banks
+	constexpr uint8_t height = 12;
+	constexpr uint32_t block_size = 64;
+	using ServerPtr = finn::dram::ModeledPtr<uint8_t>;
+	using ORAM = FPGAPathORAM2<height, block_size, ORAM_BUCKET_SIZE, RandomLeaves, ServerPtr>;
+	static ORAM modeled_oram;
+
+	const finn::dram::AddressMapping mappings[] = {finn::dram::AddressMapping::RowBankColumn, finn::dram::AddressMapping::RowColumnBank};
+	const char* const mapping_names[] = {"row:bank:column", "row:column:bank"};
+	size_t total_failures = 0;
+	for (int m = 0; m < 2; ++m) {
+		finn::dram::DramConfig cfg;
+		cfg.mapping = mappings[m];
+		finn::dram::DramModel ddr{cfg};
+		finn::dram::ModeledMemory<uint8_t> server_mem{ddr, ORAM::server_size};
+
+		modeled_oram.initRNG(ORAM_RNG_INIT);
+		modeled_oram.initServerMem(server_mem.ptr());
+		const finn::dram::DramStats init = ddr.stats();
+
+		std::mt19937 gen{0xD4A3};
+		std::uniform_int_distribution<uint64_t> addr_dist{0, ORAM::block_count_N/4 - 1};
+		std::unordered_map<uint64_t, std::array<uint8_t, block_size>> expected;
+		size_t failures = 0;
+		size_t successes = 0;
+		std::array<uint8_t, block_size> oram_data;
+		constexpr int accesses = 2000;
+		for (int i = 0; i < accesses; ++i) {
+			const uint64_t blk_id = addr_dist(gen);
+			if ((i % 2 == 0) || (expected.count(blk_id) == 0)) {
+				auto& block = expected[blk_id];
+				block.fill(static_cast<uint8_t>(blk_id ^ i));
+				modeled_oram.write(blk_id, block.data(), server_mem.ptr());
+			}
+			else {
+				modeled_oram.read(blk_id, oram_data.data(), server_mem.ptr());
+				if (oram_data == expected[blk_id]) successes += 1;
+				else                               failures += 1;
+			}
+		}
+
+		// Every access reads and writes one path of HeightL+1 buckets
+		const finn::dram::DramStats run = ddr.stats() - init;
+		const uint64_t path_bytes = (height + 1) * ORAM_BUCKET_SIZE * (ORAM_BLOCK_ID_SIZE + block_size);
+		const bool traffic_ok = (run.bytes_read == accesses * path_bytes) && (run.bytes_written == accesses * path_bytes);
+
+		std::cout << "DRAM model (" << mapping_names[m] << ") test " << ((failures == 0 && traffic_ok) ? "succeeded" : "failed")
+		          << ": " << static_cast<double>(run.cycles) / accesses << " memory cycles per access, row hit rate "
+		          << run.row_hit_rate() << ", bus utilization " << run.bus_utilization(cfg.burst_cycles()) << std::endl;
+		total_failures += failures + (traffic_ok ? 0 : 1);
+	}
+
+	return total_failures;
 }
 
 
-void test_btree() {
+size_t test_host_driver() {
+	// Asynchronous requests against the controller on a worker thread
+	using Backend = ORAMCSimBackend<16>;
+	static Backend::Queues queues;
+	ORAMInit();
+
+	std::mt19937 gen{0xA5F0};
+	std::uniform_int_distribution<uint64_t> addr_dist{0, ORAM_BLOCK_COUNT/2 - 1};
+	std::unordered_map<uint64_t, std::array<uint8_t, ORAM_BLOCK_SIZE>> expected;
+	size_t failures = 0;
+	size_t successes = 0;
+	uint64_t max_in_flight = 0;
+	{
+		Backend backend{queues, g_server_data};
+		ORAMHostDriver<Backend::Queues> driver{queues};
+
+		// Writes of all blocks, more than the queues hold, without waiting
+		//--------------------------------------------------------------------------------
+		std::array<uint8_t, ORAM_BLOCK_SIZE> block;
+		for (uint64_t blk_id = 0; blk_id < ORAM_BLOCK_COUNT/2; ++blk_id) {
+			expected[blk_id].fill(static_cast<uint8_t>(blk_id * 7));
+			driver.submitWrite(blk_id, expected[blk_id].data());
+			max_in_flight = std::max(max_in_flight, driver.inFlight());
+		}
+
+		// Windows of reads, collected by tag in reverse order
+		//--------------------------------------------------------------------------------
+		for (int window = 0; window < 20; ++window) {
+			uint64_t tags[8];
+			uint64_t blks[8];
+			for (int i = 0; i < 8; ++i) {
+				blks[i] = addr_dist(gen);
+				tags[i] = driver.submitRead(blks[i]);
+			}
+			for (int i = 7; i >= 0; --i) {
+				driver.wait(tags[i], block.data());
+				if (block == expected[blks[i]]) successes += 1;
+				else                            failures += 1;
+			}
+		}
+
+		// Drain the write completions
+		Backend::Queues::Completion completion;
+		while (driver.inFlight() > 0) {
+			if (!driver.poll(completion)) std::this_thread::yield();
+		}
+		if (backend.served() != ORAM_BLOCK_COUNT/2 + 20*8) failures += 1;
+	}
+
+	std::cout << "Host driver test: " << successes << " successful, " << failures << " failed reads"
+	          << ", up to " << max_in_flight << " requests in flight" << std::endl;
+
+	return failures;
+}
+
+
+template<typename Arbitration>
+size_t test_arbiter(const char* name) {
+	// Three clients with prefilled request streams: each writes its blocks and reads them back
+	using ORAM = FPGAPathORAM2<ORAM_HEIGHT, ORAM_BLOCK_SIZE, ORAM_BUCKET_SIZE>;
+	using Arbiter = ORAMArbiter<ORAM, 3, Arbitration>;
+	static ORAM shared_oram;
+	static uint8_t server_data[ORAM_SERVER_SIZE];
+	shared_oram.initRNG(ORAM_RNG_INIT);
+	shared_oram.initServerMem(server_data);
+
+	constexpr uint32_t blocks = 20;
+	hls::stream<typename Arbiter::Request> requests[3];
+	hls::stream<typename Arbiter::Response> responses[3];
+	for (uint32_t c = 0; c < 3; ++c) {
+		for (uint32_t i = 0; i < 2 * blocks; ++i) {
+			typename Arbiter::Request req;
+			req.op = (i < blocks) ? ORAMOp::Write : ORAMOp::Read;
+			req.blk = c * blocks + i % blocks;
+			req.data.fill(static_cast<uint8_t>(c * blocks + i % blocks));
+			req.tag = i;
+			req.last = false;
+			requests[c].write(req);
+		}
+		typename Arbiter::Request close;
+		close.last = true;
+		requests[c].write(close);
+	}
+
+	Arbiter arbiter{shared_oram};
+	arbiter.serve(requests, responses, server_data);
+
+	size_t failures = 0;
+	size_t successes = 0;
+	for (uint32_t c = 0; c < 3; ++c) {
+		for (uint32_t i = 0; i < 2 * blocks; ++i) {
+			const typename Arbiter::Response resp = responses[c].read();
+			bool ok = (resp.tag == i);
+			for (uint32_t b = 0; b < ORAM_BLOCK_SIZE; ++b) {
+				ok &= (resp.data[b] == static_cast<uint8_t>(c * blocks + i % blocks));
+			}
+			if (ok) successes += 1;
+			else    failures += 1;
+		}
+		if (arbiter.counters(c).served != 2 * blocks) failures += 1;
+	}
+
+	std::cout << "Arbiter (" << name << ") test: " << successes << " successful, " << failures << " failed"
+	          << ", waits per client: " << arbiter.counters(0).waits << ' ' << arbiter.counters(1).waits
+	          << ' ' << arbiter.counters(2).waits << std::endl;
+
+	return failures;
+}
+
+
+template<size_t Tables>
+size_t test_cuckoo_map(size_t max_keys) {
+	// Random inserts and erases against std::unordered_map, up to max_keys keys
+	using Map = CuckooHashMap<ap_uint<20>, uint64_t, 256, Tables, 4>;
+	static Map map;
+	std::unordered_map<uint32_t, uint64_t> reference;
+
+	std::mt19937 gen{0xC0C0};
+	std::uniform_int_distribution<uint32_t> key_dist{0, (1u << 20) - 1};
+	size_t failures = 0;
+	size_t rejected = 0;
+	for (int i = 0; i < 4000; ++i) {
+		const uint32_t key = key_dist(gen);
+		if ((i % 4 == 3) && !reference.empty()) {
+			const uint32_t victim = reference.begin()->first;
+			map.erase(victim);
+			reference.erase(victim);
+		}
+		else if (reference.size() < max_keys) {
+			const auto it_bool = map.insert({key, i});
+			if (it_bool.second) {
+				reference[key] = i;
+				if (it_bool.first.access(map).first != key) failures += 1;
+			}
+			else if (it_bool.first == map.end()) {
+				rejected += 1;
+			}
+			else if (reference.count(key) == 0) {
+				failures += 1;
+			}
+		}
+	}
+
+	// Every key is found with its value, and iteration visits each exactly once
+	for (const auto& entry : reference) {
+		const auto it = map.find(entry.first);
+		if ((it == map.end()) || (it.access(map).second != entry.second)) failures += 1;
+	}
+	size_t visited = 0;
+	for (auto it = map.begin(); it != map.end(); it.increment(map)) {
+		const auto& kv = it.access(map);
+		if ((reference.count(kv.first) == 0) || (reference[kv.first] != kv.second)) failures += 1;
+		visited += 1;
+	}
+	if ((visited != reference.size()) || (map.size() != reference.size())) failures += 1;
+	for (int i = 0; i < 1000; ++i) {
+		const uint32_t key = key_dist(gen);
+		if (map.contains(key) != (reference.count(key) != 0)) failures += 1;
+	}
+
+	std::cout << "Cuckoo map (" << Tables << " tables) test " << ((failures == 0) ? "succeeded" : "failed") << ": " << map.size() << " keys in "
+	          << Map::capacity << " slots, " << map.stash_count() << " stashed, " << map.kick_count() << " kicks, "
+	          << rejected << " rejected inserts" << std::endl;
+
+	return failures;
+}
+
+
+size_t test_btree() {
 	// Generate input data
 	//--------------------------------------------------------------------------------
 	std::random_device rd;
@@ -158,12 +813,31 @@ void test_btree() {
 	}
 
 	std::cout << "Successful tests: " << successes << "\nFailed tests: " << failures << std::endl;
+
+	return failures;
 }
 
 
 int main() {
-	//test_btree();
-	test_oram();
-
-	return 0;
+	// Failed checks over all tests
+	size_t failures = 0;
+	//failures += test_btree();
+	failures += test_oram();
+	failures += test_siphash();
+	failures += test_prf_position_map();
+	failures += test_oram_prf();
+	failures += test_coalescer();
+	failures += test_coalesced_loaders();
+	failures += test_oblivious_sort();
+	failures += test_sqrt_oram();
+	failures += test_partition_oram();
+	failures += test_dram_model();
+	failures += test_host_driver();
+	failures += test_arbiter<RoundRobinArbitration>("round robin");
+	failures += test_arbiter<FixedPriorityArbitration>("fixed priority");
+	failures += test_cuckoo_map<2>(224);
+	failures += test_cuckoo_map<4>(896);
+
+	std::cout << ((failures == 0) ? "All tests succeeded" : "Some tests failed") << " (" << failures << " failed checks)" << std::endl;
+	return (failures == 0) ? 0 : 1;
 }
@@ -1,11 +1,17 @@
 #include "top.h"
 #include "memory/fpga_binary_tree.h"
+#include "memory/fpga_cuckoo_map.h"
 #include "fpga_path_oram2.h"
 //#include "fpga_path_oram.h"
 
 
 static BinaryTree<uint32_t, uint64_t, 3> btree_test;
+static CuckooHashMap<uint32_t, uint64_t, 8> cuckoo_test;
+#ifdef ORAM_PRF_COUNTER_BITS
+static FPGAPathORAM2<ORAM_HEIGHT, ORAM_BLOCK_SIZE, ORAM_BUCKET_SIZE, PRFLeaves<ORAM_PRF_COUNTER_BITS>> oram;
+#else
 static FPGAPathORAM2<ORAM_HEIGHT, ORAM_BLOCK_SIZE, ORAM_BUCKET_SIZE> oram;
+#endif
 
 
 void ORAMController(uint32_t program_mode, uint32_t oram_op, uint64_t block_addr, uint8_t* block_data, uint8_t* server_data) {
@@ -58,6 +64,26 @@ void ORAMController(uint32_t program_mode, uint32_t oram_op, uint64_t block_addr
 			break;
 		}
 
+		case ProgramMode::CuckooMapRead: {
+			const auto it = cuckoo_test.find(oram_op);
+			if (it != cuckoo_test.end()) {
+				const auto& val = it.access(cuckoo_test).second;
+				for (int i = 0; i < sizeof(uint64_t); ++i) {
+					#pragma HLS pipeline
+					block_data[i] = static_cast<uint8_t>(val >> (i*8));
+				}
+			}
+			break;
+		}
+
+		case ProgramMode::CuckooMapWrite: {
+			const auto it_bool = cuckoo_test.insert({oram_op, block_addr});
+			if (!it_bool.second && (it_bool.first != cuckoo_test.end())) {
+				it_bool.first.access(cuckoo_test).second = block_addr;
+			}
+			break;
+		}
+
 		default: break;
 	}
 }
@@ -6,6 +6,10 @@
 #define ORAM_BLOCK_SIZE 16
 #define ORAM_BUCKET_SIZE 4
 
+// Define to keep only an access counter of this many bits per block in the
+// position map and derive the leaves with a keyed hash (see position_map.h)
+//#define ORAM_PRF_COUNTER_BITS 8
+
 // This should be replaced with a random number securely generated by the user at runtime
 #define ORAM_RNG_INIT (0x6A510E8A2A376982ull)
 
@@ -16,6 +20,8 @@ enum class ProgramMode : uint32_t {
 	AccessORAM = 1,
 	BinaryTreeRead = 2,
 	BinaryTreeWrite = 3,
+	CuckooMapRead = 4,
+	CuckooMapWrite = 5,
 };
 
 
@@ -38,6 +38,14 @@ namespace util {
 		return ((n & (n-1)) == 0) ? integer_log2(n) : (integer_log2(n) + 1);
 	}
 
+	// Smallest r in [lo, hi] with r*r >= n, by bisection, for unsigned T; the
+	// default hi is the largest r whose square fits into T
+	template<typename T>
+	constexpr T ceil_int_sqrt(T n, T lo = 0, T hi = (T{1} << (sizeof(T) * 4)) - 1) {
+		return (lo >= hi) ? lo :
+			((((lo + hi) / 2) * ((lo + hi) / 2) >= n) ? ceil_int_sqrt<T>(n, lo, (lo + hi) / 2) : ceil_int_sqrt<T>(n, (lo + hi) / 2 + 1, hi));
+	}
+
 	template<typename T>
 	constexpr T ceil_div(T lhs, T rhs) {
 		return (lhs == 0) ? 0 : (T{1} + ((lhs - 1) / rhs));
@@ -0,0 +1,209 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  \file perf_model.h
+ *
+ *  Analytic performance model of the library blocks.
+ *
+ *  The cycle counts follow the trip counts of the II=1 pipelined loops of the
+ *  respective implementations, so that the throughput of a dataflow network
+ *  can be estimated from its template parameters without running synthesis.
+ *  Pipeline fill, stream latencies and memory stalls are not modelled.
+ *
+ *  Every block model exposes the compile-time constants
+ *   - cycles_per_frame  cycles to process one frame (image / input vector)
+ *   - ii                initiation interval of its main loop
+ *  and Network<...> finds the bottleneck of a sequence of blocks.
+ *  The underlying constexpr functions can also be evaluated at run time,
+ *  see bench/perf_tool.cpp.
+ *
+ *****************************************************************************/
+
+#ifndef PERF_MODEL_H
+#define PERF_MODEL_H
+
+namespace finn {
+namespace perf {
+
+typedef unsigned long long  cycles_t;
+
+constexpr cycles_t max_cycles(cycles_t const  a, cycles_t const  b) {
+  return  a > b? a : b;
+}
+
+//- Cycle counts per frame ---------------------------------------------------
+
+/** Matrix_Vector_Activate_Batch: NF*SF cycles per input vector. */
+constexpr cycles_t mvau_cycles(unsigned const  MatrixW, unsigned const  MatrixH,
+                               unsigned const  SIMD, unsigned const  PE, unsigned const  Vectors = 1) {
+  return  cycles_t(MatrixH / PE) * (MatrixW / SIMD) * Vectors;
+}
+
+/** ConvolutionInputGenerator: its baseIter. */
+constexpr cycles_t swg_cycles(unsigned const  ConvKernelDim, unsigned const  IFMChannels, unsigned const  IFMDim,
+                              unsigned const  OFMDim, unsigned const  SIMD, unsigned const  Stride = 1) {
+  return  cycles_t(IFMDim) * ConvKernelDim * (IFMChannels / SIMD)
+        + cycles_t(OFMDim) * max_cycles(cycles_t(OFMDim) * ConvKernelDim * ConvKernelDim * (IFMChannels / SIMD),
+                                         cycles_t(Stride) * IFMDim * (IFMChannels / SIMD));
+}
+
+/** StreamingDataWidthConverter_Batch: one cycle per word of the narrower side. */
+constexpr cycles_t dwc_cycles(unsigned const  InWidth, unsigned const  OutWidth, unsigned const  NumInWords) {
+  return  InWidth > OutWidth? cycles_t(NumInWords) * (InWidth / OutWidth) : cycles_t(NumInWords);
+}
+
+/** StreamingMaxPool_Precision: one cycle per input pixel plus the write-out of the pooled rows. */
+constexpr cycles_t maxpool_cycles(unsigned const  ImgDim, unsigned const  PoolDim) {
+  return  cycles_t(ImgDim) * ImgDim + cycles_t(ImgDim / PoolDim) * (ImgDim / PoolDim);
+}
+
+/** AddStreams_Batch: one cycle per PE-wide chunk. */
+constexpr cycles_t add_cycles(unsigned const  NumChannels, unsigned const  PECount, unsigned const  NumTotal) {
+  return  cycles_t(NumTotal) * (NumChannels / PECount);
+}
+
+/** Mem2Stream_Batch / Stream2Mem_Batch: one cycle per memory word. */
+constexpr cycles_t dma_cycles(unsigned const  DataWidth, unsigned const  numBytes) {
+  return  cycles_t(numBytes) / (DataWidth / 8);
+}
+
+/** ConvLayer_Batch: sliding window and MVAU run concurrently, the slower one dominates. */
+constexpr cycles_t convlayer_cycles(unsigned const  ConvKernelDim, unsigned const  IFMChannels, unsigned const  IFMDim,
+                                    unsigned const  OFMChannels, unsigned const  OFMDim,
+                                    unsigned const  SIMD, unsigned const  PE, unsigned const  Stride = 1) {
+  return  max_cycles(swg_cycles(ConvKernelDim, IFMChannels, IFMDim, OFMDim, SIMD, Stride),
+                     mvau_cycles(ConvKernelDim * ConvKernelDim * IFMChannels, OFMChannels, SIMD, PE, OFMDim * OFMDim));
+}
+
+//- Block models -------------------------------------------------------------
+
+/**
+ * \brief   Common interface of the block models
+ */
+template<cycles_t Cycles, unsigned II = 1>
+struct Block {
+  static constexpr cycles_t  cycles_per_frame = Cycles;
+  static constexpr unsigned  ii = II;
+};
+template<cycles_t Cycles, unsigned II>
+constexpr cycles_t Block<Cycles, II>::cycles_per_frame;
+template<cycles_t Cycles, unsigned II>
+constexpr unsigned Block<Cycles, II>::ii;
+
+template<unsigned MatrixW, unsigned MatrixH, unsigned SIMD, unsigned PE, unsigned Vectors = 1>
+struct MVAU : Block<mvau_cycles(MatrixW, MatrixH, SIMD, PE, Vectors)> {
+  static_assert(MatrixW % SIMD == 0, "MatrixW must be a multiple of SIMD");
+  static_assert(MatrixH % PE == 0, "MatrixH must be a multiple of PE");
+};
+
+template<unsigned ConvKernelDim, unsigned IFMChannels, unsigned IFMDim, unsigned OFMDim, unsigned SIMD, unsigned Stride = 1>
+struct ConvolutionInputGenerator : Block<swg_cycles(ConvKernelDim, IFMChannels, IFMDim, OFMDim, SIMD, Stride)> {
+  static_assert(IFMChannels % SIMD == 0, "IFMChannels must be a multiple of SIMD");
+};
+
+template<unsigned InWidth, unsigned OutWidth, unsigned NumInWords>
+struct DataWidthConverter : Block<dwc_cycles(InWidth, OutWidth, NumInWords)> {};
+
+template<unsigned ImgDim, unsigned PoolDim>
+struct MaxPool : Block<maxpool_cycles(ImgDim, PoolDim)> {};
+
+template<unsigned NumChannels, unsigned PECount, unsigned NumTotal>
+struct AddStreams : Block<add_cycles(NumChannels, PECount, NumTotal)> {};
+
+template<unsigned DataWidth, unsigned numBytes>
+struct DMA : Block<dma_cycles(DataWidth, numBytes)> {};
+
+template<unsigned ConvKernelDim, unsigned IFMChannels, unsigned IFMDim, unsigned OFMChannels, unsigned OFMDim,
+         unsigned SIMD, unsigned PE, unsigned Stride = 1>
+struct ConvLayer : Block<convlayer_cycles(ConvKernelDim, IFMChannels, IFMDim, OFMChannels, OFMDim, SIMD, PE, Stride)> {};
+
+template<unsigned MatrixW, unsigned MatrixH, unsigned SIMD, unsigned PE>
+struct FCLayer : MVAU<MatrixW, MatrixH, SIMD, PE> {};
+
+//- Networks -----------------------------------------------------------------
+
+/**
+ * \brief   Dataflow network of blocks
+ *
+ * In a dataflow pipeline, the frame rate is set by the slowest block:
+ * cycles_per_frame is the maximum over the blocks and bottleneck the index
+ * of the first block attaining it. latency_cycles sums all blocks as a
+ * coarse upper bound of the latency of a single frame.
+ */
+template<typename... Blocks>
+struct Network;
+
+template<typename B>
+struct Network<B> {
+  static constexpr cycles_t  cycles_per_frame = B::cycles_per_frame;
+  static constexpr cycles_t  latency_cycles = B::cycles_per_frame;
+  static constexpr unsigned  bottleneck = 0;
+  static constexpr unsigned  size = 1;
+};
+
+template<typename B, typename... Rest>
+struct Network<B, Rest...> {
+  typedef Network<Rest...>  Tail;
+  static constexpr cycles_t  cycles_per_frame = max_cycles(B::cycles_per_frame, Tail::cycles_per_frame);
+  static constexpr cycles_t  latency_cycles = B::cycles_per_frame + Tail::latency_cycles;
+  static constexpr unsigned  bottleneck = B::cycles_per_frame >= Tail::cycles_per_frame? 0 : 1 + Tail::bottleneck;
+  static constexpr unsigned  size = 1 + Tail::size;
+};
+
+template<typename B>
+constexpr cycles_t Network<B>::cycles_per_frame;
+template<typename B>
+constexpr cycles_t Network<B>::latency_cycles;
+template<typename B>
+constexpr unsigned Network<B>::bottleneck;
+template<typename B>
+constexpr unsigned Network<B>::size;
+template<typename B, typename... Rest>
+constexpr cycles_t Network<B, Rest...>::cycles_per_frame;
+template<typename B, typename... Rest>
+constexpr cycles_t Network<B, Rest...>::latency_cycles;
+template<typename B, typename... Rest>
+constexpr unsigned Network<B, Rest...>::bottleneck;
+template<typename B, typename... Rest>
+constexpr unsigned Network<B, Rest...>::size;
+
+/** Frames per second at the given clock frequency. */
+constexpr double frames_per_second(cycles_t const  cycles_per_frame, double const  fclk_mhz) {
+  return  fclk_mhz * 1e6 / cycles_per_frame;
+}
+
+} // namespace perf
+} // namespace finn
+
+#endif
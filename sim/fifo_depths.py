@@ -0,0 +1,104 @@
+#   Copyright (c) 2019, Xilinx, Inc.
+#   All rights reserved.
+# 
+#   Redistribution and use in source and binary forms, with or without 
+#   modification, are permitted provided that the following conditions are met:
+#
+#   1.  Redistributions of source code must retain the above copyright notice, 
+#       this list of conditions and the following disclaimer.
+#
+#   2.  Redistributions in binary form must reproduce the above copyright 
+#       notice, this list of conditions and the following disclaimer in the 
+#       documentation and/or other materials provided with the distribution.
+#
+#   3.  Neither the name of the copyright holder nor the names of its 
+#       contributors may be used to endorse or promote products derived from 
+#       this software without specific prior written permission.
+#
+#   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+#   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+#   THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+#   PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR 
+#   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+#   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+#   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+#   OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+#   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+#   OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+#   ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#  
+#   Merges the stream profiles dumped by the instrumented hls::stream of
+#   sim/hls_stream.h (FINN_STREAM_PROFILE=<file>) and recommends the depths
+#   of the stream declarations.
+#
+#   Usage: python3 fifo_depths.py profile1.csv [profile2.csv ...]
+#
+#   Profiles of several runs (e.g. different inputs or batch sizes) are merged
+#   by taking, per stream declaration, the largest occupancy observed in a
+#   threaded dataflow region (FINN_THREADED_CSIM). Streams only seen in the
+#   sequential C simulation buffer whole batches and get no recommendation.
+#   The result is printed as a FINN_STREAM_DEPTHS value (name=depth pairs),
+#   to be transferred to the STREAM pragmas or used for the next simulation.
+#
+import csv
+import sys
+
+
+def merge(files):
+    streams = {}
+    order = []
+    for name in files:
+        with open(name) as f:
+            for row in csv.DictReader(f):
+                # instance suffixes (#n) identify repeated uses of the same stream declaration
+                key = row["name"].split("#")[0]
+                concurrent = row["concurrent"] == "1"
+                if key not in streams:
+                    order.append(key)
+                    streams[key] = {"occ": 0, "words": 0, "empty": 0, "depth": 0, "concurrent": False, "saturated": False}
+                s = streams[key]
+                s["words"] = max(s["words"], int(row["writes"]))
+                s["empty"] = max(s["empty"], int(row["empty_reads"]))
+                if concurrent:
+                    # saturation is judged by the runs with the deepest streams
+                    depth = int(row["depth"])
+                    saturated = row["saturated"] == "1"
+                    if depth > s["depth"]:
+                        s["depth"], s["saturated"] = depth, saturated
+                    elif depth == s["depth"]:
+                        s["saturated"] |= saturated
+                    s["concurrent"] = True
+                    s["occ"] = max(s["occ"], int(row["max_occupancy"]))
+    return order, streams
+
+
+def main(argv):
+    if len(argv) < 2:
+        print("usage: %s profile.csv [profile.csv ...]" % argv[0])
+        return 1
+    order, streams = merge(argv[1:])
+    print("%-48s %12s %10s %10s" % ("stream", "words", "max occ", "depth"))
+    for key in order:
+        s = streams[key]
+        if s["concurrent"]:
+            print("%-48s %12d %10d %10d%s" % (key, s["words"], s["occ"], max(2, s["occ"]),
+                                              "  saturated" if s["saturated"] else ""))
+        else:
+            print("%-48s %12d %10s %10s" % (key, s["words"], "-", "-"))
+    print("")
+    for key in order:
+        s = streams[key]
+        if s["empty"] != 0:
+            print("# WARNING: %s was read while empty %d times" % (key, s["empty"]))
+        if s["saturated"]:
+            print("# NOTE: %s stayed full, its producer outpaces its consumer" % key)
+    depths = ["%s=%d" % (key, max(2, streams[key]["occ"])) for key in order if streams[key]["concurrent"]]
+    if not depths:
+        print("# No stream was measured in a threaded dataflow region (FINN_THREADED_CSIM)")
+        return 1
+    print("FINN_STREAM_DEPTHS=" + ",".join(depths))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
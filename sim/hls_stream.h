@@ -0,0 +1,441 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/******************************************************************************
+ *
+ *  \file sim/hls_stream.h
+ *
+ *  Instrumented drop-in replacement of hls::stream for C simulation.
+ *
+ *  Put the sim directory in front of the include path, e.g.
+ *    -I$FINN_HLS_ROOT/sim -I$FINN_HLS_ROOT
+ *  and every hls::stream of the design, including the ones internal to the
+ *  library blocks, records its traffic, maximum occupancy and stalls.
+ *  In synthesis the vendor header is used unchanged.
+ *
+ *  The profile is controlled through environment variables:
+ *   - FINN_STREAM_PROFILE=<file>  dump the per-stream statistics as CSV at exit
+ *   - FINN_STREAM_REPORT=1        print the depth report on stderr at exit
+ *   - FINN_STREAM_DEPTHS=<name>=<depth>[,<name>=<depth>...]
+ *                                 depth of the named streams in threaded dataflow
+ *                                 regions (default FINN_STREAM_DEFAULT_DEPTH, 2)
+ *
+ *  The plain C simulation executes the processes of a DATAFLOW region one
+ *  after the other, so a stream buffers everything its producer writes for
+ *  the whole batch. Its occupancy is recorded, but says nothing about the
+ *  depth the hardware needs, and no depth is recommended for it.
+ *
+ *  With FINN_THREADED_CSIM (see dataflow.h), the streams declared inside a
+ *  dataflow region are bounded, lock-free single-producer single-consumer
+ *  ring buffers of their depth, accessed concurrently by the stage threads.
+ *  Full and empty accesses then block as in hardware, and the maximum
+ *  occupancy of these concurrent streams is the basis of the recommended
+ *  depths. Profile with a generous FINN_STREAM_DEFAULT_DEPTH (e.g. 1024):
+ *  a stream that still fills up to its depth is reported as saturated, its
+ *  producer being faster than its consumer, which more depth cannot fix.
+ *  The occupancy depends on how the host schedules the stage threads, so
+ *  profile on a machine with a core per stage.
+ *  The report ends with the recommended depths in the FINN_STREAM_DEPTHS
+ *  format, for the STREAM pragmas of the corresponding declarations.
+ *
+ *****************************************************************************/
+
+#ifndef FINN_SIM_HLS_STREAM_H
+#define FINN_SIM_HLS_STREAM_H
+
+#ifdef __SYNTHESIS__
+#include_next <hls_stream.h>
+#else
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../dataflow.h"
+
+namespace hls {
+
+namespace profile {
+
+/**
+ * \brief   Traffic statistics of a single stream instance
+ */
+struct stream_stats {
+  std::string         name;
+  size_t              depth;          //!< Capacity when bounded (threaded dataflow regions)
+  unsigned long long  writes;
+  unsigned long long  reads;
+  unsigned long long  empty_reads;    //!< Consumer stalls: reads attempted on an empty stream
+  unsigned long long  full_writes;    //!< Producer stalls: writes that found the stream full
+  unsigned long long  empty_polls;    //!< Failed read_nb calls, e.g. of a polling consumer, no stalls
+  unsigned long long  full_polls;     //!< Failed write_nb calls, no stalls
+  size_t              max_occupancy;
+  bool                concurrent;     //!< Bounded stream of a threaded dataflow region
+
+  stream_stats(std::string const &n, size_t const  d)
+    : name(n), depth(d), writes(0), reads(0), empty_reads(0), full_writes(0), empty_polls(0), full_polls(0), max_occupancy(0), concurrent(false) {}
+
+  /** Declaration name, without the instance suffix (#n) of repeated uses. */
+  std::string base_name() const {
+    return  name.substr(0, name.find('#'));
+  }
+
+  /** Whether the producer kept the stream full, i.e. its depth limited the occupancy. */
+  bool saturated() const {
+    return  concurrent && ((full_writes > 0) || (full_polls > 0)) && (max_occupancy >= depth);
+  }
+
+  /**
+   * Recommended depth: the maximum occupancy observed under concurrent
+   * execution, but never below the default of 2, or 0 without such a
+   * measurement (sequential streams).
+   */
+  size_t recommended_depth() const {
+    return  concurrent? std::max<size_t>(2, max_occupancy) : 0;
+  }
+};
+
+/**
+ * \brief   Registry of all streams created during the simulation
+ *
+ * Statistics outlive the streams so that the internal streams of library
+ * blocks, which are destroyed when the block returns, are still reported.
+ */
+class registry {
+  std::vector<std::shared_ptr<stream_stats>>  m_streams;
+  std::map<std::string, unsigned>             m_instances;
+  std::map<std::string, size_t>               m_depths;
+  size_t                                      m_default_depth;
+  std::mutex                                  m_mutex;
+
+  registry() : m_default_depth(2) {
+    char const *const  def = std::getenv("FINN_STREAM_DEFAULT_DEPTH");
+    if(def) {
+      m_default_depth = std::max<size_t>(1, std::strtoul(def, nullptr, 10));
+    }
+    char const *const  depths = std::getenv("FINN_STREAM_DEPTHS");
+    if(depths) {
+      std::istringstream  iss(depths);
+      std::string  item;
+      while(std::getline(iss, item, ',')) {
+        size_t const  eq = item.find('=');
+        if(eq != std::string::npos) {
+          m_depths[item.substr(0, eq)] = std::strtoul(item.c_str() + eq + 1, nullptr, 10);
+        }
+      }
+    }
+  }
+
+  ~registry() {
+    char const *const  csv = std::getenv("FINN_STREAM_PROFILE");
+    if(csv) {
+      std::ofstream  ofs(csv);
+      dump_csv(ofs);
+    }
+    char const *const  rep = std::getenv("FINN_STREAM_REPORT");
+    if(rep && (std::string(rep) != "0")) {
+      report(std::cerr);
+    }
+  }
+
+ public:
+  static registry& instance() {
+    static registry  reg;
+    return  reg;
+  }
+
+  /** Registers a new stream, disambiguating repeated names with an instance suffix. */
+  std::shared_ptr<stream_stats> add(std::string const &name) {
+    std::lock_guard<std::mutex>  lock(m_mutex);
+    std::string const  base = name.empty()? "hls::stream" : name;
+    unsigned const  inst = m_instances[base]++;
+    std::string const  unique = inst == 0? base : base + "#" + std::to_string(inst);
+    auto const  it = m_depths.find(base);
+    size_t const  depth = it == m_depths.end()? m_default_depth : it->second;
+    m_streams.push_back(std::make_shared<stream_stats>(unique, depth));
+    return  m_streams.back();
+  }
+
+  std::vector<std::shared_ptr<stream_stats>> const& streams() const {
+    return  m_streams;
+  }
+
+  /** Forgets all recorded streams, e.g. between independent test cases. */
+  void clear() {
+    std::lock_guard<std::mutex>  lock(m_mutex);
+    m_streams.clear();
+    m_instances.clear();
+  }
+
+  void dump_csv(std::ostream &os) const {
+    os << "name,writes,reads,max_occupancy,empty_reads,full_writes,depth,concurrent,saturated,recommended_depth,empty_polls,full_polls\n";
+    for(auto const &s : m_streams) {
+      os << s->name << ',' << s->writes << ',' << s->reads << ',' << s->max_occupancy << ','
+         << s->empty_reads << ',' << s->full_writes << ',' << s->depth << ','
+         << s->concurrent << ',' << s->saturated() << ',' << s->recommended_depth() << ','
+         << s->empty_polls << ',' << s->full_polls << '\n';
+    }
+  }
+
+  /**
+   * Recommended depths per stream declaration, the largest over its instances,
+   * for the streams measured under concurrent execution only.
+   */
+  std::map<std::string, size_t> recommended_depths() const {
+    std::map<std::string, size_t>  depths;
+    for(auto const &s : m_streams) {
+      if(s->concurrent) {
+        size_t &d = depths[s->base_name()];
+        d = std::max(d, s->recommended_depth());
+      }
+    }
+    return  depths;
+  }
+
+  /** Human-readable report, ending with the recommended depths as a FINN_STREAM_DEPTHS value. */
+  void report(std::ostream &os) const {
+    os << "FIFO depth report (" << m_streams.size() << " streams)\n";
+    os << std::left << std::setw(48) << "stream" << std::right
+       << std::setw(12) << "words" << std::setw(10) << "max occ" << std::setw(8) << "depth"
+       << std::setw(12) << "empty rd" << std::setw(12) << "full wr" << "  mode\n";
+    for(auto const &s : m_streams) {
+      os << std::left << std::setw(48) << s->name << std::right
+         << std::setw(12) << s->writes << std::setw(10) << s->max_occupancy << std::setw(8) << s->depth
+         << std::setw(12) << s->empty_reads << std::setw(12) << s->full_writes
+         << (!s->concurrent? "  sequential" : s->saturated()? "  saturated" : "  concurrent") << '\n';
+    }
+    std::map<std::string, size_t> const  depths = recommended_depths();
+    if(depths.empty()) {
+      os << "No depth recommendation: no stream was measured in a threaded dataflow region (FINN_THREADED_CSIM).\n";
+      return;
+    }
+    os << "FINN_STREAM_DEPTHS=";
+    char const *sep = "";
+    for(auto const &d : depths) {
+      os << sep << d.first << '=' << d.second;
+      sep = ",";
+    }
+    os << '\n';
+  }
+};
+
+} // namespace profile
+
+/**
+ * \brief   Instrumented FIFO stream with the interface of the vendor hls::stream
+ */
+template<typename __STREAM_T__>
+class stream {
+  std::shared_ptr<profile::stream_stats>  m_stats;
+
+  // unbounded storage, used outside of threaded dataflow regions
+  std::deque<__STREAM_T__>  m_data;
+
+#ifdef FINN_DATAFLOW_THREADED
+  // bounded lock-free SPSC ring, used inside threaded dataflow regions
+  finn::dataflow::Region     *m_region;
+  std::vector<__STREAM_T__>   m_ring;
+  std::atomic<size_t>         m_head;  // total words read
+  std::atomic<size_t>         m_tail;  // total words written
+  mutable std::mutex          m_mutex; // guards m_data in threaded mode
+
+  bool bounded() const { return  !m_ring.empty(); }
+
+  void init() {
+    m_region = finn::dataflow::Region::current();
+    m_head = 0;
+    m_tail = 0;
+    if(m_region)  m_ring.resize(m_stats->depth);
+    m_stats->concurrent = bounded();
+  }
+#else
+  void init() {}
+#endif
+
+  void empty_read(__STREAM_T__ &head) {
+    std::cout << "WARNING: Hls::stream '" << m_stats->name << "' is read while empty, which may result in RTL simulation hanging." << std::endl;
+    head = __STREAM_T__();
+  }
+
+ public:
+  stream() : m_stats(profile::registry::instance().add("")) { init(); }
+  stream(char const *name) : m_stats(profile::registry::instance().add(name? name : "")) { init(); }
+  stream(std::string const &name) : m_stats(profile::registry::instance().add(name)) { init(); }
+
+  // streams are not copyable, as in the vendor implementation
+  stream(stream const&) = delete;
+  stream& operator=(stream const&) = delete;
+
+  ~stream() {
+#ifdef FINN_DATAFLOW_THREADED
+    // the stages of the region may still access this stream
+    if(m_region)  m_region->join();
+#endif
+    if(!empty()) {
+      std::cout << "WARNING: Hls::stream '" << m_stats->name << "' contains leftover data, which may result in RTL simulation hanging." << std::endl;
+    }
+  }
+
+ public:
+#ifdef FINN_DATAFLOW_THREADED
+  size_t size() const {
+    if(bounded())  return  m_tail.load() - m_head.load();
+    std::lock_guard<std::mutex>  lock(m_mutex);
+    return  m_data.size();
+  }
+  bool full() const { return  bounded() && (size() >= m_ring.size()); }
+#else
+  size_t size() const { return  m_data.size(); }
+  bool full() const { return  false; }
+#endif
+  bool empty() const { return  size() == 0; }
+
+  std::string const& name() const { return  m_stats->name; }
+  profile::stream_stats const& stats() const { return  *m_stats; }
+
+  /**
+   * Sets the depth of this stream, i.e. the capacity of a bounded threaded
+   * stream. Equivalent to #pragma HLS STREAM depth, to be called before first use.
+   */
+  void set_depth(size_t const  depth) {
+    m_stats->depth = depth;
+#ifdef FINN_DATAFLOW_THREADED
+    if(bounded() && (m_tail.load() == 0))  m_ring.resize(std::max<size_t>(1, depth));
+#endif
+  }
+
+  void write(__STREAM_T__ const &tail) {
+#ifdef FINN_DATAFLOW_THREADED
+    if(bounded()) {
+      size_t const  t = m_tail.load(std::memory_order_relaxed);
+      size_t const  cap = m_ring.size();
+      if(t - m_head.load(std::memory_order_acquire) >= cap) {
+        m_stats->full_writes++;
+        finn::dataflow::Waiter  w(this, "write to full stream '" + m_stats->name + "'");
+        while(t - m_head.load(std::memory_order_acquire) >= cap)  w.wait();
+      }
+      m_ring[t % cap] = tail;
+      m_tail.store(t + 1, std::memory_order_release);
+      m_stats->writes++;
+      m_stats->max_occupancy = std::max(m_stats->max_occupancy, t + 1 - m_head.load(std::memory_order_relaxed));
+      finn::dataflow::progress().fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    std::lock_guard<std::mutex>  lock(m_mutex);
+    finn::dataflow::progress().fetch_add(1, std::memory_order_relaxed);
+#endif
+    m_data.push_back(tail);
+    m_stats->writes++;
+    m_stats->max_occupancy = std::max(m_stats->max_occupancy, m_data.size());
+  }
+  bool write_nb(__STREAM_T__ const &tail) {
+    if(full()) {
+      m_stats->full_polls++;
+      return  false;
+    }
+    write(tail);
+    return  true;
+  }
+  void operator<<(__STREAM_T__ const &tail) { write(tail); }
+
+  __STREAM_T__ read() {
+    __STREAM_T__  head;
+    read(head);
+    return  head;
+  }
+  void read(__STREAM_T__ &head) {
+#ifdef FINN_DATAFLOW_THREADED
+    if(bounded()) {
+      size_t const  h = m_head.load(std::memory_order_relaxed);
+      if(m_tail.load(std::memory_order_acquire) == h) {
+        m_stats->empty_reads++;
+        finn::dataflow::Waiter  w(this, "read from empty stream '" + m_stats->name + "'");
+        while(m_tail.load(std::memory_order_acquire) == h)  w.wait();
+      }
+      head = m_ring[h % m_ring.size()];
+      m_head.store(h + 1, std::memory_order_release);
+      m_stats->reads++;
+      finn::dataflow::progress().fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    std::unique_lock<std::mutex>  lock(m_mutex);
+    if(m_data.empty()) {
+      m_stats->empty_reads++;
+      if(finn::dataflow::live_stages() == 0) {
+        // nobody left to produce, behave as the sequential simulation
+        empty_read(head);
+        return;
+      }
+      finn::dataflow::Waiter  w(this, "read from empty stream '" + m_stats->name + "'");
+      while(m_data.empty()) {
+        lock.unlock();
+        w.wait();
+        lock.lock();
+      }
+    }
+    finn::dataflow::progress().fetch_add(1, std::memory_order_relaxed);
+#else
+    if(m_data.empty()) {
+      m_stats->empty_reads++;
+      empty_read(head);
+      return;
+    }
+#endif
+    head = m_data.front();
+    m_data.pop_front();
+    m_stats->reads++;
+  }
+  bool read_nb(__STREAM_T__ &head) {
+    if(empty()) {
+      m_stats->empty_polls++;
+      return  false;
+    }
+    read(head);
+    return  true;
+  }
+  void operator>>(__STREAM_T__ &head) { read(head); }
+};
+
+} // namespace hls
+
+#endif
+#endif
@@ -48,6 +48,9 @@
 #ifndef STREAMTOOLS_H
 #define STREAMTOOLS_H
 
+#include "dataflow.h"
+#include "interpret.hpp"
+
 
 /**
  * \brief   Stream limiter - limits the number of stream packets
@@ -258,6 +261,35 @@ template<unsigned int InWidth,
 >
 void StreamingDataWidthConverter_Batch(hls::stream<ap_uint<InWidth> > & in,
 		hls::stream<ap_uint<OutWidth> > & out, const unsigned int numReps) {
+#ifdef FINN_NATIVE_CSIM
+  if ((InWidth <= 64) && (OutWidth <= 64) && (InWidth != OutWidth)) {
+    // C-simulation fast path on native integers
+    if (InWidth > OutWidth) {
+      CASSERT_DATAFLOW(InWidth % OutWidth == 0);
+      for (unsigned int t = 0; t < NumInWords * numReps; t++) {
+        uint64_t ei = in.read().to_uint64();
+        for (unsigned int o = 0; o < InWidth / OutWidth; o++) {
+          out.write(ap_uint<OutWidth>(ei & finn::native::mask(OutWidth)));
+          ei >>= OutWidth % 64;
+        }
+      }
+    } else {
+      CASSERT_DATAFLOW(OutWidth % InWidth == 0);
+      const unsigned int inPerOut = OutWidth / InWidth;
+      uint64_t eo = 0;
+      unsigned int i = 0;
+      for (unsigned int t = 0; t < NumInWords * numReps; t++) {
+        eo |= in.read().to_uint64() << ((i * InWidth) % 64);
+        if (++i == inPerOut) {
+          out.write(ap_uint<OutWidth>(eo));
+          eo = 0;
+          i = 0;
+        }
+      }
+    }
+    return;
+  }
+#endif
   if (InWidth > OutWidth) {
     // emit multiple output words per input word read
     CASSERT_DATAFLOW(InWidth % OutWidth == 0);
@@ -467,14 +499,289 @@ template <unsigned int NumChannels,
 void AddStreamsLayer_Batch(hls::stream<ap_uint<NumChannels * In1_t::width>> &in1, hls::stream<ap_uint<NumChannels * In2_t::width>> &in2,
                            hls::stream<ap_uint<NumChannels * Out_t::width>> &out, const unsigned int numReps) {
 #pragma HLS INLINE
+  FINN_DATAFLOW_REGION;
   CASSERT_DATAFLOW(NumChannels % PECount == 0);
   hls::stream<ap_uint<PECount * In1_t::width>> in_folded1;
   hls::stream<ap_uint<PECount * In2_t::width>> in_folded2;
   hls::stream<ap_uint<PECount * Out_t::width>> out_folded;
-  StreamingDataWidthConverter_Batch<NumChannels * In1_t::width, PECount * In1_t::width, NumTotal>(in1, in_folded1, numReps);
-  StreamingDataWidthConverter_Batch<NumChannels * In2_t::width, PECount * In2_t::width, NumTotal>(in2, in_folded2, numReps);
-  AddStreams_Batch<PECount, In1_t, In2_t, Out_t, NumTotal *(NumChannels / PECount),offset>(in_folded1, in_folded2, out_folded, numReps);
-  StreamingDataWidthConverter_Batch<PECount * Out_t::width, NumChannels * Out_t::width, NumTotal *(NumChannels / PECount)>(out_folded, out, numReps);
+  FINN_DATAFLOW_STAGE(StreamingDataWidthConverter_Batch<NumChannels * In1_t::width, PECount * In1_t::width, NumTotal>(in1, in_folded1, numReps));
+  FINN_DATAFLOW_STAGE(StreamingDataWidthConverter_Batch<NumChannels * In2_t::width, PECount * In2_t::width, NumTotal>(in2, in_folded2, numReps));
+  FINN_DATAFLOW_STAGE(AddStreams_Batch<PECount, In1_t, In2_t, Out_t, NumTotal *(NumChannels / PECount),offset>(in_folded1, in_folded2, out_folded, numReps));
+  FINN_DATAFLOW_STAGE(StreamingDataWidthConverter_Batch<PECount * Out_t::width, NumChannels * Out_t::width, NumTotal *(NumChannels / PECount)>(out_folded, out, numReps));
+}
+
+/**
+ * \brief   Layout of the records a StreamProbe_Batch puts on the debug bus
+ *
+ * The debug bus is a daisy chain of records from probe to probe: every
+ * probe forwards the records of its upstream probes and interleaves its
+ * own. A record carries a snapshot of the COUNTERS counters of one probe,
+ * counted in chain order from 0, which StreamProbeCollect stores at offset
+ * probe * COUNTERS. Bits 30:0 of the record hold the probe, bit 31 marks
+ * the final snapshot of a batch, and counter c occupies bits 32*(c+1) and up.
+ */
+struct StreamProbeBus {
+  static unsigned const  WORDS    = 0;  // words forwarded
+  static unsigned const  STARVED  = 1;  // cycles the input was empty
+  static unsigned const  STALLED  = 2;  // cycles the output was full
+  static unsigned const  COUNTERS = 3;
+
+  typedef ap_uint<32 * (COUNTERS + 1)>  Record;
+
+  static Record record(unsigned const  probe, bool const  last,
+                       ap_uint<32> const  words, ap_uint<32> const  starved, ap_uint<32> const  stalled) {
+#pragma HLS INLINE
+    Record  r;
+    r(30, 0) = probe;
+    r[31] = last;
+    r(32 * WORDS + 63,   32 * WORDS + 32)   = words;
+    r(32 * STARVED + 63, 32 * STARVED + 32) = starved;
+    r(32 * STALLED + 63, 32 * STALLED + 32) = stalled;
+    return  r;
+  }
+  static unsigned probe(Record const &r) {
+    return  r(30, 0);
+  }
+  static bool last(Record const &r) {
+    return  r[31];
+  }
+  static ap_uint<32> counter(Record const &r, unsigned const  c) {
+    return  r(32 * c + 63, 32 * c + 32);
+  }
+};
+
+/**
+ * \brief   Stream probe loop - Forwards a stream and counts its words, empty input and full output cycles
+ *
+ * In synthesis, the loop polls both streams at II=1 with a single word of
+ * buffering, so that it adds a register stage but no throughput loss, and
+ * counts the iterations in which it had nothing to read or could not write.
+ * In C simulation, it counts the blocking accesses instead, which only
+ * happen with the threaded dataflow simulation (see dataflow.h).
+ *
+ * \tparam     DataWidth    Width, in number of bits, of the streams
+ *
+ * \param      in           Input stream
+ * \param      out          Output stream
+ * \param      numWords     Number of words to be forwarded
+ * \param      words        Incremented for every word forwarded
+ * \param      starved      Incremented for every cycle the input was empty
+ * \param      stalled      Incremented for every cycle the output was full
+ */
+template<unsigned int DataWidth>
+void StreamProbeLoop(hls::stream<ap_uint<DataWidth> > &in, hls::stream<ap_uint<DataWidth> > &out, unsigned const  numWords,
+                     ap_uint<32> &words, ap_uint<32> &starved, ap_uint<32> &stalled) {
+#pragma HLS INLINE
+#ifdef __SYNTHESIS__
+  ap_uint<DataWidth>  buf;
+  bool  have = false;
+  for(unsigned  i = 0; i < numWords; ) {
+#pragma HLS PIPELINE II=1
+    if(!have) {
+      have = in.read_nb(buf);
+      if(!have)  starved++;
+    }
+    if(have) {
+      if(out.write_nb(buf)) {
+        have = false;
+        words++;
+        i++;
+      }
+      else  stalled++;
+    }
+  }
+#else
+  for(unsigned  i = 0; i < numWords; i++) {
+    if(in.empty())  starved++;
+    ap_uint<DataWidth> const  w = in.read();
+    if(out.full())  stalled++;
+    out.write(w);
+    words++;
+  }
+#endif
+}
+
+/**
+ * \brief   Stream probe forwarder - Forwards a stream and offers a counter snapshot after every frame
+ *
+ * The snapshots of all but the final frame are offered with write_nb and
+ * dropped while the publisher is behind, so that the forwarded stream
+ * never waits on the debug bus. The final snapshot, marked last, is
+ * written after the last word.
+ *
+ * \tparam     DataWidth    Width, in number of bits, of the streams
+ * \tparam     NumTotal     Number of words per frame
+ * \tparam     Probe        Position of the probe on the debug bus
+ *
+ * \param      in           Input stream
+ * \param      out          Output stream
+ * \param      snapshots    Counter snapshots to the publisher
+ * \param      numReps      Number of frames / images
+ */
+template<unsigned int DataWidth, unsigned int NumTotal, unsigned int Probe>
+void StreamProbeForward(hls::stream<ap_uint<DataWidth> > &in, hls::stream<ap_uint<DataWidth> > &out,
+                        hls::stream<StreamProbeBus::Record> &snapshots, unsigned const  numReps) {
+  ap_uint<32>  words = 0, starved = 0, stalled = 0;
+#ifdef __SYNTHESIS__
+  ap_uint<DataWidth>  buf;
+  bool  have = false;
+  unsigned  pos = 0;
+  for(unsigned  i = 0; i < numReps * NumTotal; ) {
+#pragma HLS PIPELINE II=1
+    if(!have) {
+      have = in.read_nb(buf);
+      if(!have)  starved++;
+    }
+    if(have) {
+      if(out.write_nb(buf)) {
+        have = false;
+        words++;
+        i++;
+        if(++pos == NumTotal) {
+          pos = 0;
+          snapshots.write_nb(StreamProbeBus::record(Probe, false, words, starved, stalled));
+        }
+      }
+      else  stalled++;
+    }
+  }
+#else
+  for(unsigned  rep = 0; rep < numReps; rep++) {
+    StreamProbeLoop<DataWidth>(in, out, NumTotal, words, starved, stalled);
+    snapshots.write_nb(StreamProbeBus::record(Probe, false, words, starved, stalled));
+  }
+#endif
+  snapshots.write(StreamProbeBus::record(Probe, true, words, starved, stalled));
+}
+
+/**
+ * \brief   Stream probe publisher - Merges the snapshots of a probe into the debug bus
+ *
+ * Forwards the records of the NumUpstream probes before it and its own
+ * snapshots until it has passed the final record of each of them.
+ *
+ * \tparam     NumUpstream  Number of probes before this one on the debug bus
+ *
+ * \param      snapshots    Counter snapshots of the probe
+ * \param      bus_in       Debug bus from the upstream probe
+ * \param      bus_out      Debug bus to the downstream probe or StreamProbeCollect
+ */
+template<unsigned int NumUpstream>
+void StreamProbePublish(hls::stream<StreamProbeBus::Record> &snapshots,
+                        hls::stream<StreamProbeBus::Record> &bus_in, hls::stream<StreamProbeBus::Record> &bus_out) {
+  unsigned  upstream = 0;
+  bool  done = false;
+  StreamProbeBus::Record  r;
+#ifdef __SYNTHESIS__
+  while(!done || (upstream < NumUpstream)) {
+#pragma HLS PIPELINE II=1
+    if(bus_in.read_nb(r)) {
+      if(StreamProbeBus::last(r))  upstream++;
+      bus_out.write(r);
+    }
+    else if(snapshots.read_nb(r)) {
+      done = StreamProbeBus::last(r);
+      bus_out.write(r);
+    }
+  }
+#else
+  while(!done) {
+    r = snapshots.read();
+    done = StreamProbeBus::last(r);
+    bus_out.write(r);
+    while(!bus_in.empty()) {
+      r = bus_in.read();
+      if(StreamProbeBus::last(r))  upstream++;
+      bus_out.write(r);
+    }
+  }
+  while(upstream < NumUpstream) {
+    r = bus_in.read();
+    if(StreamProbeBus::last(r))  upstream++;
+    bus_out.write(r);
+  }
+#endif
+}
+
+/**
+ * \brief   Stream probe - Pass-through stage reporting the stalls of a stream onto a debug bus
+ *
+ * To be inserted between two stages of a dataflow region, e.g. between
+ * StreamingFCLayer_Batch or ConvLayer_Batch instances, to tell a starving
+ * consumer (many STARVED cycles) from a back-pressured producer (many
+ * STALLED cycles). Costs the forwarding register, three counters and the
+ * publisher merging the debug bus.
+ * After every frame, the probe puts a snapshot of its counters, accumulated
+ * over the frames so far, on the debug bus, so that a stalled pipeline
+ * still reports up to its last complete frame. The stream never waits on
+ * the bus: a snapshot is skipped while the bus is behind, and only the
+ * final one of the batch is guaranteed.
+ *
+ * \tparam     DataWidth    Width, in number of bits, of the streams
+ * \tparam     NumTotal     Number of words per frame
+ * \tparam     NumUpstream  Number of probes before this one on the debug bus
+ *
+ * \param      in           Input stream
+ * \param      out          Output stream
+ * \param      bus_in       Debug bus from the upstream probe
+ * \param      bus_out      Debug bus to the downstream probe or StreamProbeCollect
+ * \param      numReps      Number of frames / images
+ */
+template<unsigned int DataWidth, unsigned int NumTotal, unsigned int NumUpstream>
+void StreamProbe_Batch(hls::stream<ap_uint<DataWidth> > &in, hls::stream<ap_uint<DataWidth> > &out,
+                       hls::stream<StreamProbeBus::Record> &bus_in, hls::stream<StreamProbeBus::Record> &bus_out,
+                       unsigned const  numReps) {
+#pragma HLS DATAFLOW
+  FINN_DATAFLOW_REGION;
+  hls::stream<StreamProbeBus::Record>  snapshots("StreamProbe_Batch.snapshots");
+  FINN_DATAFLOW_STAGE(StreamProbeForward<DataWidth, NumTotal, NumUpstream>(in, out, snapshots, numReps));
+  FINN_DATAFLOW_STAGE(StreamProbePublish<NumUpstream>(snapshots, bus_in, bus_out));
+}
+
+/**
+ * \brief   Stream probe - First probe of a debug bus
+ *
+ * \tparam     DataWidth    Width, in number of bits, of the streams
+ * \tparam     NumTotal     Number of words per frame
+ *
+ * \param      in           Input stream
+ * \param      out          Output stream
+ * \param      bus_out      Debug bus to the downstream probe or StreamProbeCollect
+ * \param      numReps      Number of frames / images
+ */
+template<unsigned int DataWidth, unsigned int NumTotal>
+void StreamProbe_Batch(hls::stream<ap_uint<DataWidth> > &in, hls::stream<ap_uint<DataWidth> > &out,
+                       hls::stream<StreamProbeBus::Record> &bus_out, unsigned const  numReps) {
+  StreamProbeForward<DataWidth, NumTotal, 0>(in, out, bus_out, numReps);
+}
+
+/**
+ * \brief   Stream probe collector - Stores the debug bus of NumProbes probes into a counter array
+ *
+ * The counter array is meant to be mapped to AXI-lite, e.g.
+ *
+ *   #pragma HLS INTERFACE s_axilite port=counters bundle=control
+ *
+ * Every snapshot overwrites the counters of its probe, so that the host can
+ * follow a running batch. Once all probes have delivered their final
+ * snapshot, the array holds the counters of the whole batch.
+ *
+ * \tparam     NumProbes    Number of probes on the debug bus
+ *
+ * \param      bus          Debug bus from the last probe
+ * \param      counters     NumProbes * StreamProbeBus::COUNTERS counters, see StreamProbeBus
+ */
+template<unsigned int NumProbes>
+void StreamProbeCollect(hls::stream<StreamProbeBus::Record> &bus, ap_uint<32> *counters) {
+  unsigned  done = 0;
+  while(done < NumProbes) {
+    StreamProbeBus::Record const  r = bus.read();
+    unsigned const  base = StreamProbeBus::probe(r) * StreamProbeBus::COUNTERS;
+    for(unsigned  c = 0; c < StreamProbeBus::COUNTERS; c++) {
+      counters[base + c] = StreamProbeBus::counter(r, c);
+    }
+    if(StreamProbeBus::last(r))  done++;
+  }
 }
 
 template<unsigned IW, unsigned OW, unsigned N>
@@ -483,6 +790,16 @@ template<unsigned IW, unsigned OW, unsigned N>
 
  public:
   WidthAdjustedInputStream(hls::stream<ap_uint<IW> >&  source, unsigned const  reps) {
+#ifdef FINN_DATAFLOW_THREADED
+    // run the converter as a stage of the enclosing threaded dataflow region
+    if(finn::dataflow::Region::current()) {
+      hls::stream<ap_uint<IW>> *const  src = &source;
+      finn::dataflow::spawn([this, src, reps]() {
+        StreamingDataWidthConverter_Batch<IW, OW, N>(*src, m_target, reps);
+      });
+      return;
+    }
+#endif
     StreamingDataWidthConverter_Batch<IW, OW, N>(source, m_target, reps);
   }
   ~WidthAdjustedInputStream() {}
@@ -513,10 +830,26 @@ class WidthAdjustedOutputStream {
   hls::stream<ap_uint<IW>>  m_buffer;
   hls::stream<ap_uint<OW>> &m_target;
   unsigned const  m_reps;
+#ifdef FINN_DATAFLOW_THREADED
+  bool  m_spawned;
+#endif
   
  public:
-  WidthAdjustedOutputStream(hls::stream<ap_uint<OW> >&  target, unsigned const  reps) : m_target(target), m_reps(reps) {}
+  WidthAdjustedOutputStream(hls::stream<ap_uint<OW> >&  target, unsigned const  reps) : m_target(target), m_reps(reps) {
+#ifdef FINN_DATAFLOW_THREADED
+    // in a threaded dataflow region, the converter runs concurrently with the producer
+    m_spawned = finn::dataflow::Region::current() != nullptr;
+    if(m_spawned) {
+      finn::dataflow::spawn([this]() {
+        StreamingDataWidthConverter_Batch<IW, OW, N>(m_buffer, m_target, m_reps);
+      });
+    }
+#endif
+  }
   ~WidthAdjustedOutputStream() {
+#ifdef FINN_DATAFLOW_THREADED
+    if(m_spawned)  return;
+#endif
     StreamingDataWidthConverter_Batch<IW, OW, N>(m_buffer, m_target, m_reps);
   }
 
@@ -48,22 +48,30 @@
 #include "ap_int.h"
 #include "weights.hpp"
 #include "bnn-library.h"
-#include "memdata.h"
+#include <type_traits>
 #include "config.h"
+#include "param_file.hpp"
 #include "activations.hpp"
 #include "weights.hpp"
 #include "activations.hpp"
 #include "interpret.hpp"
 #include "mvau.hpp"
 #include "conv.hpp"
+#include "gemm.hpp"
 using namespace hls;
 using namespace std;
 
 #define MAX_IMAGES 1
 void Testbench_conv(stream<ap_uint<IFM_Channels1*INPUT_PRECISION> > & in, stream<ap_uint<OFM_Channels1*ACTIVATION_PRECISION> > & out, unsigned int numReps);
 
-int main()
+// Weights of the golden model, loaded from params.bin of gen_weigths.py
+typedef std::conditional<WIDTH == 1, BinaryWeights<SIMD1, PE1, TILE1>,
+                         FixedPointWeights<SIMD1, ap_int<WIDTH>, PE1, TILE1> >::type Weights;
+
+int main(int argc, char *argv[])
 {
+	static Weights weights;
+	ParamFile(param_file::path(argc, argv)).load("weights", weights);
 	static	ap_uint<INPUT_PRECISION> IMAGE[MAX_IMAGES][IFMDim1*IFMDim1][IFM_Channels1];
 	static	ap_int<ACTIVATION_PRECISION> TEST[MAX_IMAGES][OFMDim1][OFMDim1][OFM_Channels1];
 	stream<ap_uint<IFM_Channels1*INPUT_PRECISION> > input_stream("input_stream");
@@ -98,9 +106,9 @@ int main()
 		for (unsigned int ox = 0; ox <TX; ox++) {
 			for(int pe=0;pe <PE1;pe++){
 				for(int simd=0;simd<SIMD1;simd++){
-					std::cout << " Value: "  << PARAM::weights.weights(oy*TX + ox)[pe][simd] <<std::endl;
+					std::cout << " Value: "  << weights.weights(oy*TX + ox)[pe][simd] <<std::endl;
 					std::cout << "W1[" << out_chan_count << "][" << kx << "][" << ky << "][" << chan_count << "]"<< std::endl;
-					W1[out_chan_count][kx][ky][chan_count] = PARAM::weights.weights(oy*TX + ox)[pe][simd];
+					W1[out_chan_count][kx][ky][chan_count] = weights.weights(oy*TX + ox)[pe][simd];
 					kx++;
 					if (kx==KERNEL_DIM){
 						kx=0;
@@ -121,7 +129,7 @@ int main()
 			}
 		}
 	}
-	conv<MAX_IMAGES,IFMDim1,OFMDim1,IFM_Channels1,OFM_Channels1, KERNEL_DIM, 1, ap_uint<INPUT_PRECISION> >(IMAGE, W1, TEST);
+	conv_fast<MAX_IMAGES,IFMDim1,OFMDim1,IFM_Channels1,OFM_Channels1, KERNEL_DIM, 1, ap_uint<INPUT_PRECISION> >(IMAGE, W1, TEST);
 	Testbench_conv(input_stream, output_stream, MAX_IMAGES);
 	int err_counter = 0, err_perimage=0;
 	ap_int<ACTIVATION_PRECISION> out_chan;
@@ -8,14 +8,16 @@
 #include "ap_int.h"
 #include "weights.hpp"
 #include "bnn-library.h"
-#include "memdata.h"
+#include <type_traits>
 #include "config.h"
+#include "param_file.hpp"
 #include "activations.hpp"
 #include "weights.hpp"
 #include "activations.hpp"
 #include "interpret.hpp"
 #include "mvau.hpp"
 #include "conv.hpp"
+#include "gemm.hpp"
 using namespace hls;
 using namespace std;
 
@@ -25,8 +27,14 @@ void ConvLayer(stream<ap_uint<IFM_Channels1 * INPUT_PRECISION> > &in, stream<ap_
 // Weight stream generator
 void GenWeightStream(stream<ap_uint<SIMD1 * PE1 * WIDTH> > &paramStreamOut, int const numReps);
 
-int main()
+// Weights of the golden model, loaded from params.bin of gen_weigths.py
+typedef std::conditional<WIDTH == 1, BinaryWeights<SIMD1, PE1, TILE1>,
+                         FixedPointWeights<SIMD1, ap_int<WIDTH>, PE1, TILE1> >::type Weights;
+
+int main(int argc, char *argv[])
 {
+	static Weights weights;
+	ParamFile(param_file::path(argc, argv)).load("weights", weights);
 
 
 	static	ap_uint<INPUT_PRECISION> IMAGE[MAX_IMAGES][IFMDim1*IFMDim1][IFM_Channels1];
@@ -62,10 +70,10 @@ int main()
 		for (unsigned int ox = 0; ox <TX; ox++) {
 			for(int pe=0;pe <PE1;pe++){
 				for(int simd=0;simd<SIMD1;simd++){
-					std::cout << " Value: "  << PARAM::weights.weights(oy*TX + ox)[pe][simd] <<std::endl;
+					std::cout << " Value: "  << weights.weights(oy*TX + ox)[pe][simd] <<std::endl;
 					std::cout << "W1[" << pe + oy * PE1 << "][" << kx << "][" << ky << "][" << simd + chan_count *SIMD1 << "]"<< std::endl;
-					//W1[ pe + oy * PE1 ][kx][ky][simd + chan_count *SIMD1] = PARAM::weights.weights(oy*TX + ox)[pe][simd];
-					W1[ pe + oy * PE1 ][kx][ky][chan_count] = PARAM::weights.weights(oy*TX + ox)[pe][simd];
+					//W1[ pe + oy * PE1 ][kx][ky][simd + chan_count *SIMD1] = weights.weights(oy*TX + ox)[pe][simd];
+					W1[ pe + oy * PE1 ][kx][ky][chan_count] = weights.weights(oy*TX + ox)[pe][simd];
 					//std::cout << " Value: " << W1[ pe + oy * PE1 ][kx][ky][simd + ox *SIMD1] << " " << PARAM::weights.weights(oy*TX + ox)[pe][simd] <<std::endl;
 					kx++;
 					if (kx==KERNEL_DIM){
@@ -103,7 +111,7 @@ int main()
 	stream<ap_uint<SIMD1 * PE1 * WIDTH>> paramStream("DoCompute.ParamStrm");
 #pragma HLS STREAM variable=paramStream depth=1
 
-	conv<MAX_IMAGES,IFMDim1,OFMDim1,IFM_Channels1,OFM_Channels1, KERNEL_DIM, 1, ap_uint<INPUT_PRECISION> >(IMAGE, W1, TEST);
+	conv_fast<MAX_IMAGES,IFMDim1,OFMDim1,IFM_Channels1,OFM_Channels1, KERNEL_DIM, 1, ap_uint<INPUT_PRECISION> >(IMAGE, W1, TEST);
 	//ConvLayer_Batch<KERNEL_DIM, IFM_Channels1, IFMDim1, OFM_Channels1, OFMDim1, SIMD1, PE1, Slice<ap_uint<INPUT_PRECISION> >, Slice<ap_int<16> >, Identity >(input_stream, output_stream, PARAM::weights, PassThroughActivation<ap_uint<16>>(), MAX_IMAGES, ap_resource_dsp());
 	GenWeightStream(paramStream, MAX_IMAGES * OFMDim1 * OFMDim1);
 	ConvLayer(input_stream, output_stream, paramStream, MAX_IMAGES);
@@ -0,0 +1,134 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file dataflow_tb.cpp
+ *
+ *  Testbench for the threaded dataflow emulation of the C simulation
+ *
+ *****************************************************************************/
+#include <iostream>
+#include <hls_stream.h>
+#include <cstdlib>
+#define AP_INT_MAX_W 16384
+#include "ap_int.h"
+#include "bnn-library.h"
+
+#include "dataflow_config.h"
+
+#if defined(FINN_DATAFLOW_THREADED) && defined(__linux__)
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+using namespace hls;
+using namespace std;
+
+#define MAX_IMAGES 4
+void Testbench_dataflow(stream<ap_uint<FM_Channels1*PRECISION> > & in, stream<ap_uint<FM_Channels1*PRECISION> > & out, unsigned int numReps);
+
+int main()
+{
+	static	ap_uint<FM_Channels1*PRECISION> IMAGE[MAX_IMAGES][IFMDim1][IFMDim1];
+	stream<ap_uint<FM_Channels1*PRECISION> > input_stream("input_stream");
+	stream<ap_uint<FM_Channels1*PRECISION> > output_stream("output_stream");
+	unsigned int counter = 0;
+	for (unsigned int n_image = 0; n_image < MAX_IMAGES; n_image++) {
+		for (unsigned int oy = 0; oy < IFMDim1; oy++) {
+			for (unsigned int ox = 0; ox < IFMDim1; ox++) {
+				ap_uint<PRECISION*FM_Channels1> input_channel = 0;
+				for(unsigned int channel = 0; channel < FM_Channels1; channel++)
+				{
+					ap_uint<PRECISION> input = (ap_uint<PRECISION>)(counter);
+					input_channel = input_channel >> PRECISION;
+					input_channel(FM_Channels1*PRECISION-1,(FM_Channels1-1)*PRECISION)=input;
+					counter++;
+				}
+				IMAGE[n_image][oy][ox] = input_channel;
+				input_stream.write(input_channel);
+			}
+		}
+	}
+	// upsampling followed by max pooling of the same factor reproduces the input
+	Testbench_dataflow(input_stream, output_stream, MAX_IMAGES);
+	int err_counter = 0, err_perimage=0;
+	for (unsigned int n_image = 0; n_image < MAX_IMAGES; n_image++) {
+		for (unsigned int oy = 0; oy < IFMDim1; oy++) {
+			for (unsigned int ox = 0; ox < IFMDim1; ox++) {
+				ap_uint<FM_Channels1*PRECISION> outElem = output_stream.read();
+				ap_uint<FM_Channels1*PRECISION> EXP = IMAGE[n_image][oy][ox];
+				if (EXP != outElem){
+					std::cout << "ERROR: Expected["<<oy <<"]["<<ox<<"]=" << std::hex << EXP << " actual " <<  outElem << std::dec << std::endl;
+					err_counter ++;
+					err_perimage++;
+				}
+			}
+		}
+		if(err_perimage == 0){
+			std::cout << "Image # " << n_image << " passed the testing."<< std::endl;
+		}
+		else{
+			err_perimage=0;
+			std::cout << "Image # " << n_image << " failed the testing."<< std::endl;
+		}
+	}
+
+#if defined(FINN_DATAFLOW_THREADED) && defined(__linux__)
+	// a pipeline starved of its second image has to be reported as deadlocked
+	setenv("FINN_DEADLOCK_TIMEOUT_MS", "200", 1);
+	pid_t const pid = fork();
+	if(pid == 0) {
+		for (unsigned int i = 0; i < IFMDim1*IFMDim1; i++) {
+			input_stream.write(IMAGE[0][i / IFMDim1][i % IFMDim1]);
+		}
+		Testbench_dataflow(input_stream, output_stream, 2);
+		_exit(0);
+	}
+	int status = 0;
+	waitpid(pid, &status, 0);
+	if(WIFEXITED(status) && WEXITSTATUS(status) != 0){
+		std::cout << "Deadlock detection passed the testing."<< std::endl;
+	}
+	else{
+		std::cout << "ERROR: deadlock was not detected" << std::endl;
+		err_counter++;
+	}
+#endif
+
+	if(err_counter == 0){
+		return 0;
+	}
+	else{
+		return 1;
+	}
+
+}
@@ -0,0 +1,58 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file dataflow_top.cpp
+ *
+ *  HLS Top function with a multi-stage dataflow pipeline (width conversions, upsampling
+ *  and max pooling) for unit testing of the threaded C simulation
+ *
+ *****************************************************************************/
+#include <hls_stream.h>
+using namespace hls;
+#include "ap_int.h"
+#include "bnn-library.h"
+
+
+#include "dataflow_config.h"
+
+void Testbench_dataflow(stream<ap_uint<FM_Channels1*PRECISION> > & in, stream<ap_uint<FM_Channels1*PRECISION> > & out, unsigned int numReps){
+#pragma HLS DATAFLOW
+	FINN_DATAFLOW_REGION;
+	stream<ap_uint<NARROW_WIDTH> > narrow("Testbench_dataflow.narrow");
+	stream<ap_uint<FM_Channels1*PRECISION> > wide("Testbench_dataflow.wide");
+	stream<ap_uint<FM_Channels1*PRECISION> > upsampled("Testbench_dataflow.upsampled");
+	FINN_DATAFLOW_STAGE(StreamingDataWidthConverter_Batch<FM_Channels1*PRECISION, NARROW_WIDTH, IFMDim1*IFMDim1>(in, narrow, numReps));
+	FINN_DATAFLOW_STAGE(StreamingDataWidthConverter_Batch<NARROW_WIDTH, FM_Channels1*PRECISION, IFMDim1*IFMDim1*FM_Channels1*PRECISION/NARROW_WIDTH>(narrow, wide, numReps));
+	FINN_DATAFLOW_STAGE(Upsample_Batch<IFMDim1, FACTOR, FM_Channels1, ap_uint<PRECISION> >(wide, upsampled, numReps));
+	FINN_DATAFLOW_STAGE(StreamingMaxPool_Precision_Batch<OFMDim1, FACTOR, FM_Channels1, ap_uint<PRECISION>, 0, FM_Channels1*PRECISION, FM_Channels1*PRECISION>(upsampled, out, numReps));
+}
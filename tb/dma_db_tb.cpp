@@ -0,0 +1,123 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file dma_db_tb.cpp
+ *
+ *  Testbench for the double-buffered DMA blocks, batch and frame-descriptor queue driven
+ *
+ *****************************************************************************/
+#include <iostream>
+#include <cmath>
+#include <ctime>
+#include <cstring>
+#include <hls_stream.h>
+#include <cstdlib>
+#define AP_INT_MAX_W 16384
+#include "ap_int.h"
+#include "bnn-library.h"
+
+#include "dma_config.h"
+
+using namespace hls;
+using namespace std;
+
+#define MAX_IMAGES 5
+void Testbench_dma_db(ap_uint<WIDTH> * in, ap_uint<WIDTH> * out, unsigned int numReps);
+void Testbench_dma_db_frames(ap_uint<WIDTH> * in, ap_uint<WIDTH> * out,
+		stream<DmaDescriptor> & rd_frames, stream<DmaDescriptor> & wr_frames, unsigned int numFrames);
+
+int main()
+{
+	unsigned int const WORDS = MAX_IMAGES * FRAME_BYTES / (WIDTH / 8);
+	static ap_uint<WIDTH> IN[WORDS + 1];
+	static ap_uint<WIDTH> OUT[WORDS + 1];
+	for (unsigned int i = 0; i <= WORDS; i++) {
+		IN[i] = i * 7 + 1;
+		OUT[i] = 0;
+	}
+	Testbench_dma_db(IN, OUT, MAX_IMAGES);
+	int err_counter = 0;
+	for (unsigned int i = 0; i <= WORDS; i++) {
+		// the word past the last frame must be left untouched
+		ap_uint<WIDTH> const EXP = (i < WORDS)? IN[i] : ap_uint<WIDTH>(0);
+		if (OUT[i] != EXP) {
+			std::cout << "ERROR: Expected[" << i << "]=" << EXP << " actual " << OUT[i] << std::endl;
+			err_counter++;
+		}
+	}
+
+	// frame f gathers two rows of ROW words, split into chunks, from frame f of IN
+	// and scatters them as two planes to a compact region of OUT
+	unsigned int const ROW = 100;
+	stream<DmaDescriptor> rd_frames("rd_frames");
+	stream<DmaDescriptor> wr_frames("wr_frames");
+	for (unsigned int f = 0; f < MAX_IMAGES; f++) {
+		DmaDescriptor rd;
+		rd.offset = f * (WORDS / MAX_IMAGES);
+		rd.words = ROW;
+		rd.rows = 2;
+		rd.rowStride = ROW + 20;
+		rd.planes = 1;
+		rd.planeStride = 0;
+		rd_frames.write(rd);
+		DmaDescriptor wr;
+		wr.offset = f * 2 * ROW;
+		wr.words = ROW;
+		wr.rows = 1;
+		wr.rowStride = 0;
+		wr.planes = 2;
+		wr.planeStride = ROW;
+		wr_frames.write(wr);
+	}
+	for (unsigned int i = 0; i <= WORDS; i++) {
+		OUT[i] = 0;
+	}
+	Testbench_dma_db_frames(IN, OUT, rd_frames, wr_frames, MAX_IMAGES);
+	for (unsigned int i = 0; i <= WORDS; i++) {
+		unsigned int const f = i / (2 * ROW);
+		unsigned int const k = i % (2 * ROW);
+		ap_uint<WIDTH> const EXP = (f < MAX_IMAGES)? IN[f * (WORDS / MAX_IMAGES) + ((k < ROW)? k : k + 20)] : ap_uint<WIDTH>(0);
+		if (OUT[i] != EXP) {
+			std::cout << "ERROR: Frame queue expected[" << i << "]=" << EXP << " actual " << OUT[i] << std::endl;
+			err_counter++;
+		}
+	}
+	if(err_counter == 0){
+		std::cout << "Double-buffered DMA test passed." << std::endl;
+		return 0;
+	}
+	else{
+		return 1;
+	}
+
+}
@@ -0,0 +1,65 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file dma_db_top.cpp
+ *
+ *  HLS Top functions with double-buffered DMA blocks for unit testing
+ *
+ *****************************************************************************/
+#include <hls_stream.h>
+using namespace hls;
+#include "ap_int.h"
+#include "bnn-library.h"
+
+
+#include "dma_config.h"
+
+void Testbench_dma_db(ap_uint<WIDTH> * in, ap_uint<WIDTH> * out, unsigned int numReps){
+#pragma HLS INTERFACE m_axi port=in offset=slave bundle=gmem_rd max_read_burst_length=CHUNK_WORDS
+#pragma HLS INTERFACE m_axi port=out offset=slave bundle=gmem_wr max_write_burst_length=CHUNK_WORDS
+#pragma HLS DATAFLOW
+	stream<ap_uint<WIDTH> > data("data");
+	Mem2Stream_Batch_DoubleBuffered<WIDTH, FRAME_BYTES, CHUNK_WORDS>(in, data, numReps);
+	Stream2Mem_Batch_DoubleBuffered<WIDTH, FRAME_BYTES, CHUNK_WORDS>(data, out, numReps);
+}
+
+void Testbench_dma_db_frames(ap_uint<WIDTH> * in, ap_uint<WIDTH> * out,
+		stream<DmaDescriptor> & rd_frames, stream<DmaDescriptor> & wr_frames, unsigned int numFrames){
+#pragma HLS INTERFACE m_axi port=in offset=slave bundle=gmem_rd max_read_burst_length=CHUNK_WORDS
+#pragma HLS INTERFACE m_axi port=out offset=slave bundle=gmem_wr max_write_burst_length=CHUNK_WORDS
+#pragma HLS DATAFLOW
+	FINN_DATAFLOW_REGION;
+	stream<ap_uint<WIDTH> > data("data");
+	FINN_DATAFLOW_STAGE(Mem2Stream_Chunked<WIDTH, CHUNK_WORDS>(in, rd_frames, data, numFrames));
+	FINN_DATAFLOW_STAGE(Stream2Mem_Chunked<WIDTH, CHUNK_WORDS>(data, wr_frames, out, numFrames));
+}
@@ -0,0 +1,119 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file dma_tb.cpp
+ *
+ *  Testbench for the strided scatter-gather DMA blocks
+ *
+ *****************************************************************************/
+#include <iostream>
+#include <cmath>
+#include <ctime>
+#include <cstring>
+#include <hls_stream.h>
+#include <cstdlib>
+#define AP_INT_MAX_W 16384
+#include "ap_int.h"
+#include "bnn-library.h"
+
+#include "dma_config.h"
+
+using namespace hls;
+using namespace std;
+
+void Testbench_dma(ap_uint<WIDTH> * in, ap_uint<WIDTH> * out,
+		DmaDescriptor const rd_descs[MAX_DESCRIPTORS], DmaDescriptor const wr_descs[MAX_DESCRIPTORS],
+		unsigned int numDescs, unsigned int numReps);
+
+int main()
+{
+	static ap_uint<WIDTH> IN[NUM_REPEAT*MEM_DIM*MEM_DIM];
+	static ap_uint<WIDTH> OUT[NUM_REPEAT*MEM_DIM*MEM_DIM];
+	static ap_uint<WIDTH> EXP[NUM_REPEAT*MEM_DIM*MEM_DIM];
+	for (unsigned int i = 0; i < NUM_REPEAT*MEM_DIM*MEM_DIM; i++) {
+		IN[i] = i + 1;
+		OUT[i] = 0;
+		EXP[i] = 0;
+	}
+	// a 5x6 crop, a full contiguous row and a 2x2x3 block (two planes of every other row)
+	DmaDescriptor rd_descs[MAX_DESCRIPTORS] = {
+		{ 2*MEM_DIM + 3, 6, 5, MEM_DIM, 1, 0 },
+		{ 9*MEM_DIM, MEM_DIM, 1, 0, 1, 0 },
+		{ 11*MEM_DIM + 1, 3, 2, 2*MEM_DIM, 2, MEM_DIM/2 },
+	};
+	// write them back with a different shape, the block as four rows of three words
+	DmaDescriptor wr_descs[MAX_DESCRIPTORS] = {
+		{ 0, 30, 1, 0, 1, 0 },
+		{ 2*MEM_DIM, MEM_DIM, 1, 0, 1, 0 },
+		{ 4*MEM_DIM, 3, 4, MEM_DIM, 1, 0 },
+	};
+	unsigned int const numDescs = 3;
+	for (unsigned int rep = 0; rep < NUM_REPEAT; rep++) {
+		unsigned int const base = rep*MEM_DIM*MEM_DIM;
+		for (unsigned int d = 0; d < numDescs; d++) {
+			// source addresses of the words streamed for this descriptor
+			unsigned int src[MEM_DIM*MEM_DIM], n = 0;
+			DmaDescriptor const &r = rd_descs[d];
+			for (unsigned int p = 0; p < r.planes; p++)
+				for (unsigned int y = 0; y < r.rows; y++)
+					for (unsigned int x = 0; x < r.words; x++)
+						src[n++] = base + r.offset + p*r.planeStride + y*r.rowStride + x;
+			DmaDescriptor const &w = wr_descs[d];
+			unsigned int m = 0;
+			for (unsigned int p = 0; p < w.planes; p++)
+				for (unsigned int y = 0; y < w.rows; y++)
+					for (unsigned int x = 0; x < w.words; x++)
+						EXP[base + w.offset + p*w.planeStride + y*w.rowStride + x] = IN[src[m++]];
+			if (m != n) {
+				std::cout << "ERROR: inconsistent descriptors " << d << std::endl;
+				return 1;
+			}
+		}
+	}
+	Testbench_dma(IN, OUT, rd_descs, wr_descs, numDescs, NUM_REPEAT);
+	int err_counter = 0;
+	for (unsigned int i = 0; i < NUM_REPEAT*MEM_DIM*MEM_DIM; i++) {
+		if (OUT[i] != EXP[i]) {
+			std::cout << "ERROR: Expected[" << i << "]=" << EXP[i] << " actual " << OUT[i] << std::endl;
+			err_counter++;
+		}
+	}
+	if(err_counter == 0){
+		std::cout << "DMA test passed." << std::endl;
+		return 0;
+	}
+	else{
+		return 1;
+	}
+
+}
@@ -0,0 +1,56 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file dma_top.cpp
+ *
+ *  HLS Top function with strided scatter-gather DMA blocks for unit testing
+ *
+ *****************************************************************************/
+#include <hls_stream.h>
+using namespace hls;
+#include "ap_int.h"
+#include "bnn-library.h"
+
+
+#include "dma_config.h"
+
+void Testbench_dma(ap_uint<WIDTH> * in, ap_uint<WIDTH> * out,
+		DmaDescriptor const rd_descs[MAX_DESCRIPTORS], DmaDescriptor const wr_descs[MAX_DESCRIPTORS],
+		unsigned int numDescs, unsigned int numReps){
+#pragma HLS INTERFACE m_axi port=in offset=slave bundle=gmem_rd max_read_burst_length=256 num_read_outstanding=4
+#pragma HLS INTERFACE m_axi port=out offset=slave bundle=gmem_wr max_write_burst_length=256 num_write_outstanding=4
+#pragma HLS DATAFLOW
+	stream<ap_uint<WIDTH> > data("data");
+	Mem2Stream_ScatterGather<WIDTH, MAX_DESCRIPTORS>(in, data, rd_descs, numDescs, MEM_DIM*MEM_DIM, numReps);
+	Stream2Mem_ScatterGather<WIDTH, MAX_DESCRIPTORS>(data, out, wr_descs, numDescs, MEM_DIM*MEM_DIM, numReps);
+}
@@ -0,0 +1,122 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file fifo_profile_tb.cpp
+ *
+ *  Testbench for the instrumented hls::stream of sim/hls_stream.h
+ *
+ *****************************************************************************/
+#include <iostream>
+#include <sstream>
+#include <hls_stream.h>
+#include <cstdlib>
+#define AP_INT_MAX_W 16384
+#include "ap_int.h"
+#include "bnn-library.h"
+
+#include "fifo_profile_config.h"
+
+using namespace hls;
+using namespace std;
+
+#define MAX_IMAGES 3
+void Testbench_fifo_profile(stream<ap_uint<IN_WIDTH> > & in, stream<ap_uint<IN_WIDTH> > & out, unsigned int numReps);
+
+int main()
+{
+	stream<ap_uint<IN_WIDTH> > input_stream("input_stream");
+	stream<ap_uint<IN_WIDTH> > output_stream("output_stream");
+	for (unsigned int i = 0; i < NUM_WORDS * MAX_IMAGES; i++) {
+		input_stream.write(i);
+	}
+	Testbench_fifo_profile(input_stream, output_stream, MAX_IMAGES);
+	int err_counter = 0;
+	for (unsigned int i = 0; i < NUM_WORDS * MAX_IMAGES; i++) {
+		if (output_stream.read() != ap_uint<IN_WIDTH>(i)) {
+			err_counter++;
+		}
+	}
+	output_stream.read(); // one stalled read, to be reported
+	ap_uint<IN_WIDTH> polled;
+	output_stream.read_nb(polled); // one failed poll, which is no stall
+
+	unsigned long long const MID_WORDS = NUM_WORDS * MAX_IMAGES * IN_WIDTH / MID_WIDTH;
+	bool found = false;
+	for (auto const &s : profile::registry::instance().streams()) {
+		if (s->name == "fifo_profile.mid") {
+			found = true;
+			bool ok = (s->writes == MID_WORDS) && (s->reads == MID_WORDS);
+#ifdef FINN_DATAFLOW_THREADED
+			// the converters run concurrently through a bounded stream of the default depth
+			ok = ok && s->concurrent && (s->max_occupancy <= s->depth) &&
+			     (s->recommended_depth() == std::max<size_t>(2, s->max_occupancy));
+#else
+			// the converters run one after the other: the whole batch is buffered, which is no depth measurement
+			ok = ok && !s->concurrent && (s->max_occupancy == MID_WORDS) &&
+			     (s->full_writes == 0) && (s->recommended_depth() == 0);
+#endif
+			if (!ok) {
+				std::cout << "ERROR: wrong statistics for " << s->name << std::endl;
+				err_counter++;
+			}
+		}
+		if ((s->name == "output_stream") && ((s->empty_reads != 1) || (s->empty_polls != 1))) {
+			std::cout << "ERROR: stalled read or failed poll not recorded" << std::endl;
+			err_counter++;
+		}
+	}
+	if (!found) {
+		std::cout << "ERROR: stream fifo_profile.mid not registered" << std::endl;
+		err_counter++;
+	}
+	std::ostringstream report;
+	profile::registry::instance().report(report);
+	std::cout << report.str();
+#ifdef FINN_DATAFLOW_THREADED
+	bool const recommended = report.str().find("FINN_STREAM_DEPTHS=fifo_profile.mid=") != std::string::npos;
+#else
+	bool const recommended = report.str().find("FINN_STREAM_DEPTHS=") == std::string::npos;
+#endif
+	if (!recommended) {
+		std::cout << "ERROR: wrong depth recommendation" << std::endl;
+		err_counter++;
+	}
+	if(err_counter == 0){
+		std::cout << "FIFO profiler test passed." << std::endl;
+		return 0;
+	}
+	else{
+		return 1;
+	}
+
+}
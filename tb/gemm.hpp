@@ -0,0 +1,326 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file gemm.hpp
+ *
+ *  Fast C++ reference implementations of convolution and max pool layers,
+ *  used for testbench. They compute bit-identical results to the plain
+ *  loop nests of conv.hpp and pool.hpp, which remain the golden models:
+ *
+ *   - conv_fast / conv_1x1_fast: im2col followed by a blocked integer GEMM,
+ *     using 16-bit multiply-adds on AVX2 when the operand ranges allow it
+ *     and exact 64-bit accumulation otherwise. The result is truncated
+ *     into TO once, which matches the per-MAC wrap-around of integer TO
+ *     types (ap_[u]int, native integers).
+ *   - pool_fast: max pool parallelized over images and rows.
+ *   - gemm_xnor: XNOR-popcount GEMM over bit-packed operands, the reference
+ *     of binarized layers.
+ *
+ *  Work is spread over OpenMP threads when compiled with -fopenmp and over
+ *  std::thread workers when compiled with -pthread; FINN_REF_THREADS limits
+ *  their number.
+ *  Compile with -mavx2 (or -march=native) to enable the vector paths.
+ *
+ *****************************************************************************/
+#ifndef GEMM_TB_H
+#define GEMM_TB_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/**
+ * Number of worker threads of the reference kernels.
+ */
+inline unsigned ref_threads() {
+	static unsigned const threads = []() {
+		char const *const env = std::getenv("FINN_REF_THREADS");
+		unsigned n = env? unsigned(std::strtoul(env, nullptr, 10)) : std::thread::hardware_concurrency();
+		return n > 0? n : 1u;
+	}();
+	return threads;
+}
+
+/**
+ * Runs body(i) for i in [0, n), spread over the worker threads.
+ */
+template<typename F>
+void ref_parallel_for(int const n, F const &body) {
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic) num_threads(ref_threads())
+	for(int i = 0; i < n; i++)  body(i);
+#elif !defined(_REENTRANT)
+	// not linked against pthreads (no -pthread), std::thread is unavailable
+	for(int i = 0; i < n; i++)  body(i);
+#else
+	unsigned const workers = std::min<unsigned>(ref_threads(), n > 0? unsigned(n) : 1u);
+	if(workers <= 1) {
+		for(int i = 0; i < n; i++)  body(i);
+		return;
+	}
+	std::atomic<int> next(0);
+	std::vector<std::thread> pool;
+	for(unsigned t = 0; t < workers; t++) {
+		pool.emplace_back([&]() {
+			for(int i; (i = next++) < n; )  body(i);
+		});
+	}
+	for(auto &t : pool)  t.join();
+#endif
+}
+
+/**
+ * Row-major integer matrix with rows padded to a multiple of 16 elements,
+ * the operand layout of gemm_int.
+ */
+struct RefMatrix {
+	int rows, cols, stride;
+	std::vector<int64_t> data;
+	RefMatrix(int const r, int const c) : rows(r), cols(c), stride((c + 15) & ~15), data(size_t(r) * stride, 0) {}
+	int64_t       *row(int const r)       { return &data[size_t(r) * stride]; }
+	int64_t const *row(int const r) const { return &data[size_t(r) * stride]; }
+	int64_t max_abs() const {
+		int64_t m = 0;
+		for(int64_t v : data)  m = std::max(m, v < 0? -v : v);
+		return m;
+	}
+};
+
+#ifdef __AVX2__
+inline int32_t ref_hsum(__m256i const v) {
+	__m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+	s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+	return _mm_cvtsi128_si32(s);
+}
+#endif
+
+/**
+ * C[i][j] = SUM_k A[i][k] * B[j][k], i.e. A times the transpose of B,
+ * exact in 64 bits.
+ */
+inline void gemm_int(RefMatrix const &A, RefMatrix const &B, std::vector<int64_t> &C) {
+	int const M = A.rows, N = B.rows, K = A.cols;
+	int const NB = 64; // columns of C per block, keeps the B block in L1/L2
+	C.assign(size_t(M) * N, 0);
+
+#ifdef __AVX2__
+	// 16-bit operands whose dot products cannot overflow 32 bits
+	int64_t const ma = A.max_abs(), mb = B.max_abs();
+	if(ma < (1 << 15) && mb < (1 << 15) && double(ma) * double(mb) * K < double(1u << 31)) {
+		int const KS = A.stride;
+		std::vector<int16_t> a16(size_t(M) * KS), b16(size_t(N) * KS);
+		for(size_t i = 0; i < a16.size(); i++)  a16[i] = int16_t(A.data[i]);
+		for(size_t i = 0; i < b16.size(); i++)  b16[i] = int16_t(B.data[i]);
+		ref_parallel_for(M, [&](int const i) {
+			int16_t const *const a = &a16[size_t(i) * KS];
+			for(int j0 = 0; j0 < N; j0 += NB) {
+				for(int j = j0; j < std::min(N, j0 + NB); j++) {
+					int16_t const *const b = &b16[size_t(j) * KS];
+					__m256i acc = _mm256_setzero_si256();
+					for(int k = 0; k < KS; k += 16) {
+						__m256i const va = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + k));
+						__m256i const vb = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + k));
+						acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+					}
+					C[size_t(i) * N + j] = ref_hsum(acc);
+				}
+			}
+		});
+		return;
+	}
+#endif
+
+	ref_parallel_for(M, [&](int const i) {
+		int64_t const *const a = A.row(i);
+		for(int j0 = 0; j0 < N; j0 += NB) {
+			for(int j = j0; j < std::min(N, j0 + NB); j++) {
+				int64_t const *const b = B.row(j);
+				int64_t acc = 0;
+				for(int k = 0; k < K; k++)  acc += a[k] * b[k];
+				C[size_t(i) * N + j] = acc;
+			}
+		}
+	});
+}
+
+#ifdef __AVX2__
+/** Per-64-bit-lane population count (nibble lookup, Mula et al.). */
+inline __m256i ref_popcount256(__m256i const v) {
+	__m256i const lut = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4, 0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+	__m256i const low = _mm256_set1_epi8(0x0F);
+	__m256i const lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, low));
+	__m256i const hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+	return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+#endif
+
+/**
+ * XNOR-popcount GEMM: C[i][j] is the number of the K bit positions in which
+ * row i of A and row j of B agree. Rows are packed LSB-first into
+ * words = ceil(K/64) 64-bit words with zero padding.
+ */
+inline void gemm_xnor(int const M, int const N, int const K, std::vector<uint64_t> const &A, std::vector<uint64_t> const &B, std::vector<int> &C) {
+	int const words = (K + 63) / 64;
+	C.assign(size_t(M) * N, 0);
+	ref_parallel_for(M, [&](int const i) {
+		uint64_t const *const a = &A[size_t(i) * words];
+		for(int j = 0; j < N; j++) {
+			uint64_t const *const b = &B[size_t(j) * words];
+			int64_t diff = 0;
+			int w = 0;
+#ifdef __AVX2__
+			__m256i acc = _mm256_setzero_si256();
+			for(; w + 4 <= words; w += 4) {
+				__m256i const va = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + w));
+				__m256i const vb = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + w));
+				acc = _mm256_add_epi64(acc, ref_popcount256(_mm256_xor_si256(va, vb)));
+			}
+			int64_t lanes[4];
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+			diff = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+			for(; w < words; w++)  diff += __builtin_popcountll(a[w] ^ b[w]);
+			C[size_t(i) * N + j] = K - int(diff);
+		}
+	});
+}
+
+/**
+ * Same computation and array layouts as conv in conv.hpp.
+ */
+template<int MAX_IMAGE,
+	int IFMDim,
+	int OFMDim,
+	int IFMCh,
+	int OFMCh,
+	int kernel,
+	int stride,
+	typename TI,
+	typename TO,
+	typename TW>
+	void conv_fast(TI const img[MAX_IMAGE][IFMDim*IFMDim][IFMCh], TW const weights[OFMCh][kernel][kernel][IFMCh], TO out[MAX_IMAGE][OFMDim][OFMDim][OFMCh]){
+		int const K = kernel*kernel*IFMCh;
+		RefMatrix W(OFMCh, K);
+		for(int h=0;h<OFMCh;h++)
+			for (int kx=0;kx<kernel;kx++)
+				for (int ky=0;ky<kernel;ky++)
+					for(int w=0;w<IFMCh;w++)
+						W.row(h)[(kx*kernel+ky)*IFMCh+w] = (long long)weights[h][kx][ky][w];
+		// im2col: one row per output pixel (n, x, y)
+		RefMatrix A(MAX_IMAGE*OFMDim*OFMDim, K);
+		ref_parallel_for(MAX_IMAGE*OFMDim, [&](int const nx) {
+			int const n = nx / OFMDim, x = nx % OFMDim;
+			for(int y=0;y<OFMDim;y++) {
+				int64_t *const a = A.row(nx*OFMDim + y);
+				for (int kx=0;kx<kernel;kx++)
+					for (int ky=0;ky<kernel;ky++)
+						for(int w=0;w<IFMCh;w++)
+							a[(kx*kernel+ky)*IFMCh+w] = (long long)img[n][(y*stride+ky)*IFMDim+x*stride+kx][w];
+			}
+		});
+		std::vector<int64_t> C;
+		gemm_int(A, W, C);
+		for(int n=0;n<MAX_IMAGE;n++)
+			for(int x=0;x<OFMDim;x++)
+				for(int y=0;y<OFMDim;y++)
+					for(int h=0;h<OFMCh;h++)
+						out[n][x][y][h] = TO(C[size_t((n*OFMDim+x)*OFMDim+y)*OFMCh+h]);
+	}
+
+/**
+ * Same computation and array layouts as conv_1x1 in conv.hpp.
+ */
+template<int MAX_IMAGE,
+	int IFMDim,
+	int OFMDim,
+	int IFMCh,
+	int OFMCh,
+	typename TI,
+	typename TO,
+	typename TW>
+	void conv_1x1_fast(TI const img[MAX_IMAGE][IFMDim][IFMDim][IFMCh], TW const weights[OFMCh][IFMCh], TO out[MAX_IMAGE][OFMDim][OFMDim][OFMCh]){
+		constexpr int stride= (OFMDim==1)? IFMDim:(IFMDim - 1)/(OFMDim - 1);
+		RefMatrix W(OFMCh, IFMCh);
+		for(int h=0;h<OFMCh;h++)
+			for(int w=0;w<IFMCh;w++)
+				W.row(h)[w] = (long long)weights[h][w];
+		RefMatrix A(MAX_IMAGE*OFMDim*OFMDim, IFMCh);
+		for(int n=0;n<MAX_IMAGE;n++)
+			for(int x=0;x<OFMDim;x++)
+				for(int y=0;y<OFMDim;y++)
+					for(int w=0;w<IFMCh;w++)
+						A.row((n*OFMDim+x)*OFMDim+y)[w] = (long long)img[n][x*stride][y*stride][w];
+		std::vector<int64_t> C;
+		gemm_int(A, W, C);
+		for(int n=0;n<MAX_IMAGE;n++)
+			for(int x=0;x<OFMDim;x++)
+				for(int y=0;y<OFMDim;y++)
+					for(int h=0;h<OFMCh;h++)
+						out[n][x][y][h] = TO(C[size_t((n*OFMDim+x)*OFMDim+y)*OFMCh+h]);
+	}
+
+/**
+ * Same computation and array layouts as pool in pool.hpp.
+ */
+template<int MAX_IMAGE,
+	int IFMDim,
+	int OFMDim,
+	int FMCh,
+	int kernel,
+	int stride,
+	typename TI>
+	void pool_fast(TI const img[MAX_IMAGE][IFMDim][IFMDim][FMCh], TI out[MAX_IMAGE][OFMDim][OFMDim][FMCh]){
+		ref_parallel_for(MAX_IMAGE*OFMDim, [&](int const nx) {
+			int const n = nx / OFMDim, x = nx % OFMDim;
+			for(int y=0;y<OFMDim;y++)
+				for(int h=0;h<FMCh;h++){
+					TI tmp = 0;
+					for (int ky=0;ky<kernel;ky++)
+						for (int kx=0;kx<kernel;kx++)
+							if(img[n][(y*stride+ky)][x*stride+kx][h]>tmp){
+								tmp=img[n][(y*stride+ky)][x*stride+kx][h];
+							}
+					out[n][x][y][h] = tmp;
+				}
+		});
+	}
+
+#endif
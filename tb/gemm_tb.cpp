@@ -0,0 +1,179 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file gemm_tb.cpp
+ *
+ *  Host-only check of the fast reference kernels of gemm.hpp against the plain
+ *  golden models of conv.hpp and pool.hpp
+ *
+ *****************************************************************************/
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#define AP_INT_MAX_W 16384
+#include "ap_int.h"
+
+#include "conv.hpp"
+#include "pool.hpp"
+#include "gemm.hpp"
+
+using namespace std;
+
+#define MAX_IMAGES 2
+#define IFMDim1 12
+#define OFMDim1 10
+#define KERNEL_DIM 3
+#define IFM_Channels1 16
+#define OFM_Channels1 24
+#define POOL_IFMDim 16
+#define POOL_OFMDim 8
+#define POOL_K 2
+#define XNOR_M 37
+#define XNOR_N 29
+#define XNOR_K 700
+
+static int err_counter = 0;
+
+int main()
+{
+	srand(1);
+
+	// 3x3 convolution, 4-bit unsigned inputs and signed weights, wrapping 10-bit outputs
+	static	ap_uint<4> IMAGE[MAX_IMAGES][IFMDim1*IFMDim1][IFM_Channels1];
+	static	ap_int<4> W1[OFM_Channels1][KERNEL_DIM][KERNEL_DIM][IFM_Channels1];
+	static	ap_int<10> GOLDEN[MAX_IMAGES][OFMDim1][OFMDim1][OFM_Channels1];
+	static	ap_int<10> FAST[MAX_IMAGES][OFMDim1][OFMDim1][OFM_Channels1];
+	for (unsigned int n = 0; n < MAX_IMAGES; n++)
+		for (unsigned int p = 0; p < IFMDim1*IFMDim1; p++)
+			for (unsigned int c = 0; c < IFM_Channels1; c++)
+				IMAGE[n][p][c] = rand();
+	for (unsigned int h = 0; h < OFM_Channels1; h++)
+		for (unsigned int kx = 0; kx < KERNEL_DIM; kx++)
+			for (unsigned int ky = 0; ky < KERNEL_DIM; ky++)
+				for (unsigned int c = 0; c < IFM_Channels1; c++)
+					W1[h][kx][ky][c] = rand();
+	{
+		// the golden model traces every MAC
+		std::ostringstream trace;
+		std::streambuf *const cout_buf = std::cout.rdbuf(trace.rdbuf());
+		conv<MAX_IMAGES,IFMDim1,OFMDim1,IFM_Channels1,OFM_Channels1, KERNEL_DIM, 1, ap_uint<4> >(IMAGE, W1, GOLDEN);
+		std::cout.rdbuf(cout_buf);
+	}
+	conv_fast<MAX_IMAGES,IFMDim1,OFMDim1,IFM_Channels1,OFM_Channels1, KERNEL_DIM, 1, ap_uint<4> >(IMAGE, W1, FAST);
+	int errs = 0;
+	for (unsigned int n = 0; n < MAX_IMAGES; n++)
+		for (unsigned int x = 0; x < OFMDim1; x++)
+			for (unsigned int y = 0; y < OFMDim1; y++)
+				for (unsigned int h = 0; h < OFM_Channels1; h++)
+					if (GOLDEN[n][x][y][h] != FAST[n][x][y][h]) {
+						if (errs++ < 10)
+							std::cout << "ERROR: conv Expected[" << n << "][" << x << "][" << y << "][" << h << "]=" << GOLDEN[n][x][y][h] << " actual " << FAST[n][x][y][h] << std::endl;
+					}
+	std::cout << "conv_fast " << (errs? "failed" : "passed") << " the testing." << std::endl;
+	err_counter += errs;
+
+	// 1x1 convolution with stride, wide values taking the exact 64-bit path
+	static	ap_int<20> IMAGE1[MAX_IMAGES][IFMDim1][IFMDim1][IFM_Channels1];
+	static	ap_int<20> W2[OFM_Channels1][IFM_Channels1];
+	static	ap_int<48> GOLDEN1[MAX_IMAGES][IFMDim1/2][IFMDim1/2][OFM_Channels1];
+	static	ap_int<48> FAST1[MAX_IMAGES][IFMDim1/2][IFMDim1/2][OFM_Channels1];
+	for (unsigned int n = 0; n < MAX_IMAGES; n++)
+		for (unsigned int x = 0; x < IFMDim1; x++)
+			for (unsigned int y = 0; y < IFMDim1; y++)
+				for (unsigned int c = 0; c < IFM_Channels1; c++)
+					IMAGE1[n][x][y][c] = rand();
+	for (unsigned int h = 0; h < OFM_Channels1; h++)
+		for (unsigned int c = 0; c < IFM_Channels1; c++)
+			W2[h][c] = rand();
+	conv_1x1<MAX_IMAGES,IFMDim1,IFMDim1/2,IFM_Channels1,OFM_Channels1>(IMAGE1, W2, GOLDEN1);
+	conv_1x1_fast<MAX_IMAGES,IFMDim1,IFMDim1/2,IFM_Channels1,OFM_Channels1>(IMAGE1, W2, FAST1);
+	errs = 0;
+	for (unsigned int n = 0; n < MAX_IMAGES; n++)
+		for (unsigned int x = 0; x < IFMDim1/2; x++)
+			for (unsigned int y = 0; y < IFMDim1/2; y++)
+				for (unsigned int h = 0; h < OFM_Channels1; h++)
+					if (GOLDEN1[n][x][y][h] != FAST1[n][x][y][h]) {
+						if (errs++ < 10)
+							std::cout << "ERROR: conv_1x1 Expected[" << n << "][" << x << "][" << y << "][" << h << "]=" << GOLDEN1[n][x][y][h] << " actual " << FAST1[n][x][y][h] << std::endl;
+					}
+	std::cout << "conv_1x1_fast " << (errs? "failed" : "passed") << " the testing." << std::endl;
+	err_counter += errs;
+
+	// max pool
+	static	ap_uint<4> PIMAGE[MAX_IMAGES][POOL_IFMDim][POOL_IFMDim][IFM_Channels1];
+	static	ap_uint<4> PGOLDEN[MAX_IMAGES][POOL_OFMDim][POOL_OFMDim][IFM_Channels1];
+	static	ap_uint<4> PFAST[MAX_IMAGES][POOL_OFMDim][POOL_OFMDim][IFM_Channels1];
+	for (unsigned int n = 0; n < MAX_IMAGES; n++)
+		for (unsigned int x = 0; x < POOL_IFMDim; x++)
+			for (unsigned int y = 0; y < POOL_IFMDim; y++)
+				for (unsigned int c = 0; c < IFM_Channels1; c++)
+					PIMAGE[n][x][y][c] = rand();
+	pool<MAX_IMAGES,POOL_IFMDim,POOL_OFMDim,IFM_Channels1,POOL_K,POOL_K,ap_uint<4> >(PIMAGE, PGOLDEN);
+	pool_fast<MAX_IMAGES,POOL_IFMDim,POOL_OFMDim,IFM_Channels1,POOL_K,POOL_K,ap_uint<4> >(PIMAGE, PFAST);
+	errs = 0;
+	for (unsigned int n = 0; n < MAX_IMAGES; n++)
+		for (unsigned int x = 0; x < POOL_OFMDim; x++)
+			for (unsigned int y = 0; y < POOL_OFMDim; y++)
+				for (unsigned int c = 0; c < IFM_Channels1; c++)
+					if (PGOLDEN[n][x][y][c] != PFAST[n][x][y][c])  errs++;
+	std::cout << "pool_fast " << (errs? "failed" : "passed") << " the testing." << std::endl;
+	err_counter += errs;
+
+	// XNOR-popcount GEMM against a bit-by-bit count
+	int const words = (XNOR_K + 63) / 64;
+	std::vector<uint64_t> A(XNOR_M * words, 0), B(XNOR_N * words, 0);
+	for (int i = 0; i < XNOR_M * XNOR_K; i++)
+		if (rand() & 1)  A[(i / XNOR_K) * words + (i % XNOR_K) / 64] |= uint64_t(1) << ((i % XNOR_K) % 64);
+	for (int i = 0; i < XNOR_N * XNOR_K; i++)
+		if (rand() & 1)  B[(i / XNOR_K) * words + (i % XNOR_K) / 64] |= uint64_t(1) << ((i % XNOR_K) % 64);
+	std::vector<int> C;
+	gemm_xnor(XNOR_M, XNOR_N, XNOR_K, A, B, C);
+	errs = 0;
+	for (int i = 0; i < XNOR_M; i++)
+		for (int j = 0; j < XNOR_N; j++) {
+			int EXP = 0;
+			for (int k = 0; k < XNOR_K; k++)
+				EXP += ((A[i * words + k / 64] >> (k % 64)) & 1) == ((B[j * words + k / 64] >> (k % 64)) & 1);
+			if (EXP != C[i * XNOR_N + j])  errs++;
+		}
+	std::cout << "gemm_xnor " << (errs? "failed" : "passed") << " the testing." << std::endl;
+	err_counter += errs;
+
+	if(err_counter == 0){
+		return 0;
+	}
+	else{
+		return 1;
+	}
+
+}
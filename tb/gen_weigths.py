@@ -32,6 +32,7 @@ import os
 import sys
 import random 
 import subprocess
+from param_file import write_params
 
 outFileWeights = open("memdata.h" , "wt")
 outFileConfig = open("config.h" , "wt")
@@ -78,11 +79,11 @@ if (w_precision == 1):
 else:
 	outFileWeights.write("static FixedPointWeights<%d,ap_int<%d>,%d,%d> weights= {\n{\n" %(simd,w_precision,pe,tile))
 
+weights = [[random.randint(0, 1<<simd*w_precision-1) for t in range(tile)] for p in range(pe)]
 for p in range(pe):
 	outFileWeights.write("{ \n")
 	for t in range(tile):
-		width = simd*w_precision;
-		val = random.randint(0, 1<<width-1)
+		val = weights[p][t]
 		outFileWeights.write("%s" % hex(val))
 		if t!=tile-1:
 			outFileWeights.write(",\n")
@@ -95,5 +96,5 @@ outFileWeights.write("}\n};\n } \n")
 outFileWeights.write("#endif \n")
 outFileWeights.close()
 
-
-
+# the same weights as binary parameter file for param_file.hpp
+write_params("params.bin", [("weights", simd*w_precision, weights)])
@@ -51,6 +51,7 @@
 
 #include "pool_config.h"
 #include "pool.hpp"
+#include "gemm.hpp"
 #include "activations.hpp"
 #include "interpret.hpp"
 
@@ -84,7 +85,7 @@ int main()
 			}
 		}
 	}
-	pool<MAX_IMAGES,IFMDim1,OFMDim1,FM_Channels1,KERNEL_DIM,KERNEL_DIM,ap_uint<PRECISION> >(IMAGE,OUTPUT);
+	pool_fast<MAX_IMAGES,IFMDim1,OFMDim1,FM_Channels1,KERNEL_DIM,KERNEL_DIM,ap_uint<PRECISION> >(IMAGE,OUTPUT);
 	Testbench_pool(input_stream, output_stream, MAX_IMAGES);
 	int err_counter = 0, err_perimage=0;
 	ap_uint<PRECISION> out_chan;
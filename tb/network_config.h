@@ -0,0 +1,62 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file network_config.h
+ *
+ *  Configuration of the declarative network test (convolution, max pool and fully connected layer)
+ *
+ *****************************************************************************/
+#define INPUT_PRECISION 2
+#define WEIGHT_PRECISION 2
+#define ACC_PRECISION 16
+
+#define KERNEL_DIM 3
+#define IFM_Channels1 4
+#define IFMDim1 8
+#define OFM_Channels1 8
+#define OFMDim1 6
+#define SIMD1 2
+#define PE1 4
+#define TILES1 (KERNEL_DIM*KERNEL_DIM*IFM_Channels1/SIMD1)*(OFM_Channels1/PE1)
+
+#define POOL_DIM 2
+#define PoolOFMDim (OFMDim1/POOL_DIM)
+
+#define MATRIX_W (PoolOFMDim*PoolOFMDim*OFM_Channels1)
+#define MATRIX_H 8
+#define SIMD2 8
+#define PE2 2
+#define TILES2 (MATRIX_W/SIMD2)*(MATRIX_H/PE2)
+
+#define STATS_BINS 64
+#define STATS_BIN_SHIFT 12
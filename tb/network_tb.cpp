@@ -0,0 +1,201 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file network_tb.cpp
+ *
+ *  Testbench for the declarative network builder (Network_Batch) and its
+ *  run-time instrumentation (Network_Batch_Instrumented)
+ *
+ *****************************************************************************/
+#include <iostream>
+#include <cstdlib>
+#include <hls_stream.h>
+#define AP_INT_MAX_W 16384
+#include "ap_int.h"
+#include "bnn-library.h"
+
+#include "network_config.h"
+
+using namespace hls;
+using namespace std;
+
+#define MAX_IMAGES 4
+void Testbench_network(stream<ap_uint<IFM_Channels1*INPUT_PRECISION> > & in, stream<ap_uint<MATRIX_H*ACC_PRECISION> > & out,
+		ap_uint<SIMD1*WEIGHT_PRECISION> const conv_weights[PE1][TILES1], ap_uint<SIMD2*WEIGHT_PRECISION> const fc_weights[PE2][TILES2],
+		unsigned int numReps);
+void Testbench_network_instrumented(stream<ap_uint<IFM_Channels1*INPUT_PRECISION> > & in, stream<ap_uint<MATRIX_H*ACC_PRECISION> > & out,
+		ap_uint<SIMD1*WEIGHT_PRECISION> const conv_weights[PE1][TILES1], ap_uint<SIMD2*WEIGHT_PRECISION> const fc_weights[PE2][TILES2],
+		ap_uint<32> stats[InstrumentLayout<2, STATS_BINS>::SIZE], unsigned int numReps);
+
+int main()
+{
+	unsigned const CONV_W = KERNEL_DIM*KERNEL_DIM*IFM_Channels1;
+	static	int IMAGE[MAX_IMAGES][IFMDim1][IFMDim1][IFM_Channels1];
+	static	int W1[OFM_Channels1][CONV_W];
+	static	int W2[MATRIX_H][MATRIX_W];
+	static	ap_uint<SIMD1*WEIGHT_PRECISION> PACKED1[PE1][TILES1];
+	static	ap_uint<SIMD2*WEIGHT_PRECISION> PACKED2[PE2][TILES2];
+	stream<ap_uint<IFM_Channels1*INPUT_PRECISION> > input_stream("input_stream");
+	stream<ap_uint<MATRIX_H*ACC_PRECISION> > output_stream("output_stream");
+	srand(11);
+	// tile = nf*SF + sf, SIMD lane i of row nf*PE+pe holds column sf*SIMD+i
+	for (unsigned int h = 0; h < OFM_Channels1; h++) {
+		for (unsigned int w = 0; w < CONV_W; w++) {
+			W1[h][w] = int(rand() % 4) - 2;
+			ap_int<WEIGHT_PRECISION> const wt = W1[h][w];
+			unsigned const lane = w % SIMD1;
+			PACKED1[h % PE1][(h / PE1) * (CONV_W / SIMD1) + w / SIMD1]((lane+1)*WEIGHT_PRECISION-1, lane*WEIGHT_PRECISION) = ap_uint<WEIGHT_PRECISION>(wt);
+		}
+	}
+	for (unsigned int h = 0; h < MATRIX_H; h++) {
+		for (unsigned int w = 0; w < MATRIX_W; w++) {
+			W2[h][w] = int(rand() % 4) - 2;
+			ap_int<WEIGHT_PRECISION> const wt = W2[h][w];
+			unsigned const lane = w % SIMD2;
+			PACKED2[h % PE2][(h / PE2) * (MATRIX_W / SIMD2) + w / SIMD2]((lane+1)*WEIGHT_PRECISION-1, lane*WEIGHT_PRECISION) = ap_uint<WEIGHT_PRECISION>(wt);
+		}
+	}
+	for (unsigned int n_image = 0; n_image < MAX_IMAGES; n_image++) {
+		for (unsigned int oy = 0; oy < IFMDim1; oy++) {
+			for (unsigned int ox = 0; ox < IFMDim1; ox++) {
+				for (unsigned int c = 0; c < IFM_Channels1; c++) {
+					IMAGE[n_image][oy][ox][c] = rand() % (1 << INPUT_PRECISION);
+				}
+			}
+		}
+	}
+	static	ap_uint<32> STATS[InstrumentLayout<2, STATS_BINS>::SIZE];
+	int err_counter = 0, err_perimage=0;
+	// the plain and the instrumented top have to compute the same
+	for (unsigned int instrumented = 0; instrumented < 2; instrumented++) {
+	for (unsigned int n_image = 0; n_image < MAX_IMAGES; n_image++) {
+		for (unsigned int oy = 0; oy < IFMDim1; oy++) {
+			for (unsigned int ox = 0; ox < IFMDim1; ox++) {
+				ap_uint<IFM_Channels1*INPUT_PRECISION> input = 0;
+				for (unsigned int c = 0; c < IFM_Channels1; c++) {
+					input((c+1)*INPUT_PRECISION-1, c*INPUT_PRECISION) = IMAGE[n_image][oy][ox][c];
+				}
+				input_stream.write(input);
+			}
+		}
+	}
+	if (instrumented) {
+		Testbench_network_instrumented(input_stream, output_stream, PACKED1, PACKED2, STATS, MAX_IMAGES);
+	}
+	else {
+		Testbench_network(input_stream, output_stream, PACKED1, PACKED2, MAX_IMAGES);
+	}
+	for (unsigned int n_image = 0; n_image < MAX_IMAGES; n_image++) {
+		// golden model: convolution, max pool and matrix-vector product
+		int conv[OFMDim1][OFMDim1][OFM_Channels1];
+		for (unsigned int oy = 0; oy < OFMDim1; oy++) {
+			for (unsigned int ox = 0; ox < OFMDim1; ox++) {
+				for (unsigned int h = 0; h < OFM_Channels1; h++) {
+					int acc = 0;
+					for (unsigned int ky = 0; ky < KERNEL_DIM; ky++) {
+						for (unsigned int kx = 0; kx < KERNEL_DIM; kx++) {
+							for (unsigned int c = 0; c < IFM_Channels1; c++) {
+								acc += W1[h][(ky*KERNEL_DIM + kx)*IFM_Channels1 + c] * IMAGE[n_image][oy+ky][ox+kx][c];
+							}
+						}
+					}
+					conv[oy][ox][h] = acc;
+				}
+			}
+		}
+		int pooled[MATRIX_W];
+		for (unsigned int py = 0; py < PoolOFMDim; py++) {
+			for (unsigned int px = 0; px < PoolOFMDim; px++) {
+				for (unsigned int h = 0; h < OFM_Channels1; h++) {
+					int m = conv[py*POOL_DIM][px*POOL_DIM][h];
+					for (unsigned int ky = 0; ky < POOL_DIM; ky++) {
+						for (unsigned int kx = 0; kx < POOL_DIM; kx++) {
+							m = max(m, conv[py*POOL_DIM+ky][px*POOL_DIM+kx][h]);
+						}
+					}
+					pooled[(py*PoolOFMDim + px)*OFM_Channels1 + h] = m;
+				}
+			}
+		}
+		ap_uint<MATRIX_H*ACC_PRECISION> outElem = output_stream.read();
+		for (unsigned int h = 0; h < MATRIX_H; h++) {
+			int EXP = 0;
+			for (unsigned int w = 0; w < MATRIX_W; w++) {
+				EXP += W2[h][w] * pooled[w];
+			}
+			ap_int<ACC_PRECISION> out = outElem((h+1)*ACC_PRECISION-1, h*ACC_PRECISION);
+			if (EXP != out){
+				std::cout << "ERROR: Expected["<<h<<"]=" << EXP << " actual " << out << std::endl;
+				err_counter ++;
+				err_perimage++;
+			}
+		}
+		if(err_perimage == 0){
+			std::cout << "Image # " << n_image << " passed the testing."<< std::endl;
+		}
+		else{
+			err_perimage=0;
+			std::cout << "Image # " << n_image << " failed the testing."<< std::endl;
+		}
+	}
+	}
+
+	// instrumentation: one trace record per frame and consistent statistics
+	typedef InstrumentLayout<2, STATS_BINS> Layout;
+	InstrumentReport<2, STATS_BINS, STATS_BIN_SHIFT> report(STATS);
+	report.print(std::cout);
+	unsigned long long binned = 0;
+	for (unsigned int i = 0; i < STATS_BINS; i++) {
+		binned += STATS[Layout::HIST + i].to_uint64();
+	}
+	for (unsigned int n_image = 0; n_image < MAX_IMAGES; n_image++) {
+		FrameTiming const t = InstrumentTrace().read();
+		if (t.frame != n_image || t.last_out < t.first_in) {
+			std::cout << "ERROR: trace record " << n_image << " is frame " << t.frame << " from " << t.first_in << " to " << t.last_out << std::endl;
+			err_counter++;
+		}
+	}
+	if (report.frames() != MAX_IMAGES || binned != MAX_IMAGES || !InstrumentTrace().empty() ||
+	    report.min() > report.percentile(50) || report.percentile(50) > report.percentile(99) || report.percentile(99) > report.max()) {
+		std::cout << "ERROR: inconsistent instrumentation statistics" << std::endl;
+		err_counter++;
+	}
+
+	if(err_counter == 0){
+		return 0;
+	}
+	else{
+		return 1;
+	}
+
+}
@@ -0,0 +1,113 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file network_top.cpp
+ *
+ *  HLS Top functions of a convolution, max pool and fully connected layer pipeline
+ *  described with Network_Batch, plain and with run-time instrumentation, for unit testing
+ *
+ *****************************************************************************/
+#include <hls_stream.h>
+using namespace hls;
+#include "ap_int.h"
+#include "bnn-library.h"
+
+#include "activations.hpp"
+#include "weights.hpp"
+#include "interpret.hpp"
+#include "mvau.hpp"
+#include "network_config.h"
+
+struct ConvParams {
+	static FixedPointWeights<SIMD1, ap_int<WEIGHT_PRECISION>, PE1, TILES1> weights;
+	static PassThroughActivation<ap_int<ACC_PRECISION>> const activation;
+};
+FixedPointWeights<SIMD1, ap_int<WEIGHT_PRECISION>, PE1, TILES1> ConvParams::weights;
+PassThroughActivation<ap_int<ACC_PRECISION>> const ConvParams::activation = PassThroughActivation<ap_int<ACC_PRECISION>>();
+
+struct FCParams {
+	static FixedPointWeights<SIMD2, ap_int<WEIGHT_PRECISION>, PE2, TILES2> weights;
+	static PassThroughActivation<ap_int<ACC_PRECISION>> const activation;
+};
+FixedPointWeights<SIMD2, ap_int<WEIGHT_PRECISION>, PE2, TILES2> FCParams::weights;
+PassThroughActivation<ap_int<ACC_PRECISION>> const FCParams::activation = PassThroughActivation<ap_int<ACC_PRECISION>>();
+
+typedef ConvLayerCfg<KERNEL_DIM, IFM_Channels1, IFMDim1, OFM_Channels1, OFMDim1, SIMD1, PE1,
+	Slice<ap_uint<INPUT_PRECISION> >, Slice<ap_int<ACC_PRECISION> >, Identity, ConvParams, ap_resource_lut>  Conv0;
+typedef MaxPoolLayerCfg<OFMDim1, POOL_DIM, OFM_Channels1, ap_int<ACC_PRECISION>, -32768>  Pool0;
+typedef FCLayerCfg<MATRIX_W, MATRIX_H, SIMD2, PE2,
+	Slice<ap_int<ACC_PRECISION> >, Slice<ap_int<ACC_PRECISION> >, Identity, FCParams, ap_resource_lut>  FC0;
+
+static void load_params(ap_uint<SIMD1*WEIGHT_PRECISION> const conv_weights[PE1][TILES1], ap_uint<SIMD2*WEIGHT_PRECISION> const fc_weights[PE2][TILES2]){
+	for(unsigned int tile = 0; tile < TILES1; tile++) {
+		for(unsigned int pe = 0; pe < PE1; pe++) {
+#pragma HLS PIPELINE II=1
+			ConvParams::weights.m_weights[pe][tile] = conv_weights[pe][tile];
+		}
+	}
+	for(unsigned int tile = 0; tile < TILES2; tile++) {
+		for(unsigned int pe = 0; pe < PE2; pe++) {
+#pragma HLS PIPELINE II=1
+			FCParams::weights.m_weights[pe][tile] = fc_weights[pe][tile];
+		}
+	}
+}
+
+// The dataflow regions of the tops, reading the weights loaded before
+static void network_dataflow(stream<ap_uint<IFM_Channels1*INPUT_PRECISION> > & in, stream<ap_uint<MATRIX_H*ACC_PRECISION> > & out,
+		unsigned int numReps){
+#pragma HLS DATAFLOW
+	Network_Batch<Conv0, Pool0, FC0>(in, out, numReps);
+}
+
+static void network_instrumented_dataflow(stream<ap_uint<IFM_Channels1*INPUT_PRECISION> > & in, stream<ap_uint<MATRIX_H*ACC_PRECISION> > & out,
+		ap_uint<32> stats[InstrumentLayout<2, STATS_BINS>::SIZE], unsigned int numReps){
+#pragma HLS DATAFLOW
+	Network_Batch_Instrumented<InstrumentCfg<STATS_BINS, STATS_BIN_SHIFT>, Conv0, Pool0, FC0>(in, out, numReps, stats);
+}
+
+void Testbench_network(stream<ap_uint<IFM_Channels1*INPUT_PRECISION> > & in, stream<ap_uint<MATRIX_H*ACC_PRECISION> > & out,
+		ap_uint<SIMD1*WEIGHT_PRECISION> const conv_weights[PE1][TILES1], ap_uint<SIMD2*WEIGHT_PRECISION> const fc_weights[PE2][TILES2],
+		unsigned int numReps){
+	// the weights are written before, not within, the dataflow region that reads them
+	load_params(conv_weights, fc_weights);
+	network_dataflow(in, out, numReps);
+}
+
+void Testbench_network_instrumented(stream<ap_uint<IFM_Channels1*INPUT_PRECISION> > & in, stream<ap_uint<MATRIX_H*ACC_PRECISION> > & out,
+		ap_uint<SIMD1*WEIGHT_PRECISION> const conv_weights[PE1][TILES1], ap_uint<SIMD2*WEIGHT_PRECISION> const fc_weights[PE2][TILES2],
+		ap_uint<32> stats[InstrumentLayout<2, STATS_BINS>::SIZE], unsigned int numReps){
+#pragma HLS INTERFACE s_axilite port=stats bundle=control
+	load_params(conv_weights, fc_weights);
+	network_instrumented_dataflow(in, out, stats, numReps);
+}
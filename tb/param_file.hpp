@@ -0,0 +1,395 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file param_file.hpp
+ *
+ *  Binary parameter container for testbenches, written by param_file.py
+ *  (e.g. params.bin of gen_weigths.py) or by ParamFileWriter below.
+ *
+ *  Layout (little endian):
+ *    char     magic[8]      "FINNPARM"
+ *    uint32   version       1
+ *    uint32   count         number of tensors
+ *    count directory entries of 64 bytes:
+ *      char     name[40]    NUL-padded
+ *      uint32   word_bits   width of a word
+ *      uint32   dims[3]     e.g. PE, TILES, 1 for weights and PE, NF, NumTH
+ *                           for thresholds, outermost first
+ *      uint64   offset      of the data from the start of the file, 64-byte aligned
+ *    data: every word as ceil(word_bits/64) uint64 limbs, least significant first
+ *
+ *  ParamFile maps the file and copies the tensors into the m_weights of
+ *  BinaryWeights / FixedPointWeights and the m_thresholds of
+ *  ThresholdsActivation, so that testbenches load their parameters at run
+ *  time instead of compiling them in. The words are copied rather than
+ *  aliased, as the layout of ap_[u]int in memory is up to the implementation.
+ *
+ *****************************************************************************/
+#ifndef PARAM_FILE_HPP
+#define PARAM_FILE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PARAM_FILE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <hls_stream.h>
+#include "ap_int.h"
+#include "weights.hpp"
+#include "activations.hpp"
+
+namespace param_file {
+
+char const MAGIC[8] = { 'F', 'I', 'N', 'N', 'P', 'A', 'R', 'M' };
+unsigned const VERSION = 1;
+unsigned const NAME_LEN = 40;
+unsigned const HEADER_BYTES = 16;
+unsigned const ENTRY_BYTES = 64;
+unsigned const ALIGN = 64;
+
+inline unsigned limbs(unsigned const word_bits) {
+	return (word_bits + 63) / 64;
+}
+
+/** Assembles a word from its limbs. */
+template<int W>
+ap_uint<W> from_limbs(uint64_t const *l) {
+	if(W <= 64) {
+		return ap_uint<W>(l[0]);
+	}
+	ap_uint<W> v = 0;
+	for(int i = limbs(W); i-- > 0; ) {
+		v <<= W > 64? 64 : 0;
+		v |= ap_uint<W>(l[i]);
+	}
+	return v;
+}
+
+/** Splits a word into its limbs. */
+template<int W>
+void to_limbs(ap_uint<W> const &v, uint64_t *l) {
+	ap_uint<W> r = v;
+	for(unsigned i = 0; i < limbs(W); i++) {
+		l[i] = ap_uint<W <= 64? W : 64>(r).to_uint64();
+		r >>= W > 64? 64 : 0;
+	}
+}
+
+/**
+ * Path of the parameter file of a testbench: its first argument if given,
+ * else the params.bin of gen_weigths.py in $FINN_HLS_ROOT/tb (the C simulation
+ * runs in the solution directory), else params.bin in the working directory.
+ */
+inline std::string path(int const argc, char const *const argv[]) {
+	if(argc > 1)  return argv[1];
+	char const *const root = std::getenv("FINN_HLS_ROOT");
+	if(root)  return std::string(root) + "/tb/params.bin";
+	return "params.bin";
+}
+
+} // namespace param_file
+
+/**
+ * Tensor of a parameter file, valid as long as its ParamFile.
+ */
+struct ParamTensor {
+	std::string name;
+	unsigned word_bits;
+	unsigned dims[3];
+	uint64_t const *data;
+
+	size_t words() const {
+		return size_t(dims[0]) * dims[1] * dims[2];
+	}
+	uint64_t const *word(size_t const idx) const {
+		return data + idx * param_file::limbs(word_bits);
+	}
+};
+
+/**
+ * Read-only view of a parameter file.
+ */
+class ParamFile {
+	std::string m_path;
+	unsigned char const *m_base;
+	size_t m_size;
+	std::vector<uint64_t> m_copy;  // without mmap
+	std::vector<ParamTensor> m_tensors;
+
+	void fail(std::string const &msg) const {
+		throw std::runtime_error(m_path + ": " + msg);
+	}
+
+	template<typename T>
+	T field(size_t const ofs) const {
+		T v;
+		std::memcpy(&v, m_base + ofs, sizeof(T));
+		return v;
+	}
+
+	void map() {
+#ifdef PARAM_FILE_MMAP
+		int const fd = open(m_path.c_str(), O_RDONLY);
+		if(fd < 0)  fail("cannot open");
+		struct stat st;
+		if(fstat(fd, &st) != 0) {
+			close(fd);
+			fail("cannot stat");
+		}
+		m_size = size_t(st.st_size);
+		void *const p = m_size? mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+		close(fd);
+		if(p == MAP_FAILED)  fail("cannot map");
+		m_base = static_cast<unsigned char const*>(p);
+#else
+		std::ifstream in(m_path.c_str(), std::ios::binary | std::ios::ate);
+		if(!in)  fail("cannot open");
+		m_size = size_t(in.tellg());
+		m_copy.resize((m_size + 7) / 8);
+		in.seekg(0);
+		in.read(reinterpret_cast<char*>(m_copy.data()), m_size);
+		m_base = reinterpret_cast<unsigned char const*>(m_copy.data());
+#endif
+	}
+
+	void parse() {
+		using namespace param_file;
+		if(m_size < HEADER_BYTES || std::memcmp(m_base, MAGIC, sizeof(MAGIC)) != 0)  fail("not a parameter file");
+		if(field<uint32_t>(8) != VERSION)  fail("unsupported version");
+		uint32_t const count = field<uint32_t>(12);
+		if(m_size < HEADER_BYTES + size_t(count) * ENTRY_BYTES)  fail("truncated directory");
+		for(uint32_t i = 0; i < count; i++) {
+			size_t const e = HEADER_BYTES + size_t(i) * ENTRY_BYTES;
+			ParamTensor t;
+			char name[NAME_LEN + 1] = { 0 };
+			std::memcpy(name, m_base + e, NAME_LEN);
+			t.name = name;
+			t.word_bits = field<uint32_t>(e + NAME_LEN);
+			for(unsigned d = 0; d < 3; d++)  t.dims[d] = field<uint32_t>(e + NAME_LEN + 4 + 4*d);
+			uint64_t const ofs = field<uint64_t>(e + NAME_LEN + 16);
+			if(t.word_bits == 0 || ofs % ALIGN != 0 || ofs + t.words() * limbs(t.word_bits) * 8 > m_size) {
+				fail("bad directory entry of " + t.name);
+			}
+			t.data = reinterpret_cast<uint64_t const*>(m_base + ofs);
+			m_tensors.push_back(t);
+		}
+	}
+
+public:
+	ParamFile(std::string const &path) : m_path(path), m_base(nullptr), m_size(0) {
+		map();
+		try {
+			parse();
+		}
+		catch(...) {
+			unmap();
+			throw;
+		}
+	}
+	~ParamFile() {
+		unmap();
+	}
+	ParamFile(ParamFile const&) = delete;
+	ParamFile& operator=(ParamFile const&) = delete;
+
+private:
+	void unmap() {
+#ifdef PARAM_FILE_MMAP
+		if(m_base)  munmap(const_cast<unsigned char*>(m_base), m_size);
+#endif
+		m_base = nullptr;
+	}
+
+public:
+	std::vector<ParamTensor> const& tensors() const {
+		return m_tensors;
+	}
+
+	/** The named tensor, checked against the expected shape. */
+	ParamTensor const& tensor(std::string const &name, unsigned const word_bits,
+	                          unsigned const d0, unsigned const d1, unsigned const d2 = 1) const {
+		for(ParamTensor const &t : m_tensors) {
+			if(t.name != name)  continue;
+			if(t.word_bits != word_bits || t.dims[0] != d0 || t.dims[1] != d1 || t.dims[2] != d2) {
+				char msg[160];
+				std::snprintf(msg, sizeof(msg), "%s has %u-bit words of [%u][%u][%u], expected %u-bit words of [%u][%u][%u]",
+				              name.c_str(), t.word_bits, t.dims[0], t.dims[1], t.dims[2], word_bits, d0, d1, d2);
+				fail(msg);
+			}
+			return t;
+		}
+		fail("no tensor " + name);
+		return m_tensors.front();
+	}
+
+	template<unsigned SIMD, unsigned PE, unsigned TILES>
+	void load(std::string const &name, BinaryWeights<SIMD, PE, TILES> &w) const {
+		ParamTensor const &t = tensor(name, SIMD, PE, TILES);
+		for(unsigned pe = 0; pe < PE; pe++) {
+			for(unsigned tile = 0; tile < TILES; tile++) {
+				w.m_weights[pe][tile] = param_file::from_limbs<SIMD>(t.word(size_t(pe) * TILES + tile));
+			}
+		}
+	}
+
+	template<unsigned SIMD, typename WT, unsigned PE, unsigned TILES>
+	void load(std::string const &name, FixedPointWeights<SIMD, WT, PE, TILES> &w) const {
+		ParamTensor const &t = tensor(name, SIMD * WT::width, PE, TILES);
+		for(unsigned pe = 0; pe < PE; pe++) {
+			for(unsigned tile = 0; tile < TILES; tile++) {
+				w.m_weights[pe][tile] = param_file::from_limbs<SIMD * WT::width>(t.word(size_t(pe) * TILES + tile));
+			}
+		}
+	}
+
+	template<unsigned NF, unsigned PE, unsigned NumTH, typename TA, typename TR, int ActVal, typename Compare>
+	void load(std::string const &name, ThresholdsActivation<NF, PE, NumTH, TA, TR, ActVal, Compare> &a) const {
+		ParamTensor const &t = tensor(name, TA::width, PE, NF, NumTH);
+		size_t idx = 0;
+		for(unsigned pe = 0; pe < PE; pe++) {
+			for(unsigned nf = 0; nf < NF; nf++) {
+				for(unsigned th = 0; th < NumTH; th++) {
+					a.m_thresholds[pe][nf][th](TA::width-1, 0) = param_file::from_limbs<TA::width>(t.word(idx++));
+				}
+			}
+		}
+	}
+};
+
+/**
+ * Writer of parameter files, the C++ counterpart of param_file.py.
+ */
+class ParamFileWriter {
+	struct Entry {
+		std::string name;
+		unsigned word_bits;
+		unsigned dims[3];
+		std::vector<uint64_t> data;
+	};
+	std::vector<Entry> m_entries;
+
+	Entry& add(std::string const &name, unsigned const word_bits, unsigned const d0, unsigned const d1, unsigned const d2) {
+		if(name.size() > param_file::NAME_LEN)  throw std::runtime_error("tensor name too long: " + name);
+		Entry e;
+		e.name = name;
+		e.word_bits = word_bits;
+		e.dims[0] = d0;
+		e.dims[1] = d1;
+		e.dims[2] = d2;
+		e.data.resize(size_t(d0) * d1 * d2 * param_file::limbs(word_bits));
+		m_entries.push_back(e);
+		return m_entries.back();
+	}
+
+public:
+	template<unsigned SIMD, unsigned PE, unsigned TILES>
+	void add(std::string const &name, BinaryWeights<SIMD, PE, TILES> const &w) {
+		Entry &e = add(name, SIMD, PE, TILES, 1);
+		for(unsigned pe = 0; pe < PE; pe++) {
+			for(unsigned tile = 0; tile < TILES; tile++) {
+				param_file::to_limbs<SIMD>(w.m_weights[pe][tile], &e.data[(size_t(pe) * TILES + tile) * param_file::limbs(SIMD)]);
+			}
+		}
+	}
+
+	template<unsigned SIMD, typename WT, unsigned PE, unsigned TILES>
+	void add(std::string const &name, FixedPointWeights<SIMD, WT, PE, TILES> const &w) {
+		unsigned const W = SIMD * WT::width;
+		Entry &e = add(name, W, PE, TILES, 1);
+		for(unsigned pe = 0; pe < PE; pe++) {
+			for(unsigned tile = 0; tile < TILES; tile++) {
+				param_file::to_limbs<W>(w.m_weights[pe][tile], &e.data[(size_t(pe) * TILES + tile) * param_file::limbs(W)]);
+			}
+		}
+	}
+
+	template<unsigned NF, unsigned PE, unsigned NumTH, typename TA, typename TR, int ActVal, typename Compare>
+	void add(std::string const &name, ThresholdsActivation<NF, PE, NumTH, TA, TR, ActVal, Compare> const &a) {
+		Entry &e = add(name, TA::width, PE, NF, NumTH);
+		size_t idx = 0;
+		for(unsigned pe = 0; pe < PE; pe++) {
+			for(unsigned nf = 0; nf < NF; nf++) {
+				for(unsigned th = 0; th < NumTH; th++) {
+					ap_uint<TA::width> const bits = a.m_thresholds[pe][nf][th](TA::width-1, 0);
+					param_file::to_limbs<TA::width>(bits, &e.data[idx++ * param_file::limbs(TA::width)]);
+				}
+			}
+		}
+	}
+
+	void write(std::string const &path) const {
+		using namespace param_file;
+		std::ofstream out(path.c_str(), std::ios::binary);
+		if(!out)  throw std::runtime_error(path + ": cannot create");
+		std::vector<unsigned char> head(HEADER_BYTES + m_entries.size() * ENTRY_BYTES, 0);
+		uint32_t const version = VERSION, count = uint32_t(m_entries.size());
+		std::memcpy(&head[0], MAGIC, sizeof(MAGIC));
+		std::memcpy(&head[8], &version, 4);
+		std::memcpy(&head[12], &count, 4);
+		uint64_t ofs = (head.size() + ALIGN - 1) / ALIGN * ALIGN;
+		std::vector<uint64_t> offsets;
+		for(size_t i = 0; i < m_entries.size(); i++) {
+			Entry const &en = m_entries[i];
+			unsigned char *const e = &head[HEADER_BYTES + i * ENTRY_BYTES];
+			std::memcpy(e, en.name.data(), en.name.size());
+			std::memcpy(e + NAME_LEN, &en.word_bits, 4);
+			for(unsigned d = 0; d < 3; d++)  std::memcpy(e + NAME_LEN + 4 + 4*d, &en.dims[d], 4);
+			std::memcpy(e + NAME_LEN + 16, &ofs, 8);
+			offsets.push_back(ofs);
+			ofs = (ofs + en.data.size() * 8 + ALIGN - 1) / ALIGN * ALIGN;
+		}
+		out.write(reinterpret_cast<char const*>(head.data()), head.size());
+		uint64_t pos = head.size();
+		for(size_t i = 0; i < m_entries.size(); i++) {
+			static char const zeros[ALIGN] = { 0 };
+			out.write(zeros, offsets[i] - pos);
+			out.write(reinterpret_cast<char const*>(m_entries[i].data.data()), m_entries[i].data.size() * 8);
+			pos = offsets[i] + m_entries[i].data.size() * 8;
+		}
+		if(!out)  throw std::runtime_error(path + ": write failed");
+	}
+};
+
+#endif
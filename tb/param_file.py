@@ -0,0 +1,144 @@
+#   Copyright (c) 2019, Xilinx, Inc.
+#   All rights reserved.
+# 
+#   Redistribution and use in source and binary forms, with or without 
+#   modification, are permitted provided that the following conditions are met:
+#
+#   1.  Redistributions of source code must retain the above copyright notice, 
+#       this list of conditions and the following disclaimer.
+#
+#   2.  Redistributions in binary form must reproduce the above copyright 
+#       notice, this list of conditions and the following disclaimer in the 
+#       documentation and/or other materials provided with the distribution.
+#
+#   3.  Neither the name of the copyright holder nor the names of its 
+#       contributors may be used to endorse or promote products derived from 
+#       this software without specific prior written permission.
+#
+#   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+#   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+#   THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+#   PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR 
+#   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+#   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+#   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+#   OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+#   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+#   OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+#   ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#  
+#   Writer of the binary parameter files read by param_file.hpp, see there
+#   for the layout. Also packs weight matrices and thresholds into the words
+#   of BinaryWeights / FixedPointWeights and ThresholdsActivation.
+#
+import struct
+
+MAGIC = b"FINNPARM"
+VERSION = 1
+NAME_LEN = 40
+HEADER_BYTES = 16
+ENTRY_BYTES = 64
+ALIGN = 64
+
+
+def _align(n):
+    return (n + ALIGN - 1) // ALIGN * ALIGN
+
+
+def _limbs(word_bits):
+    return (word_bits + 63) // 64
+
+
+def _shape(words):
+    dims = []
+    while isinstance(words, (list, tuple)):
+        dims.append(len(words))
+        if not words:
+            break
+        words = words[0]
+    return dims
+
+
+def _flatten(words):
+    if not isinstance(words, (list, tuple)):
+        return [words]
+    return [v for w in words for v in _flatten(w)]
+
+
+def write_params(path, tensors):
+    """Writes tensors, a list of (name, word_bits, words), where words is a
+    nested list of up to three dimensions of integers. Negative values are stored
+    in two's complement."""
+    entries = []
+    ofs = _align(HEADER_BYTES + ENTRY_BYTES * len(tensors))
+    for name, word_bits, words in tensors:
+        dims, flat = _shape(words), _flatten(words)
+        if len(dims) > 3:
+            raise ValueError("%s: more than three dimensions" % name)
+        dims += [1] * (3 - len(dims))
+        if len(name) > NAME_LEN:
+            raise ValueError("%s: name longer than %d characters" % (name, NAME_LEN))
+        mask = (1 << word_bits) - 1
+        data = bytearray()
+        for v in flat:
+            v = int(v) & mask
+            for i in range(_limbs(word_bits)):
+                data += struct.pack("<Q", (v >> (64 * i)) & 0xFFFFFFFFFFFFFFFF)
+        entries.append((name, word_bits, dims, ofs, data))
+        ofs = _align(ofs + len(data))
+
+    with open(path, "wb") as f:
+        f.write(MAGIC + struct.pack("<II", VERSION, len(entries)))
+        for name, word_bits, dims, ofs, data in entries:
+            f.write(name.encode().ljust(NAME_LEN, b"\0"))
+            f.write(struct.pack("<IIIIQ", word_bits, dims[0], dims[1], dims[2], ofs))
+        for name, word_bits, dims, ofs, data in entries:
+            f.write(b"\0" * (ofs - f.tell()))
+            f.write(data)
+
+
+def read_params(path):
+    """Returns {name: (word_bits, words)} with words as a [d0][d1][d2] nested list."""
+    with open(path, "rb") as f:
+        buf = f.read()
+    if buf[:8] != MAGIC:
+        raise ValueError("%s: not a parameter file" % path)
+    version, count = struct.unpack_from("<II", buf, 8)
+    if version != VERSION:
+        raise ValueError("%s: unsupported version %d" % (path, version))
+    tensors = {}
+    for i in range(count):
+        e = HEADER_BYTES + i * ENTRY_BYTES
+        name = buf[e:e + NAME_LEN].rstrip(b"\0").decode()
+        word_bits, d0, d1, d2, ofs = struct.unpack_from("<IIIIQ", buf, e + NAME_LEN)
+        n = _limbs(word_bits)
+        flat = []
+        for w in range(d0 * d1 * d2):
+            limbs = struct.unpack_from("<%dQ" % n, buf, ofs + 8 * n * w)
+            flat.append(sum(l << (64 * j) for j, l in enumerate(limbs)))
+        words = [[flat[(i * d1 + j) * d2:(i * d1 + j + 1) * d2] for j in range(d1)] for i in range(d0)]
+        tensors[name] = (word_bits, words)
+    return tensors
+
+
+def pack_weights(matrix, simd, pe, wbits):
+    """Packs a MatrixH x MatrixW weight matrix into the [PE][TILES] words of
+    SIMD*wbits bits: tile nf*SF + sf of PE pe holds row nf*PE + pe, and SIMD
+    lane i holds column sf*SIMD + i."""
+    m = matrix
+    mh, mw = len(m), len(m[0])
+    sf, nf = mw // simd, mh // pe
+    mask = (1 << wbits) - 1
+    words = [[0] * (nf * sf) for _ in range(pe)]
+    for r in range(mh):
+        for c in range(mw):
+            tile = (r // pe) * sf + c // simd
+            words[r % pe][tile] |= (int(m[r][c]) & mask) << (wbits * (c % simd))
+    return words
+
+
+def pack_thresholds(thresholds, pe):
+    """Rearranges MatrixH x NumTH thresholds into [PE][NF][NumTH]."""
+    t = thresholds
+    mh, num_th = len(t), len(t[0])
+    return [[[t[nf * pe + p][i] for i in range(num_th)] for nf in range(mh // pe)] for p in range(pe)]
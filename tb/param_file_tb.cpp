@@ -0,0 +1,162 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file param_file_tb.cpp
+ *
+ *  Host-only check of the binary parameter files of param_file.hpp:
+ *  round trip of weights and thresholds through ParamFileWriter and
+ *  ParamFile and, when compiled with PARAM_FILE_MEMDATA next to the
+ *  outputs of gen_weigths.py, comparison of params.bin with memdata.h.
+ *
+ *****************************************************************************/
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#define AP_INT_MAX_W 16384
+#include "ap_int.h"
+
+#include "param_file.hpp"
+#ifdef PARAM_FILE_MEMDATA
+#include "config.h"
+#include "memdata.h"
+#endif
+
+using namespace std;
+
+template<int W>
+ap_uint<W> random_word() {
+	ap_uint<W> v = 0;
+	for(int i = 0; i < W; i += 16) {
+		v = (v << 16) | ap_uint<W>(rand() & 0xFFFF);
+	}
+	return v;
+}
+
+int main(int argc, char *argv[])
+{
+	int err_counter = 0;
+	char const *const path = "param_file_tb.bin";
+	srand(5);
+#ifndef PARAM_FILE_MEMDATA
+	(void)argc;
+	(void)argv;
+#endif
+
+	static FixedPointWeights<8, ap_int<4>, 4, 16> fixed, fixed_in;
+	static BinaryWeights<96, 2, 8> binary, binary_in;
+	static ThresholdsActivation<4, 2, 3, ap_int<16>, ap_uint<2> > thresholds, thresholds_in;
+	for(unsigned pe = 0; pe < 4; pe++) {
+		for(unsigned tile = 0; tile < 16; tile++)  fixed.m_weights[pe][tile] = random_word<32>();
+	}
+	for(unsigned pe = 0; pe < 2; pe++) {
+		for(unsigned tile = 0; tile < 8; tile++)  binary.m_weights[pe][tile] = random_word<96>();
+		for(unsigned nf = 0; nf < 4; nf++) {
+			for(unsigned th = 0; th < 3; th++)  thresholds.m_thresholds[pe][nf][th] = int(rand() % 2000) - 1000;
+		}
+	}
+
+	ParamFileWriter writer;
+	writer.add("fixed", fixed);
+	writer.add("binary", binary);
+	writer.add("thresholds", thresholds);
+	writer.write(path);
+	{
+		ParamFile file(path);
+		file.load("fixed", fixed_in);
+		file.load("binary", binary_in);
+		file.load("thresholds", thresholds_in);
+		try {
+			file.load("binary", fixed_in);
+			cout << "ERROR: loading a tensor of the wrong shape succeeded" << endl;
+			err_counter++;
+		}
+		catch(std::runtime_error const &e) {
+			cout << "Rejected as expected: " << e.what() << endl;
+		}
+	}
+	remove(path);
+
+	for(unsigned pe = 0; pe < 4; pe++) {
+		for(unsigned tile = 0; tile < 16; tile++) {
+			if(fixed.m_weights[pe][tile] != fixed_in.m_weights[pe][tile]) {
+				cout << "ERROR: fixed[" << pe << "][" << tile << "]" << endl;
+				err_counter++;
+			}
+		}
+	}
+	for(unsigned pe = 0; pe < 2; pe++) {
+		for(unsigned tile = 0; tile < 8; tile++) {
+			if(binary.m_weights[pe][tile] != binary_in.m_weights[pe][tile]) {
+				cout << "ERROR: binary[" << pe << "][" << tile << "]" << endl;
+				err_counter++;
+			}
+		}
+		for(unsigned nf = 0; nf < 4; nf++) {
+			for(unsigned th = 0; th < 3; th++) {
+				if(thresholds.m_thresholds[pe][nf][th] != thresholds_in.m_thresholds[pe][nf][th]) {
+					cout << "ERROR: thresholds[" << pe << "][" << nf << "][" << th << "] expected "
+					     << thresholds.m_thresholds[pe][nf][th] << " actual " << thresholds_in.m_thresholds[pe][nf][th] << endl;
+					err_counter++;
+				}
+			}
+		}
+	}
+	cout << "Round trip " << (err_counter == 0? "passed" : "failed") << " the testing." << endl;
+
+#ifdef PARAM_FILE_MEMDATA
+	if(argc > 1) {
+		int const err_before = err_counter;
+		ParamFile file(argv[1]);
+		decltype(PARAM::weights) *const loaded = new decltype(PARAM::weights);
+		file.load("weights", *loaded);
+		for(unsigned pe = 0; pe < PE1; pe++) {
+			for(unsigned tile = 0; tile < TILE1; tile++) {
+				if(loaded->m_weights[pe][tile] != PARAM::weights.m_weights[pe][tile]) {
+					cout << "ERROR: weights[" << pe << "][" << tile << "] differ from memdata.h" << endl;
+					err_counter++;
+				}
+			}
+		}
+		delete loaded;
+		cout << argv[1] << (err_counter == err_before? " matches" : " does not match") << " memdata.h" << endl;
+	}
+#endif
+
+	if(err_counter == 0){
+		return 0;
+	}
+	else{
+		return 1;
+	}
+
+}
@@ -0,0 +1,87 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file probe_tb.cpp
+ *
+ *  Testbench for the stream probes, checking the forwarded stream and the counters of the debug bus
+ *
+ *****************************************************************************/
+#include <iostream>
+#include <hls_stream.h>
+#include "ap_int.h"
+#include "bnn-library.h"
+
+#include "probe_config.h"
+
+using namespace hls;
+using namespace std;
+
+#define MAX_IMAGES 4
+void Testbench_probe(stream<ap_uint<WIDTH> > & in, stream<ap_uint<WIDTH> > & out,
+                     ap_uint<32> counters[NUM_PROBES * StreamProbeBus::COUNTERS], unsigned int numReps);
+
+int main()
+{
+	stream<ap_uint<WIDTH> > input_stream("input_stream");
+	stream<ap_uint<WIDTH> > output_stream("output_stream");
+	ap_uint<32> counters[NUM_PROBES * StreamProbeBus::COUNTERS];
+	for (unsigned int i = 0; i < NUM_WORDS * MAX_IMAGES; i++) {
+		input_stream.write(ap_uint<WIDTH>(i * 7 + 3));
+	}
+	Testbench_probe(input_stream, output_stream, counters, MAX_IMAGES);
+	int err_counter = 0;
+	for (unsigned int i = 0; i < NUM_WORDS * MAX_IMAGES; i++) {
+		ap_uint<WIDTH> const value = output_stream.read();
+		if (value != ap_uint<WIDTH>(i * 7 + 3)) {
+			std::cout << "ERROR: forwarded[" << i << "]=" << value << std::endl;
+			err_counter++;
+		}
+	}
+	unsigned const expected_words[NUM_PROBES] = { NUM_WORDS * MAX_IMAGES, NUM_WORDS / 2 * MAX_IMAGES, NUM_WORDS * MAX_IMAGES };
+	for (unsigned int p = 0; p < NUM_PROBES; p++) {
+		ap_uint<32> const *const c = counters + p * StreamProbeBus::COUNTERS;
+		std::cout << "Probe " << p << ": " << c[StreamProbeBus::WORDS] << " words, "
+		          << c[StreamProbeBus::STARVED] << " starved, " << c[StreamProbeBus::STALLED] << " stalled" << std::endl;
+		if (c[StreamProbeBus::WORDS] != expected_words[p]) {
+			std::cout << "ERROR: probe " << p << " expected " << expected_words[p] << " words" << std::endl;
+			err_counter++;
+		}
+	}
+	if(err_counter == 0){
+		std::cout << "Stream probe test passed." << std::endl;
+		return 0;
+	}
+	else{
+		return 1;
+	}
+}
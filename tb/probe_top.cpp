@@ -0,0 +1,64 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file probe_top.cpp
+ *
+ *  HLS Top function with stream probes around two width converters for unit testing
+ *
+ *****************************************************************************/
+#include <hls_stream.h>
+using namespace hls;
+#include "ap_int.h"
+#include "bnn-library.h"
+
+#include "probe_config.h"
+
+void Testbench_probe(stream<ap_uint<WIDTH> > & in, stream<ap_uint<WIDTH> > & out,
+                     ap_uint<32> counters[NUM_PROBES * StreamProbeBus::COUNTERS], unsigned int numReps) {
+#pragma HLS INTERFACE s_axilite port=counters bundle=control
+#pragma HLS DATAFLOW
+	FINN_DATAFLOW_REGION;
+	stream<ap_uint<WIDTH> > in_probed("in_probed");
+	stream<ap_uint<2*WIDTH> > wide("wide");
+	stream<ap_uint<2*WIDTH> > wide_probed("wide_probed");
+	stream<ap_uint<WIDTH> > narrow("narrow");
+	stream<StreamProbeBus::Record> bus0("bus0");
+	stream<StreamProbeBus::Record> bus1("bus1");
+	stream<StreamProbeBus::Record> bus2("bus2");
+	FINN_DATAFLOW_STAGE(StreamProbe_Batch<WIDTH, NUM_WORDS>(in, in_probed, bus0, numReps));
+	FINN_DATAFLOW_STAGE(StreamingDataWidthConverter_Batch<WIDTH, 2*WIDTH, NUM_WORDS>(in_probed, wide, numReps));
+	FINN_DATAFLOW_STAGE(StreamProbe_Batch<2*WIDTH, NUM_WORDS/2, 1>(wide, wide_probed, bus0, bus1, numReps));
+	FINN_DATAFLOW_STAGE(StreamingDataWidthConverter_Batch<2*WIDTH, WIDTH, NUM_WORDS/2>(wide_probed, narrow, numReps));
+	FINN_DATAFLOW_STAGE(StreamProbe_Batch<WIDTH, NUM_WORDS, 2>(narrow, out, bus1, bus2, numReps));
+	StreamProbeCollect<NUM_PROBES>(bus2, counters);
+}
@@ -0,0 +1,114 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file stream_tap_tb.cpp
+ *
+ *  Testbench for the stream tap, checking both the forwarded stream and the ring-buffered trace
+ *
+ *****************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <cstdint>
+#include <hls_stream.h>
+#include <cstdlib>
+#define AP_INT_MAX_W 16384
+#include "ap_int.h"
+#include "bnn-library.h"
+
+#include "stream_tap_config.h"
+
+using namespace hls;
+using namespace std;
+
+#define MAX_IMAGES 5
+void Testbench_stream_tap(stream<ap_uint<WIDTH> > & in, stream<ap_uint<WIDTH> > & out, unsigned int numReps);
+
+static uint64_t get(std::ifstream &ifs, unsigned const bytes) {
+	uint64_t val = 0;
+	for (unsigned int i = 0; i < bytes; i++) {
+		val |= uint64_t((unsigned char)ifs.get()) << (8*i);
+	}
+	return val;
+}
+
+static ap_uint<WIDTH> word(uint64_t const idx) {
+	return ap_uint<WIDTH>(idx * 37 + 5);
+}
+
+int main()
+{
+	stream<ap_uint<WIDTH> > input_stream("input_stream");
+	stream<ap_uint<WIDTH> > output_stream("output_stream");
+	for (unsigned int i = 0; i < NUM_WORDS * MAX_IMAGES; i++) {
+		input_stream.write(word(i));
+	}
+	Testbench_stream_tap(input_stream, output_stream, MAX_IMAGES);
+	int err_counter = 0;
+	for (unsigned int i = 0; i < NUM_WORDS * MAX_IMAGES; i++) {
+		ap_uint<WIDTH> const value = output_stream.read();
+		if (value != word(i)) {
+			std::cout << "ERROR: forwarded[" << i << "]=" << value << " expected " << word(i) << std::endl;
+			err_counter++;
+		}
+	}
+
+	std::ifstream ifs("stream_tap.bin", std::ios::binary);
+	char magic[4];
+	ifs.read(magic, 4);
+	unsigned const width = get(ifs, 4), bytes = get(ifs, 4), sample = get(ifs, 4);
+	uint64_t const max_records = get(ifs, 8), records = get(ifs, 8);
+	uint64_t const expected_records = (NUM_WORDS * MAX_IMAGES + SAMPLE_INTERVAL - 1) / SAMPLE_INTERVAL;
+	if ((std::string(magic, 4) != "FTAP") || (width != WIDTH) || (bytes != (WIDTH + 7) / 8) ||
+	    (sample != SAMPLE_INTERVAL) || (max_records != MAX_RECORDS) || (records != expected_records)) {
+		std::cout << "ERROR: bad trace header, " << records << " records" << std::endl;
+		return 1;
+	}
+	// only the last MAX_RECORDS records survive, record r in slot r % MAX_RECORDS
+	for (uint64_t r = records - MAX_RECORDS; r < records; r++) {
+		ifs.seekg(32 + (r % MAX_RECORDS) * (8 + bytes));
+		uint64_t const idx = get(ifs, 8);
+		ap_uint<WIDTH> const value = get(ifs, bytes);
+		if ((idx != r * SAMPLE_INTERVAL) || (value != word(idx))) {
+			std::cout << "ERROR: record " << r << " holds index " << idx << " value " << value << std::endl;
+			err_counter++;
+		}
+	}
+	if(err_counter == 0){
+		std::cout << "Stream tap test passed." << std::endl;
+		return 0;
+	}
+	else{
+		return 1;
+	}
+
+}
@@ -0,0 +1,112 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file tconv.hpp
+ *
+ *  C++ Implementation of a transposed convolution, used for testbench
+ *
+ *****************************************************************************/
+#ifndef TCONV_TB_H
+#define TCONV_TB_H
+
+/**
+ * Reference transposed convolution: every input pixel scatters its
+ * contribution over a kernel-sized window of the (uncropped) output.
+ */
+template<int MAX_IMAGE,
+	int IFMDim,
+	int OFMDim,
+	int IFMCh,
+	int OFMCh,
+	int kernel,
+	int stride,
+	int padding,
+	typename TI,
+	typename TO,
+	typename TW>
+	void tconv(TI const img[MAX_IMAGE][IFMDim][IFMDim][IFMCh], TW const weights[OFMCh][kernel][kernel][IFMCh], TO out[MAX_IMAGE][OFMDim][OFMDim][OFMCh]){
+		for(int n=0;n<MAX_IMAGE;n++) {
+			for(int y=0;y<OFMDim;y++)
+				for(int x=0;x<OFMDim;x++)
+					for(int h=0;h<OFMCh;h++)
+						out[n][y][x][h] = 0;
+			for(int iy=0;iy<IFMDim;iy++)
+				for(int ix=0;ix<IFMDim;ix++)
+					for (int ky=0;ky<kernel;ky++)
+						for (int kx=0;kx<kernel;kx++) {
+							int const oy = iy*stride + ky - padding;
+							int const ox = ix*stride + kx - padding;
+							if((oy < 0) || (oy >= OFMDim) || (ox < 0) || (ox >= OFMDim))
+								continue;
+							for(int h=0;h<OFMCh;h++)
+								for(int w=0;w<IFMCh;w++)
+									out[n][oy][ox][h] += img[n][iy][ix][w] * weights[h][ky][kx][w];
+						}
+		}
+	}
+
+/**
+ * Packs a transposed convolution kernel into the sub-pixel weight matrix
+ * expected by TransposedConvLayer_Batch, in the [PE][TILES] layout of
+ * FixedPointWeights.
+ */
+template<int IFMCh,
+	int OFMCh,
+	int kernel,
+	int stride,
+	int SIMD,
+	int PE,
+	int WIDTH,
+	typename TW>
+	void tconv_pack_weights(TW const weights[OFMCh][kernel][kernel][IFMCh], ap_uint<SIMD*WIDTH> packed[PE][((kernel+stride-1)/stride)*((kernel+stride-1)/stride)*IFMCh/SIMD * stride*stride*OFMCh/PE]){
+		constexpr int subkernel = (kernel+stride-1)/stride;
+		constexpr int MatrixW = subkernel*subkernel*IFMCh;
+		constexpr int MatrixH = stride*stride*OFMCh;
+		constexpr int SF = MatrixW / SIMD;
+		for(int row=0;row<MatrixH;row++)
+			for(int col=0;col<MatrixW;col++) {
+				int const sub = row / OFMCh, h = row % OFMCh;
+				int const ry = sub / stride, rx = sub % stride;
+				int const k = col / IFMCh, w = col % IFMCh;
+				int const ky = (subkernel - 1 - k / subkernel) * stride + ry;
+				int const kx = (subkernel - 1 - k % subkernel) * stride + rx;
+				ap_int<WIDTH> value = 0;
+				if((ky < kernel) && (kx < kernel))
+					value = weights[h][ky][kx][w];
+				int const tile = (row / PE) * SF + col / SIMD;
+				int const simd = col % SIMD;
+				packed[row % PE][tile]((simd+1)*WIDTH-1, simd*WIDTH) = value;
+			}
+	}
+
+#endif
@@ -0,0 +1,115 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file xnorfc_tb.cpp
+ *
+ *  Testbench for the binarized (XNOR-popcount) fully connected layer
+ *
+ *****************************************************************************/
+#include <iostream>
+#include <cstdlib>
+#include <hls_stream.h>
+#define AP_INT_MAX_W 16384
+#include "ap_int.h"
+#include "bnn-library.h"
+
+#include "xnorfc_config.h"
+
+using namespace hls;
+using namespace std;
+
+#define MAX_IMAGES 4
+void Testbench_xnorfc(stream<ap_uint<SIMD1> > & in, stream<ap_uint<MATRIX_H*ACC_PRECISION> > & out, ap_uint<SIMD1> const weights[PE1][TILES1], unsigned int numReps);
+
+int main()
+{
+	static	ap_uint<1> W[MATRIX_H][MATRIX_W];
+	static	ap_uint<1> IMAGE[MAX_IMAGES][MATRIX_W];
+	static	ap_uint<SIMD1> PACKED[PE1][TILES1];
+	stream<ap_uint<SIMD1> > input_stream("input_stream");
+	stream<ap_uint<MATRIX_H*ACC_PRECISION> > output_stream("output_stream");
+	srand(7);
+	for (unsigned int h = 0; h < MATRIX_H; h++) {
+		for (unsigned int w = 0; w < MATRIX_W; w++) {
+			W[h][w] = rand() & 1;
+		}
+	}
+	// tile = nf*SF + sf, SIMD lane i of row nf*PE+pe holds column sf*SIMD+i
+	unsigned const SF = MATRIX_W / SIMD1;
+	for (unsigned int h = 0; h < MATRIX_H; h++) {
+		for (unsigned int w = 0; w < MATRIX_W; w++) {
+			PACKED[h % PE1][(h / PE1) * SF + w / SIMD1][w % SIMD1] = W[h][w];
+		}
+	}
+	for (unsigned int n_image = 0; n_image < MAX_IMAGES; n_image++) {
+		for (unsigned int sf = 0; sf < SF; sf++) {
+			ap_uint<SIMD1> input = 0;
+			for (unsigned int i = 0; i < SIMD1; i++) {
+				IMAGE[n_image][sf * SIMD1 + i] = rand() & 1;
+				input[i] = IMAGE[n_image][sf * SIMD1 + i];
+			}
+			input_stream.write(input);
+		}
+	}
+	Testbench_xnorfc(input_stream, output_stream, PACKED, MAX_IMAGES);
+	int err_counter = 0, err_perimage=0;
+	for (unsigned int n_image = 0; n_image < MAX_IMAGES; n_image++) {
+		ap_uint<MATRIX_H*ACC_PRECISION> outElem = output_stream.read();
+		for (unsigned int h = 0; h < MATRIX_H; h++) {
+			unsigned int EXP = 0;
+			for (unsigned int w = 0; w < MATRIX_W; w++) {
+				EXP += (W[h][w] == IMAGE[n_image][w])? 1 : 0;
+			}
+			ap_uint<ACC_PRECISION> out = outElem((h+1)*ACC_PRECISION-1, h*ACC_PRECISION);
+			if (EXP != out){
+				std::cout << "ERROR: Expected["<<h<<"]=" << EXP << " actual " << out << std::endl;
+				err_counter ++;
+				err_perimage++;
+			}
+		}
+		if(err_perimage == 0){
+			std::cout << "Image # " << n_image << " passed the testing."<< std::endl;
+		}
+		else{
+			err_perimage=0;
+			std::cout << "Image # " << n_image << " failed the testing."<< std::endl;
+		}
+	}
+	if(err_counter == 0){
+		return 0;
+	}
+	else{
+		return 1;
+	}
+
+}
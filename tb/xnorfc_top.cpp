@@ -0,0 +1,60 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+/******************************************************************************
+ *
+ *  \file xnorfc_top.cpp
+ *
+ *  HLS Top function with a single binarized fully connected layer for unit testing
+ *
+ *****************************************************************************/
+#include <hls_stream.h>
+using namespace hls;
+#include "ap_int.h"
+#include "bnn-library.h"
+
+#include "activations.hpp"
+#include "weights.hpp"
+#include "interpret.hpp"
+#include "mvau.hpp"
+#include "xnorfc_config.h"
+
+void Testbench_xnorfc(stream<ap_uint<SIMD1> > & in, stream<ap_uint<MATRIX_H*ACC_PRECISION> > & out, ap_uint<SIMD1> const weights[PE1][TILES1], unsigned int numReps){
+	BinaryWeights<SIMD1, PE1, TILES1> params;
+#pragma HLS ARRAY_PARTITION variable=params.m_weights complete dim=1
+	for(unsigned int tile = 0; tile < TILES1; tile++) {
+		for(unsigned int pe = 0; pe < PE1; pe++) {
+#pragma HLS PIPELINE II=1
+			params.m_weights[pe][tile] = weights[pe][tile];
+		}
+	}
+	StreamingFCLayer_Batch<MATRIX_W, MATRIX_H, SIMD1, PE1, Recast<XnorMul>, Slice<ap_uint<ACC_PRECISION> > >(in, out, params, PassThroughActivation<ap_uint<ACC_PRECISION>>(), numReps, ap_resource_lut());
+}
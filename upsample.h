@@ -0,0 +1,287 @@
+/******************************************************************************
+ *  Copyright (c) 2019, Xilinx, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2.  Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *  3.  Neither the name of the copyright holder nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION). HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ *  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/******************************************************************************
+ *
+ *  \file upsample.h
+ *
+ *  Library of templated HLS functions for BNN deployment.
+ *  This file lists a set of functions used to implement upsampling layers,
+ *  i.e. nearest-neighbour upsampling and the streaming stages of a
+ *  transposed convolution.
+ *
+ *  The transposed convolution is computed without zero insertion: a stride-S
+ *  transposed convolution with kernel K is split into S*S sub-pixel
+ *  convolutions of kernel Kp = ceil(K/S) over the (border-padded) input.
+ *  All sub-pixel outputs of one input position are produced by a single
+ *  Matrix_Vector_Activate_Batch invocation (MatrixH = S*S*OFMChannels) and
+ *  interleaved back into the output image by DepthToSpace_Batch.
+ *
+ *****************************************************************************/
+
+#ifndef UPSAMPLE_H
+#define UPSAMPLE_H
+
+#include "dataflow.h"
+
+/**
+ * \brief   Nearest-neighbour upsampling by an integer factor
+ *
+ * Every input pixel is replicated Factor times along both image dimensions.
+ * A single row of the input image is buffered, so that the replicated rows
+ * can be emitted without re-reading the input. One output pixel is produced
+ * per clock cycle.
+ *
+ * \tparam IFMDim       Width and Heigth of the Input Feature Map (assumed square)
+ * \tparam Factor       Upsampling factor
+ * \tparam NumChannels  Number of Input Feature Maps
+ * \tparam ActType      DataType of the input activation (as used in the comparison)
+ *
+ * \param in            Input stream
+ * \param out           Output stream
+ * \param numReps       Number of time the function has to be repeatedly executed (e.g. number of images)
+ */
+template<
+		unsigned int IFMDim,
+		unsigned int Factor,
+		unsigned int NumChannels,
+		typename ActType>
+void Upsample_Batch(stream<ap_uint<NumChannels * ActType::width> > & in,
+		stream<ap_uint<NumChannels * ActType::width> > & out, const unsigned int numReps) {
+  // single row of input pixels, reused for the Factor replicated output rows
+  ap_uint<NumChannels * ActType::width> buf[IFMDim];
+  unsigned int const OFMDim = IFMDim * Factor;
+
+  unsigned int x = 0;   // input column
+  unsigned int rx = 0;  // replica index along the row
+  unsigned int ry = 0;  // replica index of the current output row
+  for (unsigned int i = 0; i < numReps * OFMDim * OFMDim; i++) {
+#pragma HLS PIPELINE II=1
+    ap_uint<NumChannels * ActType::width> elem;
+    if ((ry == 0) && (rx == 0)) {
+      // first occurrence of this pixel, read it and keep it for the next rows
+      elem = in.read();
+      buf[x] = elem;
+    } else {
+      elem = buf[x];
+    }
+    out.write(elem);
+    // wraparound indices to recreate the nested loop structure
+    if (++rx == Factor) {
+      rx = 0;
+      if (++x == IFMDim) {
+        x = 0;
+        if (++ry == Factor) {
+          ry = 0;
+        }
+      }
+    }
+  }
+}
+
+/**
+ * \brief   Zero padding of the border of a feature map
+ *
+ * Adds Padding rows and columns of zeros on each side of the input image.
+ * Pixels are streamed as IFMChannels/SIMD words of SIMD channels each, as for
+ * the ConvolutionInputGenerator.
+ *
+ * \tparam IFMDim           Width and Heigth of the Input Feature Map (assumed square)
+ * \tparam Padding          Number of zero pixels added on each side
+ * \tparam IFMChannels      Number of Input Feature Maps
+ * \tparam SIMD             Number of channels per stream word
+ * \tparam Input_precision  Number bits per channel
+ *
+ * \param in                Input stream
+ * \param out               Output stream
+ * \param numReps           Number of time the function has to be repeatedly executed (e.g. number of images)
+ */
+template<
+		unsigned int IFMDim,
+		unsigned int Padding,
+		unsigned int IFMChannels,
+		unsigned int SIMD,
+		unsigned int Input_precision>
+void ZeroPadding_Batch(stream<ap_uint<SIMD*Input_precision> > & in,
+		stream<ap_uint<SIMD*Input_precision> > & out, const unsigned int numReps) {
+  CASSERT_DATAFLOW(IFMChannels % SIMD == 0);
+  unsigned int const multiplying_factor = IFMChannels / SIMD;
+  unsigned int const OFMDim = IFMDim + 2 * Padding;
+
+  unsigned int y = 0, x = 0, count_simd = 0;
+  for (unsigned int i = 0; i < numReps * OFMDim * OFMDim * multiplying_factor; i++) {
+#pragma HLS PIPELINE II=1
+    bool const inside = (y >= Padding) && (y < Padding + IFMDim) &&
+                        (x >= Padding) && (x < Padding + IFMDim);
+    ap_uint<SIMD*Input_precision> outElem = 0;
+    if (inside) {
+      outElem = in.read();
+    }
+    out.write(outElem);
+    if (++count_simd == multiplying_factor) {
+      count_simd = 0;
+      if (++x == OFMDim) {
+        x = 0;
+        if (++y == OFMDim) {
+          y = 0;
+        }
+      }
+    }
+  }
+}
+
+/**
+ * \brief Sliding Window unit for a transposed convolution, producing output
+ * vectors for feeding a Matrix_Vector_Activate_Batch.
+ *
+ * The transposed convolution with kernel ConvKernelDim and Stride is evaluated
+ * as a stride-1 convolution with kernel Kp = ceil(ConvKernelDim/Stride) over the
+ * input padded with Kp-1 zero pixels on each side. No zeros are inserted between
+ * input pixels, so every generated vector only contains real input data
+ * (apart from the image border). The generator emits
+ * Q*Q vectors per image, with Q = IFMDim + Kp - 1, each made of
+ * Kp*Kp*IFMChannels/SIMD words in (k_y, k_x, channel) order.
+ *
+ * The matching weight matrix has MatrixW = Kp*Kp*IFMChannels columns and
+ * MatrixH = Stride*Stride*OFMChannels rows. Row (r_y*Stride + r_x)*OFMChannels + c
+ * and column (k_y*Kp + k_x)*IFMChannels + ic hold the kernel coefficient
+ * w[c][(Kp-1-k_y)*Stride + r_y][(Kp-1-k_x)*Stride + r_x][ic], or zero where either
+ * kernel index is beyond ConvKernelDim. The MVAU output is rearranged into the
+ * final image by DepthToSpace_Batch.
+ *
+ * \tparam ConvKernelDim    Dimension of the transposed convolutional kernel (assumed square)
+ * \tparam IFMChannels      Number of Input Feature Maps
+ * \tparam Input_precision  Number bits per pixel
+ * \tparam IFMDim           Width and Heigth of the Input Feature Map (assumed square)
+ * \tparam SIMD             Number of input columns computed in parallel
+ * \tparam Stride           Stride (i.e. upsampling factor) of the transposed convolution
+ *
+ * \param in                Input stream
+ * \param out               Output stream
+ * \param numReps           Number of time the function has to be repeatedly executed (e.g. number of images)
+ */
+template<unsigned int ConvKernelDim,
+		 unsigned int IFMChannels,
+		 unsigned int Input_precision,
+		 unsigned int IFMDim,
+		 unsigned int SIMD,
+		 unsigned int Stride>
+void TransposedConvolutionInputGenerator(
+		stream<ap_uint<SIMD*Input_precision> > & in,
+		stream<ap_uint<SIMD*Input_precision> > & out,
+		const unsigned int numReps = 1) {
+#pragma HLS INLINE
+  FINN_DATAFLOW_REGION;
+  unsigned int const SubKernelDim = (ConvKernelDim + Stride - 1) / Stride;
+  unsigned int const PaddedDim = IFMDim + 2 * (SubKernelDim - 1);
+  unsigned int const SubOFMDim = IFMDim + SubKernelDim - 1;
+  hls::stream<ap_uint<SIMD*Input_precision> > padded("TransposedConvolutionInputGenerator.padded");
+  FINN_DATAFLOW_STAGE(ZeroPadding_Batch<IFMDim, SubKernelDim - 1, IFMChannels, SIMD, Input_precision>(in, padded, numReps));
+  FINN_DATAFLOW_STAGE(ConvolutionInputGenerator<SubKernelDim, IFMChannels, Input_precision, PaddedDim,
+			SubOFMDim, SIMD, 1>(padded, out, numReps));
+}
+
+/**
+ * \brief   Rearrangement of sub-pixel channels into the spatial dimensions
+ *
+ * Each input pixel carries Factor*Factor sub-pixels of NumChannels channels,
+ * streamed as Factor*Factor words in (r_y, r_x) order. Sub-pixel (r_y, r_x)
+ * of input pixel (y, x) is placed at output pixel (y*Factor + r_y, x*Factor + r_x).
+ * The full InDim*Factor image is cropped to OFMDim pixels starting at Crop,
+ * which implements the padding of a transposed convolution.
+ *
+ * Two row buffers are used in ping-pong fashion: one sub-pixel row of the
+ * input is written while the previous one is emitted, so that a word is
+ * consumed and (unless cropped) produced every clock cycle.
+ *
+ * \tparam InDim        Width and Heigth of the input grid (assumed square)
+ * \tparam Factor       Number of sub-pixels along each dimension
+ * \tparam NumChannels  Number of channels per sub-pixel
+ * \tparam ActType      DataType of the activations
+ * \tparam OFMDim       Width and Heigth of the Output Feature Map (assumed square)
+ * \tparam Crop         Number of pixels dropped at the top and left image border
+ *
+ * \param in            Input stream
+ * \param out           Output stream
+ * \param numReps       Number of time the function has to be repeatedly executed (e.g. number of images)
+ */
+template<
+		unsigned int InDim,
+		unsigned int Factor,
+		unsigned int NumChannels,
+		typename ActType,
+		unsigned int OFMDim = InDim * Factor,
+		unsigned int Crop = 0>
+void DepthToSpace_Batch(stream<ap_uint<NumChannels * ActType::width> > & in,
+		stream<ap_uint<NumChannels * ActType::width> > & out, const unsigned int numReps) {
+  CASSERT_DATAFLOW(Crop + OFMDim <= InDim * Factor);
+  unsigned int const RowWords = InDim * Factor * Factor;
+  ap_uint<NumChannels * ActType::width> buf[2][RowWords];
+#pragma HLS ARRAY_PARTITION variable=buf complete dim=1
+
+  unsigned int wr_bank = 0;
+  unsigned int rd_y = 0; // input row being emitted, within the image
+  // one extra row iteration to drain the last buffered row
+  for (unsigned int row = 0; row <= numReps * InDim; row++) {
+    unsigned int x = 0, r_x = 0, r_y = 0;
+    for (unsigned int i = 0; i < RowWords; i++) {
+#pragma HLS PIPELINE II=1
+#pragma HLS DEPENDENCE variable=buf inter false
+      if (row < numReps * InDim) {
+        buf[wr_bank][i] = in.read();
+      }
+      if (row > 0) {
+        // emission order: r_y, x, r_x
+        unsigned int const oy = rd_y * Factor + r_y;
+        unsigned int const ox = x * Factor + r_x;
+        if ((oy >= Crop) && (oy < Crop + OFMDim) && (ox >= Crop) && (ox < Crop + OFMDim)) {
+          out.write(buf[1 - wr_bank][(x * Factor + r_y) * Factor + r_x]);
+        }
+        if (++r_x == Factor) {
+          r_x = 0;
+          if (++x == InDim) {
+            x = 0;
+            r_y++;
+          }
+        }
+      }
+    }
+    if (row > 0) {
+      if (++rd_y == InDim) {
+        rd_y = 0;
+      }
+    }
+    wr_bank = 1 - wr_bank;
+  }
+}
+
+#endif
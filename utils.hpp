@@ -51,6 +51,7 @@
 #include <iostream>
 #include <fstream>
 #include <cstddef>
+#include <cstdint>
 
 //- Static Evaluation of ceil(log2(x)) ---------------------------------------
 template<size_t N> struct clog2 {
@@ -75,6 +76,8 @@ class ap_resource_dsp {};
 /**
  * \brief   Stream logger - Logging call to dump on file - not synthezisable
  *
+ * Drains and refills the whole stream, so it can only be used on a stream that
+ * is not being consumed concurrently. Prefer StreamTap for tracing live pipelines.
  *
  * \tparam     BitWidth    Width, in number of bits, of the input (and output) stream
  *
@@ -101,4 +104,130 @@ void logStringStream(const char *layer_name, hls::stream<ap_uint<BitWidth> > &lo
   ofs.close();
 }
 
+/**
+ * \brief   Binary trace of the words flowing through a StreamTap - only active in C-sim
+ *
+ * Every SampleInterval-th word is recorded together with its index in the stream.
+ * When MaxRecords is non-zero, the trace file is used as a ring buffer of MaxRecords
+ * records, so that only the most recent ones are kept and the file size is bounded
+ * irrespective of the length of the run.
+ *
+ * File layout (little endian): a 32-byte header made of the magic "FTAP", the
+ * uint32 BitWidth, the uint32 number of bytes per word, the uint32 SampleInterval,
+ * the uint64 MaxRecords and the uint64 number of records taken so far, followed by
+ * records of an uint64 word index and the word itself, least significant byte first.
+ * Record i of the run is stored in slot i % MaxRecords.
+ *
+ * In synthesis the class is empty and recording is a no-op.
+ *
+ * \tparam     BitWidth    Width, in number of bits, of the traced stream
+ */
+template<unsigned int BitWidth>
+class StreamTrace {
+#ifndef __SYNTHESIS__
+  static unsigned const  BYTES = (BitWidth + 7) / 8;
+  static unsigned const  HEADER_SIZE = 32;
+  static unsigned const  RECORD_SIZE = 8 + BYTES;
+
+  std::ofstream       m_file;
+  unsigned const      m_sample;
+  uint64_t const      m_max_records;
+  uint64_t            m_seen;     // words observed
+  uint64_t            m_records;  // records taken
+
+  template<typename T>
+  void put(T  val, unsigned const  bytes) {
+    for(unsigned  i = 0; i < bytes; i++) {
+      m_file.put(static_cast<char>(val & 0xFF));
+      val >>= 8;
+    }
+  }
+
+  void writeHeader() {
+    m_file.seekp(0);
+    m_file.write("FTAP", 4);
+    put<uint32_t>(BitWidth, 4);
+    put<uint32_t>(BYTES, 4);
+    put<uint32_t>(m_sample, 4);
+    put<uint64_t>(m_max_records, 8);
+    put<uint64_t>(m_records, 8);
+  }
+#endif
+
+ public:
+  StreamTrace(char const *file_name, unsigned const  sample_interval = 1, uint64_t const  max_records = 0)
+#ifndef __SYNTHESIS__
+    : m_file(file_name, std::ios::binary | std::ios::out | std::ios::trunc),
+      m_sample(sample_interval == 0? 1 : sample_interval), m_max_records(max_records),
+      m_seen(0), m_records(0) {
+    if(!m_file) {
+      std::cerr << "StreamTrace: cannot open " << file_name << std::endl;
+    }
+    writeHeader();
+  }
+#else
+  {}
+#endif
+
+  ~StreamTrace() {
+#ifndef __SYNTHESIS__
+    writeHeader();
+    m_file.close();
+#endif
+  }
+
+ public:
+  void record(ap_uint<BitWidth> const &word) {
+#ifndef __SYNTHESIS__
+    uint64_t const  idx = m_seen++;
+    if(idx % m_sample != 0)  return;
+    uint64_t const  slot = m_max_records == 0? m_records : m_records % m_max_records;
+    m_file.seekp(HEADER_SIZE + slot * RECORD_SIZE);
+    put<uint64_t>(idx, 8);
+    ap_uint<BitWidth>  val = word;
+    for(unsigned  i = 0; i < BYTES; i++) {
+      m_file.put(static_cast<char>(ap_uint<8>(val).to_uint()));
+      val = val >> 8;
+    }
+    m_records++;
+#endif
+  }
+
+  uint64_t records() const {
+#ifndef __SYNTHESIS__
+    return  m_records;
+#else
+    return  0;
+#endif
+  }
+};
+
+/**
+ * \brief   Stream tap - Pass-through stage recording the words flowing through a stream
+ *
+ * To be inserted between a producer and a consumer, e.g. in a DATAFLOW region.
+ * Words are forwarded unchanged at II=1 and, in C-sim only, recorded into the
+ * trace as they pass, so that long multi-frame runs can be observed without
+ * buffering the stream content. In synthesis the stage is a plain FIFO copy.
+ *
+ * \tparam     BitWidth    Width, in number of bits, of the input (and output) stream
+ *
+ * \param      in          Input stream
+ * \param      out         Output stream
+ * \param      trace       Trace recording the forwarded words
+ * \param      numWords    Number of words to be forwarded
+ */
+template<unsigned int BitWidth>
+void StreamTap(hls::stream<ap_uint<BitWidth> > &in, hls::stream<ap_uint<BitWidth> > &out,
+               StreamTrace<BitWidth> &trace, unsigned const  numWords) {
+  for(unsigned  i = 0; i < numWords; i++) {
+#pragma HLS PIPELINE II=1
+    ap_uint<BitWidth> const  word = in.read();
+#ifndef __SYNTHESIS__
+    trace.record(word);
+#endif
+    out.write(word);
+  }
+}
+
 #endif
@@ -55,6 +55,7 @@
 #include <array>
 #include <type_traits>
 #include "deinterleave.h"
+#include "interpret.hpp"
 
 
 /**
@@ -327,6 +328,16 @@ class FixedPointWeights {
     std::array<WT,SIMD> operator[](unsigned const  pe) const {
 #pragma HLS inline
       std::array<WT,SIMD> temp;
+#ifdef FINN_NATIVE_CSIM
+      if(SIMD*WT::width <= 64) {
+        uint64_t const  w = m_par.m_weights[pe][m_idx].to_uint64();
+        for(unsigned int i=0; i<SIMD; i++) {
+          ap_int<WT::width> const  local_temp = ap_uint<WT::width>(finn::native::field(w, i*WT::width, WT::width));
+          temp[i] = *reinterpret_cast<WT const*>(&local_temp);
+        }
+        return  temp;
+      }
+#endif
 	  for(unsigned int i=0; i<SIMD; i++) {
 #pragma HLS unroll
         ap_int<WT::width> local_temp;
@@ -502,4 +513,37 @@ void loadORAMWeights(Weights& weights, ORAM& oram, const ATU& atu, uint8_t* bloc
   }
 }
 
+/**
+ * Loads the weights like loadORAMWeights, but through an ORAMRequestCoalescer
+ * (see oram/request_coalescer.h), so that the elements sharing an ORAM block
+ * cost a single access per queue flush.
+ */
+template<size_t Layer, unsigned SIMD, typename WT ,unsigned PE, unsigned TILES, typename Weights, typename Coalescer, typename ORAM, typename ATU>
+void loadORAMWeightsCoalesced(Weights& weights, Coalescer& queue, ORAM& oram, const ATU& atu, uint8_t* server_data) {
+  const size_t element_size = atu.element_size(Layer);
+  uint32_t tickets[Coalescer::queue_depth];
+  size_t   offsets[Coalescer::queue_depth];
+
+  for (unsigned base = 0; base < PE * TILES; base += Coalescer::queue_depth) {
+    const unsigned count = (PE * TILES - base < Coalescer::queue_depth) ? (PE * TILES - base) : Coalescer::queue_depth;
+
+    for (unsigned i = 0; i < count; ++i) {
+      const std::pair<size_t, size_t> block_byte = atu.index_to_block(Layer, (base + i) / TILES, (base + i) % TILES);
+      tickets[i] = queue.read(block_byte.first);
+      offsets[i] = block_byte.second;
+    }
+    queue.flush(oram, server_data);
+
+    for (unsigned i = 0; i < count; ++i) {
+      const auto& block = queue.result(tickets[i]);
+      ap_uint<SIMD*WT::width>& weight = weights.m_weights[(base + i) / TILES][(base + i) % TILES];
+      weight = 0;
+      for (size_t j = 0; j < element_size; ++j) {
+        #pragma HLS pipeline
+        weight |= ap_uint<SIMD*WT::width>(block[offsets[i] + j]) << (j * 8);
+      }
+    }
+  }
+}
+
 #endif